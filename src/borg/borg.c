@@ -479,12 +479,11 @@ static struct keypress internal_borg_inkey(int flush_first)
     borg_confirm_target = false;
 
     /* Save the system random info */
-    borg_rand_quick = Rand_quick;
-    borg_rand_value = Rand_value;
+    borg_rand_quick = rng_default()->quick;
+    borg_rand_value = rng_default()->value;
 
     /* Use the local random info */
-    Rand_quick = true;
-    Rand_value = borg_rand_local;
+    rng_state_init_quick(rng_default(), borg_rand_local);
 
     /* Think */
     while (!borg_think()) /* loop */
@@ -494,11 +493,11 @@ static struct keypress internal_borg_inkey(int flush_first)
     borg_status();
 
     /* Save the local random info */
-    borg_rand_local = Rand_value;
+    borg_rand_local = rng_default()->value;
 
     /* Restore the system random info */
-    Rand_quick = borg_rand_quick;
-    Rand_value = borg_rand_value;
+    rng_default()->quick = borg_rand_quick;
+    rng_default()->value = borg_rand_value;
 
     /* Allow stepping to induce a clean cancel */
     if (borg_step && (!--borg_step))
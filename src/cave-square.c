@@ -43,7 +43,7 @@
  */
 bool feat_is_magma(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_MAGMA);
+	return feat_has(feat, TF_MAGMA);
 }
 
 /**
@@ -51,7 +51,7 @@ bool feat_is_magma(int feat)
  */
 bool feat_is_quartz(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_QUARTZ);
+	return feat_has(feat, TF_QUARTZ);
 }
 
 /**
@@ -59,7 +59,7 @@ bool feat_is_quartz(int feat)
  */
 bool feat_is_granite(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_GRANITE);
+	return feat_has(feat, TF_GRANITE);
 }
 
 /**
@@ -67,7 +67,7 @@ bool feat_is_granite(int feat)
  */
 bool feat_is_treasure(int feat)
 {
-	return (tf_has(f_info[feat].flags, TF_GOLD));
+	return (feat_has(feat, TF_GOLD));
 }
 
 /**
@@ -75,7 +75,7 @@ bool feat_is_treasure(int feat)
  */
 bool feat_is_wall(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_WALL);
+	return feat_has(feat, TF_WALL);
 }
 
 /**
@@ -83,7 +83,7 @@ bool feat_is_wall(int feat)
  */
 bool feat_is_floor(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_FLOOR);
+	return feat_has(feat, TF_FLOOR);
 }
 
 /**
@@ -91,7 +91,7 @@ bool feat_is_floor(int feat)
  */
 bool feat_is_trap_holding(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_TRAP);
+	return feat_has(feat, TF_TRAP);
 }
 
 /**
@@ -99,7 +99,7 @@ bool feat_is_trap_holding(int feat)
  */
 bool feat_is_object_holding(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_OBJECT);
+	return feat_has(feat, TF_OBJECT);
 }
 
 /**
@@ -107,7 +107,7 @@ bool feat_is_object_holding(int feat)
  */
 bool feat_is_monster_walkable(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_PASSABLE);
+	return feat_has(feat, TF_PASSABLE);
 }
 
 /**
@@ -115,7 +115,7 @@ bool feat_is_monster_walkable(int feat)
  */
 bool feat_is_shop(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_SHOP);
+	return feat_has(feat, TF_SHOP);
 }
 
 /**
@@ -123,7 +123,7 @@ bool feat_is_shop(int feat)
  */
 bool feat_is_los(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_LOS);
+	return feat_has(feat, TF_LOS);
 }
 
 /**
@@ -131,7 +131,7 @@ bool feat_is_los(int feat)
  */
 bool feat_is_passable(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_PASSABLE);
+	return feat_has(feat, TF_PASSABLE);
 }
 
 /**
@@ -139,7 +139,7 @@ bool feat_is_passable(int feat)
  */
 bool feat_is_projectable(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_PROJECT);
+	return feat_has(feat, TF_PROJECT);
 }
 
 /**
@@ -147,7 +147,7 @@ bool feat_is_projectable(int feat)
  */
 bool feat_is_torch(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_TORCH);
+	return feat_has(feat, TF_TORCH);
 }
 
 /**
@@ -155,7 +155,7 @@ bool feat_is_torch(int feat)
  */
 bool feat_is_bright(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_BRIGHT);
+	return feat_has(feat, TF_BRIGHT);
 }
 
 /**
@@ -163,7 +163,7 @@ bool feat_is_bright(int feat)
  */
 bool feat_is_fiery(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_FIERY);
+	return feat_has(feat, TF_FIERY);
 }
 
 /**
@@ -171,7 +171,7 @@ bool feat_is_fiery(int feat)
  */
 bool feat_is_no_flow(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_NO_FLOW);
+	return feat_has(feat, TF_NO_FLOW);
 }
 
 /**
@@ -179,7 +179,7 @@ bool feat_is_no_flow(int feat)
  */
 bool feat_is_no_scent(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_NO_SCENT);
+	return feat_has(feat, TF_NO_SCENT);
 }
 
 /**
@@ -187,7 +187,7 @@ bool feat_is_no_scent(int feat)
  */
 bool feat_is_smooth(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_SMOOTH);
+	return feat_has(feat, TF_SMOOTH);
 }
 
 /**
@@ -235,8 +235,8 @@ bool square_isobjectholding(struct chunk *c, struct loc grid)
  */
 bool square_isrock(struct chunk *c, struct loc grid)
 {
-	return (tf_has(f_info[square(c, grid)->feat].flags, TF_GRANITE) &&
-			!tf_has(f_info[square(c, grid)->feat].flags, TF_DOOR_ANY));
+	return (feat_has(square(c, grid)->feat, TF_GRANITE) &&
+			!feat_has(square(c, grid)->feat, TF_DOOR_ANY));
 }
 
 /**
@@ -252,8 +252,8 @@ bool square_isgranite(struct chunk *c, struct loc grid)
  */
 bool square_isperm(struct chunk *c, struct loc grid)
 {
-	return (tf_has(f_info[square(c, grid)->feat].flags, TF_PERMANENT) &&
-			tf_has(f_info[square(c, grid)->feat].flags, TF_ROCK));
+	return (feat_has(square(c, grid)->feat, TF_PERMANENT) &&
+			feat_has(square(c, grid)->feat, TF_ROCK));
 }
 
 /**
@@ -283,7 +283,7 @@ bool square_ismineral(struct chunk *c, struct loc grid)
 
 bool square_hasgoldvein(struct chunk *c, struct loc grid)
 {
-	return tf_has(f_info[square(c, grid)->feat].flags, TF_GOLD);
+	return feat_has(square(c, grid)->feat, TF_GOLD);
 }
 
 /**
@@ -291,8 +291,8 @@ bool square_hasgoldvein(struct chunk *c, struct loc grid)
  */
 bool square_isrubble(struct chunk *c, struct loc grid)
 {
-    return (!tf_has(f_info[square(c, grid)->feat].flags, TF_WALL) &&
-			tf_has(f_info[square(c, grid)->feat].flags, TF_ROCK));
+    return (!feat_has(square(c, grid)->feat, TF_WALL) &&
+			feat_has(square(c, grid)->feat, TF_ROCK));
 }
 
 /**
@@ -303,8 +303,8 @@ bool square_isrubble(struct chunk *c, struct loc grid)
  */
 bool square_issecretdoor(struct chunk *c, struct loc grid)
 {
-    return (tf_has(f_info[square(c, grid)->feat].flags, TF_DOOR_ANY) &&
-			tf_has(f_info[square(c, grid)->feat].flags, TF_ROCK));
+    return (feat_has(square(c, grid)->feat, TF_DOOR_ANY) &&
+			feat_has(square(c, grid)->feat, TF_ROCK));
 }
 
 /**
@@ -312,7 +312,7 @@ bool square_issecretdoor(struct chunk *c, struct loc grid)
  */
 bool square_isopendoor(struct chunk *c, struct loc grid)
 {
-    return (tf_has(f_info[square(c, grid)->feat].flags, TF_CLOSABLE));
+    return (feat_has(square(c, grid)->feat, TF_CLOSABLE));
 }
 
 /**
@@ -321,15 +321,15 @@ bool square_isopendoor(struct chunk *c, struct loc grid)
 bool square_iscloseddoor(struct chunk *c, struct loc grid)
 {
 	int feat = square(c, grid)->feat;
-	return tf_has(f_info[feat].flags, TF_DOOR_CLOSED);
+	return feat_has(feat, TF_DOOR_CLOSED);
 }
 
 bool square_isbrokendoor(struct chunk *c, struct loc grid)
 {
 	int feat = square(c, grid)->feat;
-    return (tf_has(f_info[feat].flags, TF_DOOR_ANY) &&
-			tf_has(f_info[feat].flags, TF_PASSABLE) &&
-			!tf_has(f_info[feat].flags, TF_CLOSABLE));
+    return (feat_has(feat, TF_DOOR_ANY) &&
+			feat_has(feat, TF_PASSABLE) &&
+			!feat_has(feat, TF_CLOSABLE));
 }
 
 /**
@@ -340,7 +340,7 @@ bool square_isbrokendoor(struct chunk *c, struct loc grid)
 bool square_isdoor(struct chunk *c, struct loc grid)
 {
 	int feat = square(c, grid)->feat;
-	return tf_has(f_info[feat].flags, TF_DOOR_ANY);
+	return feat_has(feat, TF_DOOR_ANY);
 }
 
 /**
@@ -349,7 +349,7 @@ bool square_isdoor(struct chunk *c, struct loc grid)
 bool square_isstairs(struct chunk *c, struct loc grid)
 {
 	int feat = square(c, grid)->feat;
-	return tf_has(f_info[feat].flags, TF_STAIR);
+	return feat_has(feat, TF_STAIR);
 }
 
 /**
@@ -358,7 +358,7 @@ bool square_isstairs(struct chunk *c, struct loc grid)
 bool square_isupstairs(struct chunk*c, struct loc grid)
 {
 	int feat = square(c, grid)->feat;
-	return tf_has(f_info[feat].flags, TF_UPSTAIR);
+	return feat_has(feat, TF_UPSTAIR);
 }
 
 /**
@@ -367,7 +367,7 @@ bool square_isupstairs(struct chunk*c, struct loc grid)
 bool square_isdownstairs(struct chunk *c, struct loc grid)
 {
 	int feat = square(c, grid)->feat;
-	return tf_has(f_info[feat].flags, TF_DOWNSTAIR);
+	return feat_has(feat, TF_DOWNSTAIR);
 }
 
 /**
@@ -768,13 +768,13 @@ bool square_iswebbed(struct chunk *c, struct loc grid)
 
 bool square_seemslikewall(struct chunk *c, struct loc grid)
 {
-	return tf_has(f_info[square(c, grid)->feat].flags, TF_ROCK);
+	return feat_has(square(c, grid)->feat, TF_ROCK);
 }
 
 bool square_isinteresting(struct chunk *c, struct loc grid)
 {
 	int f = square(c, grid)->feat;
-	return tf_has(f_info[f].flags, TF_INTERESTING);
+	return feat_has(f, TF_INTERESTING);
 }
 
 /**
@@ -1246,6 +1246,7 @@ void square_set_feat(struct chunk *c, struct loc grid, int feat)
 
 	/* Make the change */
 	c->squares[grid.y][grid.x].feat = feat;
+	c->terrain_stamp++;
 
 	/* Light bright terrain */
 	if (feat_is_bright(feat)) {
@@ -1274,7 +1275,9 @@ void square_set_feat(struct chunk *c, struct loc grid, int feat)
 static void square_set_known_feat(struct chunk *c, struct loc grid, int feat)
 {
 	if (c != cave) return;
+	if (player->cave->squares[grid.y][grid.x].feat == feat) return;
 	player->cave->squares[grid.y][grid.x].feat = feat;
+	player->cave->terrain_stamp++;
 }
 
 /**
@@ -1282,6 +1285,7 @@ static void square_set_known_feat(struct chunk *c, struct loc grid, int feat)
  */
 void square_set_mon(struct chunk *c, struct loc grid, int midx)
 {
+	cave_monster_index(c, grid, c->squares[grid.y][grid.x].mon, midx);
 	c->squares[grid.y][grid.x].mon = midx;
 }
 
@@ -21,6 +21,7 @@
 #include "cmds.h"
 #include "init.h"
 #include "game-world.h"
+#include "mon-util.h"
 #include "monster.h"
 #include "player-calcs.h"
 #include "player-timed.h"
@@ -45,6 +46,82 @@ int distance(struct loc grid1, struct loc grid2)
 	return ay > ax ? ay + (ax >> 1) : ax + (ay >> 1);
 }
 
+/**
+ * How often player_path_lookup() has found a result, and how often not
+ */
+static uint32_t player_path_hits;
+static uint32_t player_path_misses;
+
+/**
+ * Find the cached path results between the player's grid and a grid of the
+ * current level, throwing away any made out of date by the player moving or
+ * the terrain changing.
+ */
+static uint16_t *player_path_entry(struct chunk *c, struct loc grid)
+{
+	if (c != cave || !player || !square_in_bounds(c, grid)) return NULL;
+	if (!c->player_paths) {
+		c->player_paths = mem_zalloc(c->height * c->width *
+			sizeof(*c->player_paths));
+		c->player_paths_grid = player->grid;
+		c->player_paths_stamp = c->terrain_stamp;
+	} else if (!loc_eq(c->player_paths_grid, player->grid)
+			|| c->player_paths_stamp != c->terrain_stamp) {
+		memset(c->player_paths, 0, c->height * c->width *
+			sizeof(*c->player_paths));
+		c->player_paths_grid = player->grid;
+		c->player_paths_stamp = c->terrain_stamp;
+	}
+	return &c->player_paths[grid.y * c->width + grid.x];
+}
+
+/**
+ * Look up the result of a path of the given kind between the player's grid
+ * and another grid, as saved by player_path_store().  Only paths which
+ * depend on nothing but the terrain may be kept, since nothing else is
+ * checked for changes.
+ * \param c is the chunk; only the current level has results kept
+ * \param grid is the grid at the other end of the path from the player
+ * \param kind is one of the PLAYER_PATH_* values
+ * \return 1 or 0 for a known result, -1 if it has to be worked out
+ */
+int player_path_lookup(struct chunk *c, struct loc grid, int kind)
+{
+	uint16_t *entry = player_path_entry(c, grid);
+
+	if (!entry) return -1;
+	if (!(*entry & (1 << (2 * kind)))) {
+		player_path_misses++;
+		return -1;
+	}
+	player_path_hits++;
+	return (*entry & (2 << (2 * kind))) ? 1 : 0;
+}
+
+/**
+ * Save the result of a path of the given kind between the player's grid and
+ * another grid for player_path_lookup().
+ */
+void player_path_store(struct chunk *c, struct loc grid, int kind,
+		bool result)
+{
+	uint16_t *entry = player_path_entry(c, grid);
+
+	if (!entry) return;
+	*entry |= (1 << (2 * kind));
+	if (result) *entry |= (2 << (2 * kind));
+}
+
+/**
+ * Report how many lookups of path results have been answered from those kept
+ * and how many have not since the game started.
+ */
+void player_path_counts(uint32_t *hits, uint32_t *misses)
+{
+	*hits = player_path_hits;
+	*misses = player_path_misses;
+}
+
 
 /**
  * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
@@ -82,7 +159,7 @@ int distance(struct loc grid1, struct loc grid2)
  * determining which grids are illuminated by the player's torch, and which
  * grids and monsters can be "seen" by the player, etc).
  */
-bool los(struct chunk *c, struct loc grid1, struct loc grid2)
+static bool los_trace(struct chunk *c, struct loc grid1, struct loc grid2)
 {
 	/* Delta */
 	int dx, dy;
@@ -247,6 +324,34 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 	return (true);
 }
 
+/**
+ * Check line of sight as above; lines starting or ending at the player are
+ * kept until the player moves or the terrain changes, since monsters ask
+ * about them over and over.
+ */
+bool los(struct chunk *c, struct loc grid1, struct loc grid2)
+{
+	int kind, known;
+	struct loc grid;
+	bool result;
+
+	if (player && loc_eq(grid1, player->grid)) {
+		kind = PLAYER_PATH_LOS_FROM;
+		grid = grid2;
+	} else if (player && loc_eq(grid2, player->grid)) {
+		kind = PLAYER_PATH_LOS_TO;
+		grid = grid1;
+	} else {
+		return los_trace(c, grid1, grid2);
+	}
+
+	known = player_path_lookup(c, grid, kind);
+	if (known >= 0) return known == 1;
+	result = los_trace(c, grid1, grid2);
+	player_path_store(c, grid, kind, result);
+	return result;
+}
+
 /**
  * The comments below are still predominantly true, and have been left
  * (slightly modified for accuracy) for historical and nostalgic reasons.
@@ -430,17 +535,21 @@ bool los(struct chunk *c, struct loc grid1, struct loc grid2)
 
 
 /**
- * Mark the currently seen grids, then wipe in preparation for recalculating
+ * Mark the currently seen grids, then wipe in preparation for recalculating.
+ * Only the region recorded by the last call to update_view() can have any
+ * view flags set, so nothing outside it needs to be touched.
  */
 static void mark_wasseen(struct chunk *c)
 {
 	int x, y;
 	/* Save the old "view" grids for later */
-	for (y = 0; y < c->height; y++) {
-		for (x = 0; x < c->width; x++) {
+	for (y = c->view_tl.y; y <= c->view_br.y; y++) {
+		for (x = c->view_tl.x; x <= c->view_br.x; x++) {
 			struct loc grid = loc(x, y);
 			if (square_isseen(c, grid))
 				sqinfo_on(square(c, grid)->info, SQUARE_WASSEEN);
+			if (square_isview(c, grid))
+				sqinfo_on(square(c, grid)->info, SQUARE_WASVIEW);
 			sqinfo_off(square(c, grid)->info, SQUARE_VIEW);
 			sqinfo_off(square(c, grid)->info, SQUARE_SEEN);
 			sqinfo_off(square(c, grid)->info, SQUARE_CLOSE_PLAYER);
@@ -448,6 +557,30 @@ static void mark_wasseen(struct chunk *c)
 	}
 }
 
+/**
+ * Get the bounds of the region which can be in view of a player at the
+ * given grid.  distance() never returns less than the larger of the two
+ * components, so a square of side 2 * max_sight + 1 covers every grid that
+ * update_view_one() could accept.
+ */
+static void get_view_bounds(struct chunk *c, struct loc grid,
+		struct loc *tl, struct loc *br)
+{
+	tl->x = MAX(grid.x - z_info->max_sight, 0);
+	tl->y = MAX(grid.y - z_info->max_sight, 0);
+	br->x = MIN(grid.x + z_info->max_sight, c->width - 1);
+	br->y = MIN(grid.y + z_info->max_sight, c->height - 1);
+}
+
+/**
+ * Check whether a grid lies in a region found by get_view_bounds().
+ */
+static bool in_view_bounds(struct loc grid, struct loc tl, struct loc br)
+{
+	return grid.x >= tl.x && grid.x <= br.x && grid.y >= tl.y
+		&& grid.y <= br.y;
+}
+
 /**
  * Help glow_can_light_wall(), add_light() and calc_lighting():  check for
  * whether a wall can appear to be lit, as viewed by the player, by a light
@@ -602,79 +735,144 @@ static bool glow_can_light_wall(struct chunk *c, struct player *p,
 }
 
 /**
- * Help calc_lighting():  add in the effect of a light source.
+ * Help add_light():  find the grids a light source can reach, and the change
+ * in light level it makes to each.  Whether a lit wall can be seen depends on
+ * where the player is, so that is left to add_light().
  * \param c Is the chunk to use.
- * \param p Is the player to use.
+ * \param fp Is the footprint to fill in.
  * \param sgrid Is the location of the light source.
  * \param radius Is the radius, in grids, of the light source.
  * \param inten Is the intensity of the light source.
- * This is a brute force approach.  Some computation probably could be saved by
- * propagating the light out from the source and terminating paths when they
- * reach a wall.
  */
-static void add_light(struct chunk *c, struct player *p, struct loc sgrid,
-		int radius, int inten)
+static void trace_light(struct chunk *c, struct light_footprint *fp,
+		struct loc sgrid, int radius, int inten)
 {
+	int size = (2 * radius + 1) * (2 * radius + 1);
 	int y;
 
+	if (fp->size < size) {
+		fp->grids = mem_realloc(fp->grids, size * sizeof(*fp->grids));
+		fp->size = size;
+	}
+	fp->grid = sgrid;
+	fp->radius = radius;
+	fp->inten = inten;
+	fp->stamp = c->terrain_stamp;
+	fp->count = 0;
+
 	for (y = -radius; y <= radius; y++) {
 		int x;
 
 		for (x = -radius; x <= radius; x++) {
 			struct loc grid = loc_sum(sgrid, loc(x, y));
 			int dist = distance(sgrid, grid);
+			struct light_grid *lit;
+
 			if (!square_in_bounds(c, grid)) continue;
 			if (dist > radius) continue;
 			/* Don't propagate the light through walls. */
 			if (!los(c, sgrid, grid)) continue;
-			/*
-			 * Only light a wall if the face lit is possibly visible
-			 * to the player.
-			 */
-			if (!square_allowslos(c, grid) && !source_can_light_wall(c,
-					p, sgrid, grid)) continue;
-			/* Adjust the light level */
+
+			lit = &fp->grids[fp->count++];
+			lit->grid = grid;
+			lit->wall = !square_allowslos(c, grid);
 			if (inten > 0) {
 				/* Light getting less further away */
-				c->squares[grid.y][grid.x].light +=
-					inten - dist;
+				lit->light = inten - dist;
 			} else {
 				/* Light getting greater further away */
-				c->squares[grid.y][grid.x].light +=
-					inten + dist;
+				lit->light = inten + dist;
 			}
 		}
 	}
 }
 
+/**
+ * Help calc_lighting():  add in the effect of a light source.
+ * \param c Is the chunk to use.
+ * \param p Is the player to use.
+ * \param fp Is the cached footprint for the light source.
+ * \param sgrid Is the location of the light source.
+ * \param radius Is the radius, in grids, of the light source.
+ * \param inten Is the intensity of the light source.
+ * \param tl Is the top left corner of the region to light.
+ * \param br Is the bottom right corner of the region to light.
+ * The grids reached by the source are only traced again if the source has
+ * moved or changed, or if the terrain of the chunk has changed since they
+ * were last traced.
+ */
+static void add_light(struct chunk *c, struct player *p,
+		struct light_footprint *fp, struct loc sgrid, int radius, int inten,
+		struct loc tl, struct loc br)
+{
+	int i;
+
+	if (!fp->grids || !loc_eq(fp->grid, sgrid) || fp->radius != radius
+			|| fp->inten != inten || fp->stamp != c->terrain_stamp) {
+		trace_light(c, fp, sgrid, radius, inten);
+	}
+
+	for (i = 0; i < fp->count; i++) {
+		struct loc grid = fp->grids[i].grid;
+
+		/* Only grids which could be in view matter */
+		if (!in_view_bounds(grid, tl, br)) continue;
+		/*
+		 * Only light a wall if the face lit is possibly visible
+		 * to the player.
+		 */
+		if (fp->grids[i].wall && !source_can_light_wall(c, p, sgrid, grid))
+			continue;
+		/* Adjust the light level */
+		c->squares[grid.y][grid.x].light += fp->grids[i].light;
+	}
+}
+
 /**
  * Calculate light level for every grid in view - stolen from Sil
+ *
+ * Light levels are only read for grids in view, so only those in the given
+ * region (which holds all grids that may be in view) are calculated.
  */
-static void calc_lighting(struct chunk *c, struct player *p)
+static void calc_lighting(struct chunk *c, struct player *p, struct loc tl,
+		struct loc br)
 {
-	int dir, k, x, y;
+	int dir, k, x, y, n;
 	int light = p->state.cur_light, radius = ABS(light) - 1;
 	int old_light = square_light(c, p->grid);
+	int *midx;
 
-	/* Starting values based on permanent light */
-	for (y = 0; y < c->height; y++) {
-		for (x = 0; x < c->width; x++) {
-			struct loc grid = loc(x, y);
+	/* Light outside the last region calculated is out of date */
+	bool old_valid = in_view_bounds(p->grid, c->view_tl, c->view_br);
 
-			if (square_isglow(c, grid) &&
-					(square_allowslos(c, grid) ||
-					glow_can_light_wall(c, p, grid))) {
-				c->squares[y][x].light = 1;
-			} else {
-				c->squares[y][x].light = 0;
+	/*
+	 * Starting values based on permanent light; bright terrain just
+	 * outside the region can still light grids inside it
+	 */
+	for (y = MAX(tl.y - 1, 0); y <= MIN(br.y + 1, c->height - 1); y++) {
+		for (x = MAX(tl.x - 1, 0); x <= MIN(br.x + 1, c->width - 1); x++) {
+			struct loc grid = loc(x, y);
+			bool inside = in_view_bounds(grid, tl, br);
+
+			if (inside) {
+				if (square_isglow(c, grid) &&
+						(square_allowslos(c, grid) ||
+						glow_can_light_wall(c, p, grid))) {
+					c->squares[y][x].light = 1;
+				} else {
+					c->squares[y][x].light = 0;
+				}
 			}
 
 			/* Squares with bright terrain have intensity 2 */
 			if (square_isbright(c, grid)) {
-				c->squares[y][x].light += 2;
+				if (inside) {
+					c->squares[y][x].light += 2;
+				}
 				for (dir = 0; dir < 8; dir++) {
 					struct loc adj_grid = loc_sum(grid, ddgrid_ddd[dir]);
 					if (!square_in_bounds(c, adj_grid)) continue;
+					if (!in_view_bounds(adj_grid, tl, br)) continue;
 					/*
 					 * Only brighten a wall if the player
 					 * is in position to view the face
@@ -691,12 +889,16 @@ static void calc_lighting(struct chunk *c, struct player *p)
 	}
 
 	/* Light around the player */
-	add_light(c, p, p->grid, radius, light);
+	add_light(c, p, &c->lights[0], p->grid, radius, light, tl, br);
 
-	/* Scan monster list and add monster light or darkness */
-	for (k = 1; k < cave_monster_max(c); k++) {
-		/* Check the k'th monster */
-		struct monster *mon = cave_monster(c, k);
+	/* Add light or darkness from monsters close enough to reach the region */
+	midx = cave_monster_list(c);
+	n = cave_monsters_in(c,
+		loc(tl.x - z_info->mon_light_max, tl.y - z_info->mon_light_max),
+		loc(br.x + z_info->mon_light_max, br.y + z_info->mon_light_max),
+		midx);
+	for (k = 0; k < n; k++) {
+		struct monster *mon = cave_monster(c, midx[k]);
 
 		/* Skip dead monsters */
 		if (!mon->race) continue;
@@ -715,11 +917,13 @@ static void calc_lighting(struct chunk *c, struct player *p)
 		if (distance(p->grid, mon->grid) - radius > z_info->max_sight)
 			continue;
 
-		add_light(c, p, mon->grid, radius, light);
+		add_light(c, p, &c->lights[mon->midx], mon->grid, radius, light,
+			tl, br);
 	}
+	cave_monster_list_done(c, midx);
 
 	/* Update light level indicator */
-	if (square_light(c, p->grid) != old_light) {
+	if (!old_valid || square_light(c, p->grid) != old_light) {
 		p->upkeep->redraw |= PR_LIGHT;
 	}
 }
@@ -862,21 +1066,37 @@ static void update_one(struct chunk *c, struct loc grid, struct player *p)
 	if (!square_isseen(c, grid) && square_wasseen(c, grid))
 		square_light_spot(c, grid);
 
+	/* A monster here may have come into or gone out of view */
+	if (square(c, grid)->mon > 0 &&
+		(square_isseen(c, grid) != square_wasseen(c, grid) ||
+		square_isview(c, grid) !=
+		sqinfo_has(square(c, grid)->info, SQUARE_WASVIEW))) {
+		monster_needs_update(c, square(c, grid)->mon);
+	}
+
 	sqinfo_off(square(c, grid)->info, SQUARE_WASSEEN);
+	sqinfo_off(square(c, grid)->info, SQUARE_WASVIEW);
 }
 
 /**
  * Update the player's current view
+ *
+ * Only grids within the sight radius of the player can enter the view, and
+ * only grids within the region recorded by the previous call can leave it,
+ * so the per-grid passes are restricted to those regions rather than the
+ * whole level.
  */
 void update_view(struct chunk *c, struct player *p)
 {
+	struct loc tl, br;
 	int x, y;
 
 	/* Record the current view */
 	mark_wasseen(c);
 
 	/* Calculate light levels */
-	calc_lighting(c, p);
+	get_view_bounds(c, p->grid, &tl, &br);
+	calc_lighting(c, p, tl, br);
 
 	/* Assume we can view the player grid */
 	sqinfo_on(square(c, p->grid)->info, SQUARE_VIEW);
@@ -897,14 +1117,18 @@ void update_view(struct chunk *c, struct player *p)
 	}
 
 	/* Squares we have LOS to get marked as in the view, and perhaps seen */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
+	for (y = tl.y; y <= br.y; y++)
+		for (x = tl.x; x <= br.x; x++)
 			update_view_one(c, loc(x, y), p);
 
-	/* Update each grid */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
+	/* Update each grid that was or now is in view */
+	for (y = MIN(tl.y, c->view_tl.y); y <= MAX(br.y, c->view_br.y); y++)
+		for (x = MIN(tl.x, c->view_tl.x); x <= MAX(br.x, c->view_br.x); x++)
 			update_one(c, loc(x, y), p);
+
+	/* Remember where the view flags are for next time */
+	c->view_tl = tl;
+	c->view_br = br;
 }
 
 
@@ -30,10 +30,13 @@
 #include "obj-tval.h"
 #include "obj-util.h"
 #include "object.h"
+#include "player-path.h"
 #include "player-timed.h"
 #include "trap.h"
+#include "z-queue.h"
 
 struct feature *f_info;
+uint32_t f_props[FEAT_MAX];
 struct chunk *cave = NULL;
 
 /**
@@ -338,28 +341,63 @@ const char *get_feat_code_name(int idx)
 	return (idx < 0 || idx >= FEAT_MAX) ? NULL : feat_code_list[idx];
 }
 
+/**
+ * Allocate a heatmap as a single block, with row pointers into it
+ */
+static void heatmap_init(struct heatmap *h, int height, int width)
+{
+	int y;
+
+	h->grids = mem_zalloc(height * sizeof(uint16_t*));
+	h->grids[0] = mem_zalloc(height * width * sizeof(uint16_t));
+	for (y = 1; y < height; y++) {
+		h->grids[y] = h->grids[0] + y * width;
+	}
+}
+
+/**
+ * Free a heatmap allocated by heatmap_init()
+ */
+static void heatmap_free(struct heatmap *h)
+{
+	mem_free(h->grids[0]);
+	mem_free(h->grids);
+	h->grids = NULL;
+}
+
 /**
  * Allocate a new chunk of the world
+ *
+ * The squares, their info flags and the heatmaps are each held in one block
+ * of memory, with the row pointers and the info pointers of the squares
+ * pointing into it, rather than being allocated row by row and square by
+ * square.
  */
 struct chunk *cave_new(int height, int width) {
 	int y, x;
+	bitflag *info;
 
 	struct chunk *c = mem_zalloc(sizeof *c);
 	c->height = height;
 	c->width = width;
 	c->feat_count = mem_zalloc((FEAT_MAX + 1) * sizeof(int));
 
+	/* Nothing is known about the view yet, so the whole chunk may be in it */
+	c->view_tl = loc(0, 0);
+	c->view_br = loc(width - 1, height - 1);
+
 	c->squares = mem_zalloc(c->height * sizeof(struct square*));
-	c->noise.grids = mem_zalloc(c->height * sizeof(uint16_t*));
-	c->scent.grids = mem_zalloc(c->height * sizeof(uint16_t*));
+	c->squares[0] = mem_zalloc(c->height * c->width * sizeof(struct square));
+	info = mem_zalloc(c->height * c->width * SQUARE_SIZE * sizeof(bitflag));
 	for (y = 0; y < c->height; y++) {
-		c->squares[y] = mem_zalloc(c->width * sizeof(struct square));
+		c->squares[y] = c->squares[0] + y * c->width;
 		for (x = 0; x < c->width; x++) {
-			c->squares[y][x].info = mem_zalloc(SQUARE_SIZE * sizeof(bitflag));
+			c->squares[y][x].info = info;
+			info += SQUARE_SIZE;
 		}
-		c->noise.grids[y] = mem_zalloc(c->width * sizeof(uint16_t));
-		c->scent.grids[y] = mem_zalloc(c->width * sizeof(uint16_t));
 	}
+	heatmap_init(&c->noise, c->height, c->width);
+	heatmap_init(&c->scent, c->height, c->width);
 
 	c->objects = mem_zalloc(OBJECT_LIST_SIZE * sizeof(struct object*));
 	c->obj_max = OBJECT_LIST_SIZE - 1;
@@ -367,10 +405,17 @@ struct chunk *cave_new(int height, int width) {
 	c->monsters = mem_zalloc(z_info->level_monster_max *sizeof(struct monster));
 	c->mon_max = 1;
 	c->mon_current = -1;
+	c->mon_stale_all = true;
+	c->mon_bucket_width = ((width - 1) >> MON_BUCKET_SHIFT) + 1;
+	c->mon_buckets = mem_zalloc(c->mon_bucket_width *
+		(((height - 1) >> MON_BUCKET_SHIFT) + 1) * sizeof(struct mon_bucket));
 
 	c->monster_groups = mem_zalloc(z_info->level_monster_max *
 								   sizeof(struct monster_group*));
 
+	c->lights = mem_zalloc(z_info->level_monster_max *
+						   sizeof(struct light_footprint));
+
 	c->turn = turn;
 	return c;
 }
@@ -407,24 +452,43 @@ void cave_free(struct chunk *c) {
 
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
-			mem_free(c->squares[y][x].info);
 			if (c->squares[y][x].trap)
 				square_free_trap(c, loc(x, y));
 			if (c->squares[y][x].obj)
 				object_pile_free(c, p_c, c->squares[y][x].obj);
 		}
-		mem_free(c->squares[y]);
-		mem_free(c->noise.grids[y]);
-		mem_free(c->scent.grids[y]);
 	}
+	/* The first square's info is the start of the block holding them all */
+	mem_free(c->squares[0][0].info);
+	mem_free(c->squares[0]);
 	mem_free(c->squares);
-	mem_free(c->noise.grids);
-	mem_free(c->scent.grids);
+	heatmap_free(&c->noise);
+	heatmap_free(&c->scent);
+	if (c->noise_queue)
+		q_free(c->noise_queue);
+	path_graph_free(c->path_graph);
+	mem_free(c->mon_calendar);
+	mem_free(c->mon_due);
+	mem_free(c->mon_stale);
+	mem_free(c->player_paths);
+	for (i = 0; i < c->mon_bucket_width *
+			(((c->height - 1) >> MON_BUCKET_SHIFT) + 1); i++) {
+		mem_free(c->mon_buckets[i].midx);
+	}
+	mem_free(c->mon_buckets);
+	for (i = 0; i < c->mon_lists_size; i++) {
+		mem_free(c->mon_lists[i]);
+	}
+	mem_free(c->mon_lists);
 
 	mem_free(c->feat_count);
 	mem_free(c->objects);
 	mem_free(c->monsters);
 	mem_free(c->monster_groups);
+	for (i = 0; i < z_info->level_monster_max; i++) {
+		mem_free(c->lights[i].grids);
+	}
+	mem_free(c->lights);
 	if (c->name)
 		string_free(c->name);
 	mem_free(c);
@@ -634,6 +698,145 @@ int cave_monster_count(struct chunk *c) {
 	return c->mon_cnt;
 }
 
+/**
+ * Get the bucket holding the monsters of the block a grid is in.
+ */
+static struct mon_bucket *mon_bucket(struct chunk *c, struct loc grid)
+{
+	return &c->mon_buckets[(grid.y >> MON_BUCKET_SHIFT) * c->mon_bucket_width
+		+ (grid.x >> MON_BUCKET_SHIFT)];
+}
+
+/**
+ * Keep the monster buckets up to date when the monster index held by a grid
+ * changes; only square_set_mon() should need to call this.
+ * \param c is the chunk
+ * \param grid is the grid changing
+ * \param old_midx is the index the grid held before (0 or less for none)
+ * \param new_midx is the index it holds now (0 or less for none)
+ */
+void cave_monster_index(struct chunk *c, struct loc grid, int old_midx,
+		int new_midx)
+{
+	struct mon_bucket *b = mon_bucket(c, grid);
+
+	if (old_midx > 0) {
+		int i;
+
+		for (i = 0; i < b->count; i++) {
+			if (b->midx[i] == old_midx) {
+				b->midx[i] = b->midx[--b->count];
+				break;
+			}
+		}
+	}
+	if (new_midx > 0) {
+		if (b->count == b->size) {
+			b->size = b->size ? 2 * b->size : MON_BUCKET_SIZE;
+			b->midx = mem_realloc(b->midx, b->size * sizeof(*b->midx));
+		}
+		b->midx[b->count++] = new_midx;
+	}
+}
+
+static int cmp_midx(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+/**
+ * Lend out an array with room for the index of every monster a chunk can
+ * hold, for cave_monsters_in() or cave_monsters_near() to fill.  The arrays
+ * stay with the chunk to be lent out again, and must be handed back to
+ * cave_monster_list_done() in the opposite order to the one they were lent
+ * out in.
+ */
+int *cave_monster_list(struct chunk *c)
+{
+	if (c->mon_lists_used == c->mon_lists_size) {
+		c->mon_lists = mem_realloc(c->mon_lists,
+			(c->mon_lists_size + 1) * sizeof(*c->mon_lists));
+		c->mon_lists[c->mon_lists_size++] =
+			mem_alloc(z_info->level_monster_max * sizeof(int));
+	}
+	return c->mon_lists[c->mon_lists_used++];
+}
+
+/**
+ * Hand back the array last lent out by cave_monster_list().
+ */
+void cave_monster_list_done(struct chunk *c, int *midx)
+{
+	assert(c->mon_lists_used > 0
+		&& c->mon_lists[c->mon_lists_used - 1] == midx);
+	c->mon_lists_used--;
+}
+
+/**
+ * Find the monsters in a rectangle of grids.
+ * \param c is the chunk
+ * \param tl is the top left corner of the rectangle
+ * \param br is the bottom right corner of the rectangle
+ * \param midx is filled with the indices of the monsters found, in increasing
+ * order; it must have room for cave_monster_max(c) of them, as an array from
+ * cave_monster_list() does
+ * \return the number of monsters found
+ */
+int cave_monsters_in(struct chunk *c, struct loc tl, struct loc br,
+		int *midx)
+{
+	int n = 0, bx, by;
+
+	tl.x = MAX(tl.x, 0);
+	tl.y = MAX(tl.y, 0);
+	br.x = MIN(br.x, c->width - 1);
+	br.y = MIN(br.y, c->height - 1);
+	for (by = tl.y >> MON_BUCKET_SHIFT; by <= br.y >> MON_BUCKET_SHIFT;
+			by++) {
+		for (bx = tl.x >> MON_BUCKET_SHIFT;
+				bx <= br.x >> MON_BUCKET_SHIFT; bx++) {
+			struct mon_bucket *b =
+				&c->mon_buckets[by * c->mon_bucket_width + bx];
+			int i;
+
+			for (i = 0; i < b->count; i++) {
+				struct loc grid = cave_monster(c, b->midx[i])->grid;
+
+				if (grid.x < tl.x || grid.x > br.x || grid.y < tl.y
+						|| grid.y > br.y) continue;
+				midx[n++] = b->midx[i];
+			}
+		}
+	}
+	sort(midx, n, sizeof(*midx), cmp_midx);
+	return n;
+}
+
+/**
+ * Find the monsters within a given distance of a grid.
+ * \param c is the chunk
+ * \param grid is the centre
+ * \param radius is the greatest distance(), from the centre, to include
+ * \param midx is filled with the indices of the monsters found, in increasing
+ * order; it must have room for cave_monster_max(c) of them, as an array from
+ * cave_monster_list() does
+ * \return the number of monsters found
+ */
+int cave_monsters_near(struct chunk *c, struct loc grid, int radius,
+		int *midx)
+{
+	int n = cave_monsters_in(c, loc(grid.x - radius, grid.y - radius),
+		loc(grid.x + radius, grid.y + radius), midx);
+	int i, kept = 0;
+
+	for (i = 0; i < n; i++) {
+		if (distance(grid, cave_monster(c, midx[i])->grid) <= radius) {
+			midx[kept++] = midx[i];
+		}
+	}
+	return kept;
+}
+
 /**
  * Return the number of matching grids around (or under) the character.
  * \param grid If not NULL, *grid is set to the location of the last match.
@@ -25,6 +25,8 @@
 struct player;
 struct monster;
 struct monster_group;
+struct queue;
+struct path_graph;
 
 extern const int16_t ddd[9];
 extern const int16_t ddx[10];
@@ -171,6 +173,42 @@ struct heatmap {
 	uint16_t **grids;
 };
 
+/**
+ * A grid lit by a light source
+ */
+struct light_grid {
+	struct loc grid;
+	int light;		/**< Change in light level at the grid */
+	bool wall;		/**< Grid blocks line of sight */
+};
+
+/**
+ * The grids reached by a light source, traced once and then reused until the
+ * source moves, changes or the terrain of the chunk changes
+ */
+struct light_footprint {
+	struct loc grid;	/**< Location of the source */
+	int radius;
+	int inten;
+	uint32_t stamp;		/**< Terrain stamp of the chunk when traced */
+	int count;
+	int size;
+	struct light_grid *grids;
+};
+
+/**
+ * The monsters in one block of MON_BUCKET_SIZE by MON_BUCKET_SIZE grids, kept
+ * so that monsters near a point can be found without looking at them all
+ */
+#define MON_BUCKET_SHIFT 3
+#define MON_BUCKET_SIZE (1 << MON_BUCKET_SHIFT)
+
+struct mon_bucket {
+	int *midx;
+	int count;
+	int size;
+};
+
 struct connector {
 	struct loc grid;
 	uint8_t feat;
@@ -195,7 +233,21 @@ struct chunk {
 	int *feat_count;
 
 	struct square **squares;
+	struct loc view_tl;	/**< Top left corner of the grids which may be in view */
+	struct loc view_br;	/**< Bottom right corner of the same */
+	uint32_t terrain_stamp;	/**< Incremented on every terrain change, or
+				 on a known trap change in the player's map */
+	struct light_footprint *lights;	/**< Player (0) and monster light cache */
+	uint16_t *player_paths;	/**< Known los()/projectable() results between
+				 the player's grid and each grid */
+	struct loc player_paths_grid;	/**< Player grid they are for */
+	uint32_t player_paths_stamp;	/**< Terrain stamp they are for */
 	struct heatmap noise;
+	struct loc noise_grid;	/**< Player grid the noise map was built from */
+	int noise_step;		/**< Noise increment used to build it */
+	uint32_t noise_stamp;	/**< Terrain stamp when it was built */
+	struct queue *noise_queue;	/**< Reused by make_noise() */
+	struct path_graph *path_graph;	/**< Travel planner for a known map */
 	struct heatmap scent;
 	struct loc decoy;
 
@@ -207,6 +259,21 @@ struct chunk {
 	uint16_t mon_cnt;
 	int mon_current;
 	int num_repro;
+	uint32_t *mon_calendar;	/**< Per turn bitmaps of monsters due to move */
+	int *mon_due;		/**< Monsters due to move this turn, highest index first */
+	int mon_due_count;
+	int32_t mon_due_turn;	/**< Turn mon_due was gathered for */
+	int32_t mon_pass_turn;	/**< Turn of the latest full monster pass */
+	int mon_pass_pos;	/**< That pass has dealt with all monsters above this */
+	bool mon_resched;	/**< Monster indices have changed, rebuild the calendar */
+	int *mon_stale;		/**< Monsters update_monsters() must look at again */
+	int mon_stale_count;
+	bool mon_stale_all;	/**< update_monsters() must look at every monster */
+	struct mon_bucket *mon_buckets;	/**< Monsters by block of grids */
+	int mon_bucket_width;	/**< Blocks in each row of mon_buckets */
+	int **mon_lists;	/**< Arrays for cave_monster_list() to lend out */
+	int mon_lists_size;	/**< Number of arrays in mon_lists */
+	int mon_lists_used;	/**< Number of them lent out */
 
 	struct monster_group **monster_groups;
 
@@ -221,14 +288,42 @@ enum {
 	FEAT_MAX
 };
 
+/**
+ * The terrain flags of each feature packed into one word, so that the square
+ * predicates can test a flag with a single load and mask; filled in once
+ * terrain.txt has been parsed.  There must be no more than 32 terrain flags.
+ */
+extern uint32_t f_props[FEAT_MAX];
+
+#define feat_has(feat, flag)	((f_props[(feat)] & (1U << (flag))) != 0)
+
 /* Current level */
 extern struct chunk *cave;
 /* Stored levels */
 extern struct chunk **chunk_list;
 extern uint16_t chunk_list_max;
 
+/**
+ * Kinds of path between the player's grid and another grid whose results
+ * are kept by player_path_lookup() and player_path_store()
+ */
+enum {
+	PLAYER_PATH_LOS_FROM = 0,
+	PLAYER_PATH_LOS_TO,
+	PLAYER_PATH_PROJECT_FROM,
+	PLAYER_PATH_PROJECT_TO,
+	PLAYER_PATH_PROJECT_SHORT_FROM,
+	PLAYER_PATH_PROJECT_SHORT_TO,
+
+	PLAYER_PATH_MAX
+};
+
 /* cave-view.c */
 int distance(struct loc grid1, struct loc grid2);
+int player_path_lookup(struct chunk *c, struct loc grid, int kind);
+void player_path_store(struct chunk *c, struct loc grid, int kind,
+		bool result);
+void player_path_counts(uint32_t *hits, uint32_t *misses);
 bool los(struct chunk *c, struct loc grid1, struct loc grid2);
 void update_view(struct chunk *c, struct player *p);
 bool no_light(const struct player *p);
@@ -444,6 +539,14 @@ int scatter_ext(struct chunk *c, struct loc *places, int n, struct loc grid,
 struct monster *cave_monster(struct chunk *c, int idx);
 int cave_monster_max(struct chunk *c);
 int cave_monster_count(struct chunk *c);
+void cave_monster_index(struct chunk *c, struct loc grid, int old_midx,
+		int new_midx);
+int *cave_monster_list(struct chunk *c);
+void cave_monster_list_done(struct chunk *c, int *midx);
+int cave_monsters_in(struct chunk *c, struct loc tl, struct loc br,
+		int *midx);
+int cave_monsters_near(struct chunk *c, struct loc grid, int radius,
+		int *midx);
 
 int count_feats(struct loc *grid,
 				bool (*test)(struct chunk *c, struct loc grid), bool under);
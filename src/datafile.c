@@ -146,32 +146,119 @@ void cleanup_parser(struct file_parser *fp)
 	fp->cleanup();
 }
 
-int lookup_flag(const char **flag_table, const char *flag_name) {
-	int i = FLAG_START;
+/**
+ * Name tables are searched through an index of their names in sorted order,
+ * built the first time each table is used.  The tables are all static, so
+ * the index is keyed by the address of the table and the entry the search
+ * starts at.
+ */
+struct name_index_entry {
+	const char *name;
+	int idx;
+};
 
-	while (flag_table[i] && !streq(flag_table[i], flag_name))
-		i++;
+struct name_index {
+	const char **table;
+	int start;
+	int count;
+	struct name_index_entry *entries;
+	struct name_index *next;
+};
 
-	/* End of table reached without match */
-	if (!flag_table[i]) i = FLAG_END;
+static struct name_index *name_indices = NULL;
 
-	return i;
+static int cmp_name_index_entry(const void *a, const void *b)
+{
+	const struct name_index_entry *ea = a;
+	const struct name_index_entry *eb = b;
+	int c = strcmp(ea->name, eb->name);
+
+	if (c) return c;
+	return (ea->idx < eb->idx) ? -1 : ((ea->idx > eb->idx) ? 1 : 0);
 }
 
-int code_index_in_array(const char *code_name[], const char *code)
+static const struct name_index *get_name_index(const char **table, int start)
 {
-	int i = 0;
+	struct name_index *ni;
+	int i;
 
-	while (code_name[i]) {
-		if (streq(code_name[i], code)) {
-			return i;
+	for (ni = name_indices; ni; ni = ni->next) {
+		if (ni->table == table && ni->start == start) {
+			return ni;
 		}
-		i++;
 	}
 
+	/* Index the names up to the terminating NULL */
+	ni = mem_zalloc(sizeof(*ni));
+	ni->table = table;
+	ni->start = start;
+	while (table[start + ni->count]) {
+		ni->count++;
+	}
+	ni->entries = mem_alloc(MAX(ni->count, 1) * sizeof(*ni->entries));
+	for (i = 0; i < ni->count; i++) {
+		ni->entries[i].name = table[start + i];
+		ni->entries[i].idx = start + i;
+	}
+	qsort(ni->entries, ni->count, sizeof(*ni->entries),
+		cmp_name_index_entry);
+	ni->next = name_indices;
+	name_indices = ni;
+	return ni;
+}
+
+/**
+ * Find the index of the first entry in table, from start on, which is the
+ * given name; return -1 if there isn't one.
+ */
+static int find_name_index(const char **table, int start, const char *name)
+{
+	const struct name_index *ni = get_name_index(table, start);
+	int lo = 0, hi = ni->count;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (strcmp(ni->entries[mid].name, name) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo < ni->count && streq(ni->entries[lo].name, name)) {
+		return ni->entries[lo].idx;
+	}
 	return -1;
 }
 
+/**
+ * Free the name table indices
+ */
+void cleanup_name_indices(void)
+{
+	while (name_indices) {
+		struct name_index *next = name_indices->next;
+
+		mem_free(name_indices->entries);
+		mem_free(name_indices);
+		name_indices = next;
+	}
+}
+
+int lookup_flag(const char **flag_table, const char *flag_name) {
+	int i = find_name_index(flag_table, FLAG_START, flag_name);
+
+	/* End of table reached without match */
+	if (i < 0) i = FLAG_END;
+
+	return i;
+}
+
+int code_index_in_array(const char *code_name[], const char *code)
+{
+	return find_name_index(code_name, 0, code);
+}
+
 /**
  * Gets a name and argument for a value expression of the form NAME[arg]
  * \param value_name points to the expression to parse; on return it will be
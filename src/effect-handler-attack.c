@@ -1124,20 +1124,23 @@ bool effect_handler_PROJECT_LOS(effect_handler_context_t *context)
  */
 bool effect_handler_PROJECT_LOS_AWARE(effect_handler_context_t *context)
 {
-	int i;
+	int i, n;
 	int dam = effect_calculate_value(context, context->other ? true : false);
 	int typ = context->subtype;
+	int *midx;
 
 	int flg = PROJECT_JUMP | PROJECT_KILL | PROJECT_HIDE;
 
 	if (context->aware) flg |= PROJECT_AWARE;
 
-	/* Affect all (nearby) monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
+	/* Affect all monsters where the view can reach */
+	midx = cave_monster_list(cave);
+	n = cave_monsters_in(cave, cave->view_tl, cave->view_br, midx);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, midx[i]);
 		struct loc grid;
 
-		/* Paranoia -- Skip dead monsters */
+		/* Skip monsters killed by an earlier projection */
 		if (!mon->race) continue;
 
 		/* Don't affect the caster */
@@ -1153,6 +1156,7 @@ bool effect_handler_PROJECT_LOS_AWARE(effect_handler_context_t *context)
 		(void)project(source_player(), 0, grid, dam, typ, flg, 0, 0, context->obj);
 		context->ident = true;
 	}
+	cave_monster_list_done(cave, midx);
 
 	/* Result */
 	return true;
@@ -1265,6 +1269,7 @@ bool effect_handler_DESTRUCTION(effect_handler_context_t *context)
 
 	/* Fully update the visuals */
 	player->upkeep->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
+	monsters_need_update(cave);
 
 	/* Redraw monster list */
 	player->upkeep->redraw |= (PR_MONLIST | PR_ITEMLIST);
@@ -1599,6 +1604,7 @@ bool effect_handler_EARTHQUAKE(effect_handler_context_t *context)
 
 	/* Fully update the visuals */
 	player->upkeep->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
+	monsters_need_update(cave);
 
 	/* Update the health bar */
 	player->upkeep->redraw |= (PR_HEALTH);
@@ -1767,8 +1767,9 @@ bool effect_handler_DETECT_OBJECTS(effect_handler_context_t *context)
  */
 static bool detect_monsters(int y_dist, int x_dist, monster_predicate pred)
 {
-	int i, x, y;
+	int i, n;
 	int x1, x2, y1, y2;
+	int *midx;
 
 	bool monsters = false;
 
@@ -1783,19 +1784,11 @@ static bool detect_monsters(int y_dist, int x_dist, monster_predicate pred)
 	if (y2 > cave->height - 1) y2 = cave->height - 1;
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
-	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
-
-		/* Skip dead monsters */
-		if (!mon->race) continue;
-
-		/* Location */
-		y = mon->grid.y;
-		x = mon->grid.x;
-
-		/* Only detect nearby monsters */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
+	/* Scan nearby monsters */
+	midx = cave_monster_list(cave);
+	n = cave_monsters_in(cave, loc(x1, y1), loc(x2, y2), midx);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, midx[i]);
 
 		/* Detect all appropriate, obvious monsters */
 		if (pred(mon) && !monster_is_camouflaged(mon)) {
@@ -1821,6 +1814,7 @@ static bool detect_monsters(int y_dist, int x_dist, monster_predicate pred)
 			monsters = true;
 		}
 	}
+	cave_monster_list_done(cave, midx);
 
 	return monsters;
 }
@@ -2204,26 +2198,26 @@ bool effect_handler_ACQUIRE(effect_handler_context_t *context)
  */
 bool effect_handler_WAKE(effect_handler_context_t *context)
 {
-	int i;
+	int i, n;
 	bool woken = false;
+	int radius = z_info->max_sight * 2;
+	int *midx = cave_monster_list(cave);
 
 	struct loc origin = origin_get_loc(context->origin);
 
 	/* Wake everyone nearby */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
-		if (mon->race) {
-			int radius = z_info->max_sight * 2;
-			int dist = distance(origin, mon->grid);
-
-			/* Skip monsters too far away */
-			if ((dist < radius) && mon->m_timed[MON_TMD_SLEEP]) {
-				/* Monster wakes, closer means likelier to become aware */
-				monster_wake(mon, false, 100 - 2 * dist);
-				woken = true;
-			}
+	n = cave_monsters_near(cave, origin, radius - 1, midx);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, midx[i]);
+		int dist = distance(origin, mon->grid);
+
+		if (mon->m_timed[MON_TMD_SLEEP]) {
+			/* Monster wakes, closer means likelier to become aware */
+			monster_wake(mon, false, 100 - 2 * dist);
+			woken = true;
 		}
 	}
+	cave_monster_list_done(cave, midx);
 
 	/* Messages */
 	if (woken) {
@@ -2400,9 +2394,10 @@ bool effect_handler_BANISH(effect_handler_context_t *context)
  */
 bool effect_handler_MASS_BANISH(effect_handler_context_t *context)
 {
-	int i;
+	int i, n;
 	int radius = context->radius ? context->radius : z_info->max_sight;
 	unsigned dam = 0;
+	int *midx;
 
 	context->ident = true;
 
@@ -2413,11 +2408,10 @@ bool effect_handler_MASS_BANISH(effect_handler_context_t *context)
 	}
 
 	/* Delete the (nearby) monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
-
-		/* Paranoia -- Skip dead monsters */
-		if (!mon->race) continue;
+	midx = cave_monster_list(cave);
+	n = cave_monsters_near(cave, player->grid, radius, midx);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, midx[i]);
 
 		/* Skip unique monsters */
 		if (monster_is_unique(mon)) continue;
@@ -2426,11 +2420,12 @@ bool effect_handler_MASS_BANISH(effect_handler_context_t *context)
 		if (mon->cdis > radius) continue;
 
 		/* Delete the monster */
-		delete_monster_idx(cave, i);
+		delete_monster_idx(cave, midx[i]);
 
 		/* Take some damage */
 		dam += randint1(3);
 	}
+	cave_monster_list_done(cave, midx);
 
 	/* Hurt the player */
 	dam = player_apply_damage_reduction(player, dam);
@@ -2450,16 +2445,15 @@ bool effect_handler_MASS_BANISH(effect_handler_context_t *context)
  */
 bool effect_handler_PROBE(effect_handler_context_t *context)
 {
-	int i;
+	int i, n;
+	int *midx = cave_monster_list(cave);
 
 	bool probe = false;
 
-	/* Probe all (nearby) monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
-
-		/* Paranoia -- Skip dead monsters */
-		if (!mon->race) continue;
+	/* Probe all monsters where the view can reach */
+	n = cave_monsters_in(cave, cave->view_tl, cave->view_br, midx);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, midx[i]);
 
 		/* Require line of sight */
 		if (!square_isview(cave, mon->grid)) continue;
@@ -2485,6 +2479,7 @@ bool effect_handler_PROBE(effect_handler_context_t *context)
 			probe = true;
 		}
 	}
+	cave_monster_list_done(cave, midx);
 
 	/* Done */
 	if (probe) {
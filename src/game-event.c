@@ -30,7 +30,124 @@ struct event_handler_entry
 
 static struct event_handler_entry *event_handlers[N_GAME_EVENTS];
 
-static void game_event_dispatch(game_event_type type, game_event_data *data)
+/**
+ * One bit for each event type with handlers, so that signalling an event no
+ * one listens for (as for most events in the headless front ends) costs a
+ * bit test
+ */
+static uint32_t event_present[(N_GAME_EVENTS + 31) / 32];
+
+/**
+ * One bit for each event type which is to be kept back rather than sent to
+ * its handlers straight away
+ */
+static uint32_t event_held[(N_GAME_EVENTS + 31) / 32];
+
+/**
+ * An event kept back by event_hold(), with its own copy of any string
+ */
+struct held_event {
+	struct held_event *next;
+	game_event_type type;
+	game_event_data data;
+	char *string;
+};
+
+/**
+ * The events kept back since event_take_held() was last called, oldest first
+ */
+static struct held_event *held_events;
+static struct held_event **held_events_tail = &held_events;
+
+/**
+ * Whether EVENT_MAP has been signalled since EVENT_MAP_REGION was last sent,
+ * kept only while EVENT_MAP_REGION has handlers
+ */
+static bool map_region_pending;
+
+static void mark_present(game_event_type type)
+{
+	if (event_handlers[type]) {
+		event_present[type / 32] |= (1U << (type % 32));
+	} else {
+		event_present[type / 32] &= ~(1U << (type % 32));
+	}
+}
+
+/**
+ * Return whether anything is listening for the given event type, for callers
+ * which can skip work done only to signal it.
+ */
+bool event_has_handlers(game_event_type type)
+{
+	return (event_present[type / 32] & (1U << (type % 32))) != 0;
+}
+
+/**
+ * Start or stop keeping back an event type.  While held, signalling the
+ * event queues it, to be sent later by event_send_held() or dropped by
+ * event_free_held().
+ */
+void event_hold(game_event_type type, bool hold)
+{
+	if (hold) {
+		event_held[type / 32] |= (1U << (type % 32));
+	} else {
+		event_held[type / 32] &= ~(1U << (type % 32));
+	}
+}
+
+/**
+ * Queue an event being held; the string, if any, is copied since the
+ * signaller's may not last.
+ */
+static void hold_event(game_event_type type, game_event_data *data,
+		const char *s)
+{
+	struct held_event *held = mem_zalloc(sizeof(*held));
+
+	held->type = type;
+	if (data) held->data = *data;
+	if (s) {
+		held->string = string_make(s);
+		held->data.string = held->string;
+	}
+	*held_events_tail = held;
+	held_events_tail = &held->next;
+}
+
+static bool is_held(game_event_type type)
+{
+	return (event_held[type / 32] & (1U << (type % 32))) != 0;
+}
+
+/**
+ * Return the events held so far, oldest first, leaving none held.
+ */
+struct held_event *event_take_held(void)
+{
+	struct held_event *taken = held_events;
+
+	held_events = NULL;
+	held_events_tail = &held_events;
+	return taken;
+}
+
+/**
+ * Free events returned by event_take_held() without sending them.
+ */
+void event_free_held(struct held_event *held)
+{
+	while (held) {
+		struct held_event *next = held->next;
+
+		string_free(held->string);
+		mem_free(held);
+		held = next;
+	}
+}
+
+static void send_event(game_event_type type, game_event_data *data)
 {
 	struct event_handler_entry *this = event_handlers[type];
 
@@ -45,6 +162,32 @@ static void game_event_dispatch(game_event_type type, game_event_data *data)
 	}
 }
 
+static void game_event_dispatch(game_event_type type, game_event_data *data)
+{
+	if (!event_has_handlers(type)) return;
+	if (is_held(type)) {
+		hold_event(type, data, NULL);
+	} else {
+		send_event(type, data);
+	}
+}
+
+/**
+ * Send events returned by event_take_held() to the handlers they have now,
+ * in the order they were signalled, and free them.
+ */
+void event_send_held(struct held_event *held)
+{
+	struct held_event *h;
+
+	for (h = held; h; h = h->next) {
+		if (event_has_handlers(h->type)) {
+			send_event(h->type, &h->data);
+		}
+	}
+	event_free_held(held);
+}
+
 void event_add_handler(game_event_type type, game_event_handler *fn, void *user)
 {
 	struct event_handler_entry *new;
@@ -59,6 +202,7 @@ void event_add_handler(game_event_type type, game_event_handler *fn, void *user)
 	/* Add it to the head of the appropriate list */
 	new->next = event_handlers[type];
 	event_handlers[type] = new;
+	mark_present(type);
 }
 
 void event_remove_handler(game_event_type type, game_event_handler *fn, void *user)
@@ -82,6 +226,7 @@ void event_remove_handler(game_event_type type, game_event_handler *fn, void *us
 			}
 
 			mem_free(this);
+			mark_present(type);
 			return;
 		}
 
@@ -100,6 +245,7 @@ void event_remove_handler_type(game_event_type type)
 		handler = next;
 	}
 	event_handlers[type] = NULL;
+	mark_present(type);
 }
 
 void event_remove_all_handlers(void)
@@ -116,6 +262,10 @@ void event_remove_all_handlers(void)
 		}
 		event_handlers[type] = NULL;
 	}
+	memset(event_present, 0, sizeof(event_present));
+	memset(event_held, 0, sizeof(event_held));
+	event_free_held(event_take_held());
+	map_region_pending = false;
 }
 
 void event_add_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user)
@@ -137,8 +287,21 @@ void event_remove_handler_set(game_event_type *type, size_t n_types, game_event_
 
 
 
+/**
+ * Send EVENT_MAP_REGION if any map grids have changed since it was last sent.
+ * This happens on every EVENT_REFRESH, and can be done sooner by a front end
+ * that is about to show the map.
+ */
+void event_flush_regions(void)
+{
+	if (!map_region_pending) return;
+	map_region_pending = false;
+	game_event_dispatch(EVENT_MAP_REGION, NULL);
+}
+
 void event_signal(game_event_type type)
 {
+	if (type == EVENT_REFRESH) event_flush_regions();
 	game_event_dispatch(type, NULL);
 }
 
@@ -154,6 +317,12 @@ void event_signal_flag(game_event_type type, bool flag)
 void event_signal_point(game_event_type type, int x, int y)
 {
 	game_event_data data;
+
+	if (type == EVENT_MAP && event_has_handlers(EVENT_MAP_REGION)) {
+		map_region_pending = true;
+	}
+	if (!event_has_handlers(type)) return;
+
 	data.point.x = x;
 	data.point.y = y;
 
@@ -166,6 +335,10 @@ void event_signal_string(game_event_type type, const char *s)
 	game_event_data data;
 	data.string = s;
 
+	if (is_held(type) && event_has_handlers(type)) {
+		hold_event(type, &data, s);
+		return;
+	}
 	game_event_dispatch(type, &data);
 }
 
@@ -269,6 +442,15 @@ void event_signal_size(game_event_type type, int h, int w)
 	game_event_dispatch(type, &data);
 }
 
+void event_signal_phase(game_event_type type, int phase, uint32_t usec)
+{
+	game_event_data data;
+
+	data.phase.phase = phase;
+	data.phase.usec = usec;
+	game_event_dispatch(type, &data);
+}
+
 void event_signal_tunnel(game_event_type type, int nstep, int npierce, int ndug,
 		int dstart, int dend, bool early)
 {
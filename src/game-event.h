@@ -27,6 +27,8 @@
 typedef enum game_event_type
 {
 	EVENT_MAP = 0,		/* Some part of the map has changed. */
+	EVENT_MAP_REGION,	/* Some part of the map has changed since the
+				   last refresh; sent just before EVENT_REFRESH */
 
 	EVENT_STATS,  		/* One or more of the stats. */
 	EVENT_HP,	   	/* HP or MaxHP. */
@@ -94,6 +96,8 @@ typedef enum game_event_type
 	/* Events for introspection into dungeon generation */
 	EVENT_GEN_LEVEL_START, /* has string in event data for profile name */
 	EVENT_GEN_LEVEL_END, /* has flag in event data indicating success */
+	EVENT_GEN_LEVEL_RESTART, /* has string in event data with the reason */
+	EVENT_GEN_PHASE_END, /* has phase in event data with its duration */
 	EVENT_GEN_ROOM_START, /* has string in event data for room type */
 	EVENT_GEN_ROOM_CHOOSE_SIZE, /* has size in event data */
 	EVENT_GEN_ROOM_CHOOSE_SUBTYPE, /* has string in event data with name */
@@ -196,6 +200,13 @@ typedef union
 		 */
 		bool early;
 	} tunnel;
+
+	struct
+	{
+		/* "phase" is one of enum gen_phase; "usec" is its duration */
+		int phase;
+		uint32_t usec;
+	} phase;
 } game_event_data;
 
 
@@ -213,6 +224,13 @@ void event_remove_handler_type(game_event_type type);
 void event_remove_all_handlers(void);
 void event_add_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user);
 void event_remove_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user);
+bool event_has_handlers(game_event_type type);
+struct held_event;
+void event_hold(game_event_type type, bool hold);
+struct held_event *event_take_held(void);
+void event_send_held(struct held_event *held);
+void event_free_held(struct held_event *held);
+void event_flush_regions(void);
 
 void event_signal_birthpoints(const int *points, const int *inc_points,
 	int remaining);
@@ -245,6 +263,7 @@ void event_signal_missile(game_event_type type,
 						  int y,
 						  int x);
 void event_signal_size(game_event_type type, int h, int w);
+void event_signal_phase(game_event_type type, int phase, uint32_t usec);
 void event_signal_tunnel(game_event_type type, int nstep, int npierce, int ndug,
 	int dstart, int dend, bool early);
 
@@ -383,21 +383,38 @@ static void decrease_timeouts(void)
  * values, thereby homing in on the player even though twisty tunnels and
  * mazes.  Monsters have a hearing value, which is the largest sound value
  * they can detect.
+ *
+ * The noise map depends only on the player's grid, the noise increment and
+ * the terrain, so it is left alone if none of those has changed since it was
+ * last built.
  */
 static void make_noise(struct player *p)
 {
 	struct loc next = p->grid;
-	int y, x, d;
+	int d;
 	int noise = 0;
 	int noise_increment = p->timed[TMD_COVERTRACKS] ? 4 : 1;
-    struct queue *queue = q_new(cave->height * cave->width);
+	struct queue *queue;
 
-	/* Set all the grids to silence */
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			cave->noise.grids[y][x] = 0;
-		}
+	/* Nothing has changed */
+	if (loc_eq(cave->noise_grid, p->grid)
+			&& cave->noise_step == noise_increment
+			&& cave->noise_stamp == cave->terrain_stamp) {
+		return;
 	}
+	cave->noise_grid = p->grid;
+	cave->noise_step = noise_increment;
+	cave->noise_stamp = cave->terrain_stamp;
+
+	/* Reuse the queue from last time */
+	if (!cave->noise_queue) {
+		cave->noise_queue = q_new(cave->height * cave->width);
+	}
+	queue = cave->noise_queue;
+
+	/* Set all the grids to silence */
+	memset(cave->noise.grids[0], 0,
+		cave->height * cave->width * sizeof(cave->noise.grids[0][0]));
 
 	/* Player makes noise */
 	cave->noise.grids[next.y][next.x] = noise;
@@ -439,8 +456,6 @@ static void make_noise(struct player *p)
 			q_push_int(queue, grid_to_i(grid, cave->width));
 		}
 	}
-
-	q_free(queue);
 }
 
 /**
@@ -1185,6 +1185,8 @@ struct chunk *classic_gen(struct player *p, int min_height, int min_width,
 		build_staircase_rooms(c, "Classic Generation");
 	}
 
+	gen_phase_start(GEN_PHASE_ROOMS);
+
 	/* Build some rooms.  Note that the theoretical maximum number of rooms
 	 * in this profile is currently 36, so built never reaches num_rooms,
 	 * and room generation is always terminated by having tried all blocks */
@@ -1267,10 +1269,12 @@ struct chunk *classic_gen(struct player *p, int min_height, int min_width,
 		FEAT_PERM, SQUARE_NONE, true);
 
 	/* Connect all the rooms together */
+	gen_phase_start(GEN_PHASE_TUNNELS);
 	do_traditional_tunneling(c);
 	ensure_connectedness(c, true);
 
 	/* Add some magma streamers */
+	gen_phase_start(GEN_PHASE_STREAMERS);
 	for (i = 0; i < dun->profile->str.mag; i++)
 		build_streamer(c, FEAT_MAGMA, dun->profile->str.mc);
 
@@ -1279,6 +1283,7 @@ struct chunk *classic_gen(struct player *p, int min_height, int min_width,
 		build_streamer(c, FEAT_QUARTZ, dun->profile->str.qc);
 
 	/* Place 3 or 4 down stairs and 1 or 2 up stairs near some walls */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	handle_level_stairs(c, dun->persist, dun->quest,
 		rand_range(3, 4), rand_range(1, 2));
 
@@ -1308,6 +1313,9 @@ struct chunk *classic_gen(struct player *p, int min_height, int min_width,
 		pick_and_place_distant_monster(c, p->grid, 0, true, c->depth);
 	}
 
+	/* Give up before placing objects if the monster list overflowed */
+	if (abandon_overflowed_level(c, p, p_error)) return NULL;
+
 	/* Put some objects in rooms */
 	alloc_objects(c, SET_ROOM, TYP_OBJECT,
 		Rand_normal(z_info->room_item_av, 3), c->depth, ORIGIN_FLOOR);
@@ -1550,6 +1558,7 @@ struct chunk *labyrinth_gen(struct player *p, int min_height, int min_width,
 	}
 
 	/* Determine the character location */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	if (!new_player_spot(c, p)) {
 		uncreate_artifacts(c);
 		cave_free(c);
@@ -1582,6 +1591,9 @@ struct chunk *labyrinth_gen(struct player *p, int min_height, int min_width,
 		pick_and_place_distant_monster(c, p->grid, 0, true, c->depth);
 	}
 
+	/* Give up before placing objects if the monster list overflowed */
+	if (abandon_overflowed_level(c, p, p_error)) return NULL;
+
 	/* Put some objects/gold in the dungeon */
 	alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(k * 6, 2), c->depth,
 		ORIGIN_LABYRINTH);
@@ -2189,6 +2201,7 @@ struct chunk *cavern_gen(struct player *p, int min_height, int min_width,
 	draw_rectangle(c, 0, 0, h - 1, w - 1, FEAT_PERM, SQUARE_NONE, true);
 
 	/* Place 1-3 down stairs and 1-2 up stairs near some walls */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	handle_level_stairs(c, dun->persist, dun->quest,
 		rand_range(1, 3), rand_range(1, 2));
 
@@ -2216,6 +2229,9 @@ struct chunk *cavern_gen(struct player *p, int min_height, int min_width,
 		pick_and_place_distant_monster(c, p->grid, 0, true, c->depth);
 	}
 
+	/* Give up before placing objects if the monster list overflowed */
+	if (abandon_overflowed_level(c, p, p_error)) return NULL;
+
 	/* Put some objects/gold in the dungeon */
 	alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(k, 2), c->depth + 5,
 		ORIGIN_CAVERN);
@@ -2772,6 +2788,8 @@ static struct chunk *modified_chunk(struct player *p, int depth, int height,
 		build_staircase_rooms(c, "Modified Generation");
 	}
 
+	gen_phase_start(GEN_PHASE_ROOMS);
+
 	/*
 	 * Build rooms until we have enough floor grids and at least two rooms
 	 * or we appear to be stuck and can't match those criteria.
@@ -2832,6 +2850,7 @@ static struct chunk *modified_chunk(struct player *p, int depth, int height,
 	mem_free(dun->room_map);
 
 	/* Connect all the rooms together */
+	gen_phase_start(GEN_PHASE_TUNNELS);
 	do_traditional_tunneling(c);
 	ensure_connectedness(c, true);
 
@@ -2908,6 +2927,7 @@ struct chunk *modified_gen(struct player *p, int min_height, int min_width,
 		FEAT_PERM, SQUARE_NONE, true);
 
 	/* Add some magma streamers */
+	gen_phase_start(GEN_PHASE_STREAMERS);
 	for (i = 0; i < dun->profile->str.mag; i++)
 		build_streamer(c, FEAT_MAGMA, dun->profile->str.mc);
 
@@ -2916,6 +2936,7 @@ struct chunk *modified_gen(struct player *p, int min_height, int min_width,
 		build_streamer(c, FEAT_QUARTZ, dun->profile->str.qc);
 
 	/* Place 3 or 4 down stairs and 1 or 2 up stairs near some walls */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	handle_level_stairs(c, dun->persist, dun->quest,
 		rand_range(3, 4), rand_range(1, 2));
 
@@ -2948,6 +2969,9 @@ struct chunk *modified_gen(struct player *p, int min_height, int min_width,
 		pick_and_place_distant_monster(c, p->grid, 0, true, c->depth);
 	}
 
+	/* Give up before placing objects if the monster list overflowed */
+	if (abandon_overflowed_level(c, p, p_error)) return NULL;
+
 	/* Put some objects in rooms */
 	alloc_objects(c, SET_ROOM, TYP_OBJECT,
 		Rand_normal(z_info->room_item_av, 3), c->depth, ORIGIN_FLOOR);
@@ -3018,6 +3042,8 @@ static struct chunk *moria_chunk(struct player *p, int depth, int height,
 		build_staircase_rooms(c, "Moria Generation");
 	}
 
+	gen_phase_start(GEN_PHASE_ROOMS);
+
 	/*
 	 * Build rooms until we have enough floor grids and at least two rooms
 	 * (the latter is to make it easier to satisfy the constraints for
@@ -3079,6 +3105,7 @@ static struct chunk *moria_chunk(struct player *p, int depth, int height,
 	mem_free(dun->room_map);
 
 	/* Connect all the rooms together */
+	gen_phase_start(GEN_PHASE_TUNNELS);
 	do_traditional_tunneling(c);
 	ensure_connectedness(c, true);
 
@@ -3146,6 +3173,7 @@ struct chunk *moria_gen(struct player *p, int min_height, int min_width,
 		FEAT_PERM, SQUARE_NONE, true);
 
 	/* Add some magma streamers */
+	gen_phase_start(GEN_PHASE_STREAMERS);
 	for (i = 0; i < dun->profile->str.mag; i++)
 		build_streamer(c, FEAT_MAGMA, dun->profile->str.mc);
 
@@ -3154,6 +3182,7 @@ struct chunk *moria_gen(struct player *p, int min_height, int min_width,
 		build_streamer(c, FEAT_QUARTZ, dun->profile->str.qc);
 
 	/* Place 3 or 4 down stairs and 1 or 2 up stairs near some walls */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	handle_level_stairs(c, dun->persist, dun->quest,
 		rand_range(3, 4), rand_range(1, 2));
 
@@ -3189,6 +3218,9 @@ struct chunk *moria_gen(struct player *p, int min_height, int min_width,
 	/* Remove our restrictions. */
 	(void) mon_restrict(NULL, c->depth, c->depth, false);
 
+	/* Give up before placing objects if the monster list overflowed */
+	if (abandon_overflowed_level(c, p, p_error)) return NULL;
+
 	/* Put some objects in rooms */
 	alloc_objects(c, SET_ROOM, TYP_OBJECT,
 		Rand_normal(z_info->room_item_av, 3), c->depth, ORIGIN_FLOOR);
@@ -3474,6 +3506,7 @@ struct chunk *hard_centre_gen(struct player *p, int min_height, int min_width,
 		centre_cavern_wid * (upper_cavern_hgt + lower_cavern_hgt);
 
 	/* Place 2-3 down stairs near some walls */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	alloc_stairs(c, FEAT_MORE, rand_range(1, 3), 0, false, NULL,
 		dun->quest);
 
@@ -3507,6 +3540,9 @@ struct chunk *hard_centre_gen(struct player *p, int min_height, int min_width,
 		pick_and_place_distant_monster(c, p->grid, 0, true, c->depth);
 	}
 
+	/* Give up before placing objects if the monster list overflowed */
+	if (abandon_overflowed_level(c, p, p_error)) return NULL;
+
 	/* Put some objects/gold in the dungeon */
 	alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(k, 2), c->depth + 5,
 		ORIGIN_CAVERN);
@@ -3625,6 +3661,7 @@ struct chunk *lair_gen(struct player *p, int min_height, int min_width,
 	k = MAX(MIN(p->depth / 3, 10), 2) / 2;
 
 	/* Put the character in the normal half */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	if (!new_player_spot(normal, p)) {
 		uncreate_artifacts(lair);
 		cave_free(lair);
@@ -3645,6 +3682,7 @@ struct chunk *lair_gen(struct player *p, int min_height, int min_width,
 	}
 
 	/* Add some magma streamers */
+	gen_phase_start(GEN_PHASE_STREAMERS);
 	for (i = 0; i < dun->profile->str.mag; i++)
 		build_streamer(normal, FEAT_MAGMA, dun->profile->str.mc);
 
@@ -3653,6 +3691,7 @@ struct chunk *lair_gen(struct player *p, int min_height, int min_width,
 		build_streamer(normal, FEAT_QUARTZ, dun->profile->str.qc);
 
 	/* Pick a larger number of monsters for the lair */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	i = (z_info->level_monster_min + randint1(20) + k);
 
 	/* Find appropriate monsters */
@@ -3690,9 +3729,14 @@ struct chunk *lair_gen(struct player *p, int min_height, int min_width,
 		FEAT_PERM, SQUARE_NONE, true);
 
 	/* Connect */
+	gen_phase_start(GEN_PHASE_TUNNELS);
 	ensure_connectedness(c, true);
 
+	/* Give up before placing objects if the monster list overflowed */
+	if (abandon_overflowed_level(c, p, p_error)) return NULL;
+
 	/* Place 3 or 4 down stairs and 1 or 2 up stairs near some walls */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	handle_level_stairs(c, dun->persist, dun->quest,
 		rand_range(3, 4), rand_range(1, 2));
 
@@ -3796,6 +3840,7 @@ struct chunk *gauntlet_gen(struct player *p, int min_height, int min_width,
 		SQUARE_NO_TELEPORT);
 
 	/* Place down stairs in the right cavern */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	alloc_stairs(right, FEAT_MORE, rand_range(2, 3), 0, false, NULL,
 		dun->quest);
 
@@ -3950,9 +3995,14 @@ struct chunk *gauntlet_gen(struct player *p, int min_height, int min_width,
 		FEAT_PERM, SQUARE_NONE, true);
 
 	/* Connect */
+	gen_phase_start(GEN_PHASE_TUNNELS);
 	ensure_connectedness(c, true);
 
+	/* Give up before placing objects if the monster list overflowed */
+	if (abandon_overflowed_level(c, p, p_error)) return NULL;
+
 	/* Put some rubble in corridors */
+	gen_phase_start(GEN_PHASE_ALLOC);
 	alloc_objects(c, SET_CORR, TYP_RUBBLE, randint1(k), c->depth, 0);
 
 	/* Place some traps in the dungeon */
@@ -49,12 +49,13 @@ struct chunk *chunk_write(struct chunk *c)
 
 	struct chunk *new = cave_new(c->height, c->width);
 
-	/* Write the location stuff */
+	/* Write the location stuff; the info flags are one contiguous block */
+	memcpy(new->squares[0][0].info, c->squares[0][0].info,
+		c->height * c->width * SQUARE_SIZE * sizeof(bitflag));
 	for (y = 0; y < new->height; y++) {
 		for (x = 0; x < new->width; x++) {
 			/* Terrain */
 			new->squares[y][x].feat = square(c, loc(x, y))->feat;
-			sqinfo_copy(square(new, loc(x, y))->info, square(c, loc(x, y))->info);
 		}
 	}
 
@@ -426,7 +427,7 @@ bool chunk_copy(struct chunk *dest, struct player *p, struct chunk *source,
 
 		/* Move grid */
 		symmetry_transform(&dest_mon->grid, y0, x0, h, w, rotate, reflect);
-		dest->squares[dest_mon->grid.y][dest_mon->grid.x].mon = dest_mon->midx;
+		square_set_mon(dest, dest_mon->grid, dest_mon->midx);
 
 		/* Held or mimicked objects */
 		if (source_mon->held_obj) {
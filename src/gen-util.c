@@ -918,6 +918,36 @@ void vault_monsters(struct chunk *c, struct loc grid, int depth, int num)
 	}
 }
 
+/**
+ * Check whether a level being built has used up its monster list.  Nothing
+ * frees monster slots during generation, so once this is true the level is
+ * bound to be thrown away; builders check it before placing objects so they
+ * can give up early.
+ * \param c the current chunk
+ */
+bool monsters_overflowed(struct chunk *c)
+{
+	return cave_monster_max(c) >= z_info->level_monster_max;
+}
+
+/**
+ * Throw away a level being built if its monster list has overflowed.
+ * \param c the current chunk; freed if this returns true
+ * \param p the player
+ * \param p_error set to the reason for giving up if this returns true
+ * \return whether the level was thrown away
+ */
+bool abandon_overflowed_level(struct chunk *c, struct player *p,
+		const char **p_error)
+{
+	if (!monsters_overflowed(c)) return false;
+	uncreate_artifacts(c);
+	wipe_mon_list(c, p);
+	cave_free(c);
+	*p_error = "too many monsters";
+	return true;
+}
+
 /**
  * Mark artifacts in a failed chunk as not created
  */
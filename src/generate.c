@@ -35,6 +35,7 @@
 #include "game-world.h"
 #include "generate.h"
 #include "init.h"
+#include "mon-group.h"
 #include "mon-make.h"
 #include "mon-move.h"
 #include "mon-spell.h"
@@ -86,6 +87,97 @@ static const char *room_flags[] = {
 	NULL
 };
 
+static const char *gen_phase_names[] = {
+	"carve",
+	"rooms",
+	"tunnels",
+	"streamers",
+	"allocation"
+};
+
+/**
+ * The phase of building a level that is being timed, or -1, and when it
+ * began
+ */
+static int gen_phase_current = -1;
+static clock_t gen_phase_began;
+
+/**
+ * The global state that building a level changes: which artifacts have been
+ * created, and how many monsters of each race there are
+ */
+struct gen_state {
+	bool *created;
+	int *cur_num;
+};
+
+/**
+ * A message about a level built ahead of time, kept for when it is entered
+ */
+struct level_note {
+	struct level_note *next;
+	char *text;
+};
+
+/**
+ * A level built ahead of time by pregenerate_level(), with what is needed to
+ * check that it is still the level the player would get
+ */
+struct pregen_level {
+	struct chunk *cave;			/* The level */
+	struct chunk *known;		/* The player's knowledge of the level */
+	int depth;					/* Depth the level was built for */
+	uint32_t seed;				/* Seed of the stream it was built from */
+	struct loc from;			/* Player grid when the level was built */
+	struct loc grid;			/* Player grid on arrival */
+	bool up_stair;				/* Connected up staircase asked for */
+	bool down_stair;			/* Connected down staircase asked for */
+	bool light;					/* Light the level on arrival */
+	struct gen_state now;		/* State when the level was built */
+	struct gen_state before;	/* State once the old level is left */
+	struct gen_state after;		/* State once the new level is built */
+	struct held_event *events;	/* Generation events from building it */
+	struct level_note *notes;	/* Messages from building it, oldest first */
+	struct level_note **notes_tail;
+};
+
+static struct pregen_level *pregen;
+
+/**
+ * How many levels have been built ahead of time, and how many of them used
+ */
+static uint32_t pregen_built, pregen_used;
+
+/**
+ * Whether pregenerate_level() is building a level, which the player may
+ * never enter
+ */
+static bool pregenerating;
+
+/**
+ * Show a message about the level being built; for a level built ahead of
+ * time, keep it until the player enters the level.
+ */
+void level_msg(const char *fmt, ...)
+{
+	va_list vp;
+	char buf[1024];
+	struct level_note *note;
+
+	va_start(vp, fmt);
+	(void)vstrnfmt(buf, sizeof(buf), fmt, vp);
+	va_end(vp);
+
+	if (!pregenerating) {
+		msg("%s", buf);
+		return;
+	}
+	note = mem_zalloc(sizeof(*note));
+	note->text = string_make(buf);
+	*pregen->notes_tail = note;
+	pregen->notes_tail = &note->next;
+}
+
 
 /**
  * Parsing functions for dungeon_profile.txt
@@ -1094,7 +1186,9 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 	if (p->upkeep->arena_level) {
 		/* Generate level */
 		event_signal_string(EVENT_GEN_LEVEL_START, "arena");
+		gen_phase_start(GEN_PHASE_CARVE);
 		chunk = arena_gen(p, height, width);
+		gen_phase_stop();
 
 		/* Allocate new known level, light it if requested */
 		p->cave = cave_new(chunk->height, chunk->width);
@@ -1156,20 +1250,24 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 		/* Choose a profile and build the level */
 		dun->profile = choose_profile(p);
 		event_signal_string(EVENT_GEN_LEVEL_START, dun->profile->name);
+		gen_phase_start(GEN_PHASE_CARVE);
 		chunk = dun->profile->builder(p, height, width, &error);
+		gen_phase_stop();
 		if (!chunk) {
 			if (!error) {
 				error = "unspecified level builder failure";
 			}
 			if (OPT(p, cheat_room)) {
-				msg("Generation restarted: %s.", error);
+				level_msg("Generation restarted: %s.", error);
 			}
 			cleanup_dun_data(dun);
+			event_signal_string(EVENT_GEN_LEVEL_RESTART, error);
 			event_signal_flag(EVENT_GEN_LEVEL_END, false);
 			continue;
 		}
 
 		/* Ensure quest monsters */
+		gen_phase_start(GEN_PHASE_ALLOC);
 		if (dun->quest) {
 			for (i = 0; i < z_info->quest_max; i++) {
 				struct quest *q = &player->quests[i];
@@ -1215,16 +1313,19 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 			}
 		}
 
+		gen_phase_stop();
+
 		/* Regenerate levels that overflow their maxima */
-		if (cave_monster_max(chunk) >= z_info->level_monster_max)
+		if (monsters_overflowed(chunk))
 			error = "too many monsters";
 
 		if (error) {
 			if (OPT(p, cheat_room)) {
-				msg("Generation restarted: %s.", error);
+				level_msg("Generation restarted: %s.", error);
 			}
 			uncreate_artifacts(chunk);
 			cave_clear(chunk, p);
+			event_signal_string(EVENT_GEN_LEVEL_RESTART, error);
 			event_signal_flag(EVENT_GEN_LEVEL_END, false);
 		}
 
@@ -1252,10 +1353,6 @@ static struct chunk *cave_generate(struct player *p, int height, int width)
 	for (i = 0; i <= p->cave->obj_max; i++) {
 		p->cave->objects[i] = NULL;
 	}
-	if (p->upkeep->light_level) {
-		wiz_light(chunk, p, false);
-		p->upkeep->light_level = false;
-	}
 
 	chunk->turn = turn;
 
@@ -1338,6 +1435,244 @@ static void sanitize_player_loc(struct chunk *c, struct player *p)
 	p->grid.y = vy;
 }
 
+/**
+ * Deal with the artifacts lying on a level the player is leaving: they are
+ * lost if the player knows about them or artifacts are always lost, and can
+ * be generated again otherwise.
+ * \param c is the level being left
+ * \param p is the player
+ * \param record is whether to note lost artifacts in the player's history
+ */
+static void leave_floor_artifacts(struct chunk *c, struct player *p,
+		bool record)
+{
+	int x, y;
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			struct object *obj = square_object(c, loc(x, y));
+			while (obj) {
+				if (obj->artifact) {
+					bool found = obj_is_known_artifact(obj);
+					if (OPT(p, birth_lose_arts) || found) {
+						if (record) {
+							history_lose_artifact(p, obj->artifact);
+						}
+						mark_artifact_created(obj->artifact, true);
+					} else {
+						mark_artifact_created(obj->artifact, false);
+					}
+				}
+
+				obj = obj->next;
+			}
+		}
+	}
+}
+
+/**
+ * Make the changes to artifacts and monster race counts that wipe_mon_list()
+ * makes when the player leaves a level, without touching the level itself.
+ * \param c is the level being left
+ */
+static void leave_monsters(struct chunk *c)
+{
+	int m_idx;
+
+	for (m_idx = cave_monster_max(c) - 1; m_idx >= 1; m_idx--) {
+		struct monster *mon = cave_monster(c, m_idx);
+		struct object *obj;
+
+		/* Skip dead monsters */
+		if (!mon->race) continue;
+
+		/* Unknown artifacts carried by monsters can turn up again */
+		for (obj = mon->held_obj; obj; obj = obj->next) {
+			if (obj->artifact && !obj_is_known_artifact(obj)) {
+				mark_artifact_created(obj->artifact, false);
+			}
+		}
+
+		/* Reduce the racial counter */
+		if (mon->original_race) mon->original_race->cur_num--;
+		else mon->race->cur_num--;
+	}
+}
+
+/**
+ * Record the global state that building a level changes.
+ */
+static void gen_state_save(struct gen_state *s)
+{
+	int i;
+
+	if (!s->created) {
+		s->created = mem_alloc(z_info->a_max * sizeof(*s->created));
+		s->cur_num = mem_alloc(z_info->r_max * sizeof(*s->cur_num));
+	}
+	for (i = 0; i < z_info->a_max; i++) {
+		s->created[i] = aup_info[i].created;
+	}
+	for (i = 0; i < z_info->r_max; i++) {
+		s->cur_num[i] = r_info[i].cur_num;
+	}
+}
+
+/**
+ * Put back global state recorded with gen_state_save().
+ */
+static void gen_state_load(const struct gen_state *s)
+{
+	int i;
+
+	for (i = 0; i < z_info->a_max; i++) {
+		aup_info[i].created = s->created[i];
+	}
+	for (i = 0; i < z_info->r_max; i++) {
+		r_info[i].cur_num = s->cur_num[i];
+	}
+}
+
+/**
+ * Check whether global state recorded with gen_state_save() is the same as
+ * it is now.
+ */
+static bool gen_state_current(const struct gen_state *s)
+{
+	int i;
+
+	for (i = 0; i < z_info->a_max; i++) {
+		if (aup_info[i].created != s->created[i]) return false;
+	}
+	for (i = 0; i < z_info->r_max; i++) {
+		if (r_info[i].cur_num != s->cur_num[i]) return false;
+	}
+	return true;
+}
+
+static void gen_state_free(struct gen_state *s)
+{
+	mem_free(s->created);
+	mem_free(s->cur_num);
+	s->created = NULL;
+	s->cur_num = NULL;
+}
+
+/**
+ * Get the seed for building a dungeon level when levels are built ahead of
+ * time.  It depends only on the game, the turn the player arrived on the
+ * level being left and the depth, so it stays the same for as long as the
+ * player stays on that level and the level is the same whenever it is built.
+ * \param from is the level being left, or NULL if there is none
+ * \param depth is the depth of the level to build
+ */
+static uint32_t level_seed(const struct chunk *from, int depth)
+{
+	uint32_t arrived = from ? (uint32_t) from->turn : 0;
+	uint32_t seed = seed_flavor ^ (arrived * 0x9E3779B1U);
+
+	return seed ^ ((uint32_t) depth * 0x85EBCA6BU);
+}
+
+/**
+ * Generate a dungeon level from a random number stream of its own, leaving
+ * the default stream as it was.
+ * \param p is the current player struct, in practice the global player
+ * \param seed is the seed for the stream, from level_seed()
+ * \return a pointer to the new level
+ */
+static struct chunk *cave_generate_forked(struct player *p, uint32_t seed)
+{
+	struct rng_state *rs = rng_default();
+	struct rng_state saved = *rs;
+	struct chunk *chunk;
+
+	rng_state_init(rs, seed);
+	chunk = cave_generate(p, 0, 0);
+	*rs = saved;
+
+	return chunk;
+}
+
+/**
+ * Throw away the level built ahead of time, if there is one.  The race
+ * counts and artifacts never included its contents, so it is freed without
+ * wipe_mon_list().
+ */
+static void pregen_free(void)
+{
+	int i;
+
+	if (!pregen) return;
+	if (pregen->cave) {
+		for (i = 1; i < z_info->level_monster_max; i++) {
+			if (pregen->cave->monster_groups[i]) {
+				monster_group_free(pregen->cave,
+					pregen->cave->monster_groups[i]);
+			}
+		}
+		cave_free(pregen->cave);
+		cave_free(pregen->known);
+	}
+	gen_state_free(&pregen->now);
+	gen_state_free(&pregen->before);
+	gen_state_free(&pregen->after);
+	event_free_held(pregen->events);
+	while (pregen->notes) {
+		struct level_note *note = pregen->notes;
+
+		pregen->notes = note->next;
+		string_free(note->text);
+		mem_free(note);
+	}
+	mem_free(pregen);
+	pregen = NULL;
+}
+
+/**
+ * Take the level built ahead of time if the player has arrived where it was
+ * built for, with the old level left behind in the same way.
+ * \param p is the current player struct, in practice the global player
+ * \param seed is the seed the level would be built from now
+ * \return the level, or NULL if there is none to use
+ */
+static struct chunk *pregen_take(struct player *p, uint32_t seed)
+{
+	struct chunk *chunk;
+	struct level_note *note;
+
+	if (!pregen || pregen->depth != p->depth || pregen->seed != seed
+			|| !loc_eq(pregen->from, p->grid)
+			|| pregen->up_stair != p->upkeep->create_up_stair
+			|| pregen->down_stair != p->upkeep->create_down_stair
+			|| !gen_state_current(&pregen->before)) {
+		return NULL;
+	}
+
+	/* Do what building the level would have done */
+	chunk = pregen->cave;
+	p->cave = pregen->known;
+	p->grid = pregen->grid;
+	p->upkeep->create_up_stair = false;
+	p->upkeep->create_down_stair = false;
+	p->upkeep->light_level = pregen->light;
+	gen_state_load(&pregen->after);
+	chunk->turn = turn;
+
+	/* Report the level as if it had just been built */
+	event_send_held(pregen->events);
+	pregen->events = NULL;
+	for (note = pregen->notes; note; note = note->next) {
+		msg("%s", note->text);
+	}
+
+	pregen->cave = NULL;
+	pregen->known = NULL;
+	pregen_free();
+	pregen_used++;
+	return chunk;
+}
+
 /**
  * Prepare the level the player is about to enter, either by generating
  * or reloading
@@ -1347,11 +1682,15 @@ static void sanitize_player_loc(struct chunk *c, struct player *p)
 void prepare_next_level(struct player *p)
 {
 	bool persist = OPT(p, birth_levels_persist) || p->upkeep->arena_level;
+	uint32_t seed = level_seed(character_dungeon ? cave : NULL, p->depth);
 
 	/* Deal with any existing current level */
 	if (character_dungeon) {
 		assert (p->cave);
 
+		/* Monsters on the old level get no more energy */
+		unschedule_monsters(cave);
+
 		if (persist) {
 			/* Arenas don't get stored */
 			if (!cave->name || !streq(cave->name, "arena")) {
@@ -1374,27 +1713,8 @@ void prepare_next_level(struct player *p)
 
 			/* Forget knowledge of old level */
 			if (p->cave) {
-				int x, y;
-
 				/* Deal with artifacts */
-				for (y = 0; y < cave->height; y++) {
-					for (x = 0; x < cave->width; x++) {
-						struct object *obj = square_object(cave, loc(x, y));
-						while (obj) {
-							if (obj->artifact) {
-								bool found = obj_is_known_artifact(obj);
-								if (OPT(p, birth_lose_arts) || found) {
-									history_lose_artifact(p, obj->artifact);
-									mark_artifact_created(obj->artifact, true);
-								} else {
-									mark_artifact_created(obj->artifact, false);
-								}
-							}
-
-							obj = obj->next;
-						}
-					}
-				}
+				leave_floor_artifacts(cave, p, true);
 
 				/* Free the known cave */
 				cave_free(p->cave);
@@ -1536,12 +1856,28 @@ void prepare_next_level(struct player *p)
 			cave = cave_generate(p, min_height, min_width);
 			event_signal_flag(EVENT_GEN_LEVEL_END, true);
 		}
+	} else if (p->depth && OPT(p, pregenerate_levels)) {
+		/* Use the level built ahead of time, or build it the same way */
+		cave = pregen_take(p, seed);
+		if (!cave) {
+			cave = cave_generate_forked(p, seed);
+		}
+		event_signal_flag(EVENT_GEN_LEVEL_END, true);
 	} else {
 		/* Generate a new level */
 		cave = cave_generate(p, 0, 0);
 		event_signal_flag(EVENT_GEN_LEVEL_END, true);
 	}
 
+	/* A level built ahead of time for somewhere else is no use now */
+	pregen_free();
+
+	/* Light the level if it asked for it */
+	if (p->upkeep->light_level) {
+		wiz_light(cave, p, false);
+		p->upkeep->light_level = false;
+	}
+
 	/* Know the town */
 	if (!(p->depth)) {
 		cave_known(p);
@@ -1555,6 +1891,127 @@ void prepare_next_level(struct player *p)
 	character_dungeon = true;
 }
 
+/**
+ * Start or stop holding back the level generation events, so that a level
+ * built ahead of time is reported only when the player enters it
+ */
+static void hold_generation_events(bool hold)
+{
+	int type;
+
+	for (type = EVENT_GEN_LEVEL_START; type <= EVENT_GEN_TUNNEL_FINISHED;
+			type++) {
+		event_hold(type, hold);
+	}
+}
+
+/**
+ * Build the level that the staircase under the player leads to, so that
+ * prepare_next_level() can use it straight away if the player takes the
+ * stairs.  Nothing else changes: leaving the current level is played out on
+ * the artifacts and race counts only while the level is built, and the level
+ * is built from the stream prepare_next_level() would use for it.  A level
+ * once built is kept for as long as it is still the one the stairs lead to,
+ * so waiting on the stairs builds it only once.
+ *
+ * \param p is the current player struct, in practice the global player
+ */
+void pregenerate_level(struct player *p)
+{
+	struct chunk *old_cave = cave, *old_known = p->cave;
+	struct player_upkeep old_upkeep;
+	struct loc old_grid = p->grid;
+	int old_depth = p->depth, depth;
+	uint32_t seed;
+	bool up, down;
+
+	/* Only for levels that are generated afresh */
+	if (!OPT(p, pregenerate_levels) || !character_dungeon || p->is_dead
+			|| p->upkeep->generate_level || p->upkeep->arena_level
+			|| OPT(p, birth_levels_persist)
+			|| (p->noscore & NOSCORE_JUMPING)) {
+		return;
+	}
+
+	/* Find where the stairs lead, as do_cmd_go_down() and do_cmd_go_up() do */
+	if (square_isdownstairs(cave, p->grid)) {
+		if (p->depth == z_info->max_depth - 1) return;
+		depth = dungeon_get_next_level(p, OPT(p, birth_force_descend) ?
+			p->max_depth : p->depth, 1);
+		up = true;
+		down = false;
+	} else if (square_isupstairs(cave, p->grid)
+			&& !OPT(p, birth_force_descend)) {
+		depth = dungeon_get_next_level(p, p->depth, -1);
+		up = false;
+		down = true;
+	} else {
+		return;
+	}
+	if (!depth || depth == p->depth) return;
+
+	/* Already built, and nothing has happened since to change the level */
+	seed = level_seed(cave, depth);
+	if (pregen && pregen->depth == depth && pregen->seed == seed
+			&& loc_eq(pregen->from, p->grid)
+			&& gen_state_current(&pregen->now)) {
+		return;
+	}
+	pregen_free();
+
+	pregen = mem_zalloc(sizeof(*pregen));
+	pregen->depth = depth;
+	pregen->seed = seed;
+	pregen->from = p->grid;
+	pregen->up_stair = up;
+	pregen->down_stair = down;
+	pregen->notes_tail = &pregen->notes;
+
+	/* Leave the current level */
+	gen_state_save(&pregen->now);
+	leave_floor_artifacts(cave, p, false);
+	leave_monsters(cave);
+	gen_state_save(&pregen->before);
+
+	/* Build the new one as prepare_next_level() would */
+	old_upkeep = *p->upkeep;
+	cave = NULL;
+	p->cave = NULL;
+	p->depth = depth;
+	p->upkeep->create_up_stair = up;
+	p->upkeep->create_down_stair = down;
+	pregenerating = true;
+	hold_generation_events(true);
+	pregen->cave = cave_generate_forked(p, seed);
+	pregen_built++;
+	hold_generation_events(false);
+	pregenerating = false;
+	pregen->events = event_take_held();
+	pregen->known = p->cave;
+	pregen->grid = p->grid;
+	pregen->light = p->upkeep->light_level;
+	gen_state_save(&pregen->after);
+
+	/* Put everything back */
+	gen_state_load(&pregen->now);
+	*p->upkeep = old_upkeep;
+	p->depth = old_depth;
+	p->grid = old_grid;
+	p->cave = old_known;
+	cave = old_cave;
+	character_dungeon = true;
+}
+
+/**
+ * Report how many levels have been built ahead of time and how many of those
+ * the player has entered since the game started.
+ */
+void pregenerate_counts(uint32_t *built, uint32_t *used)
+{
+	*built = pregen_built;
+	*used = pregen_used;
+}
+
 /**
  * Return the number of room builders available.
  */
@@ -1615,6 +2072,50 @@ const char *get_level_profile_name_from_index(int i)
 		cave_profiles[i].name : NULL;
 }
 
+/**
+ * Start timing a phase of building a level, ending the phase before it.
+ * The time taken by each phase is signalled with EVENT_GEN_PHASE_END.
+ */
+void gen_phase_start(enum gen_phase phase)
+{
+	gen_phase_stop();
+	gen_phase_current = phase;
+	gen_phase_began = clock();
+}
+
+/**
+ * Stop timing the current phase of building a level, if there is one.
+ */
+void gen_phase_stop(void)
+{
+	double usec;
+
+	if (gen_phase_current < 0) return;
+	usec = (double) (clock() - gen_phase_began) * 1000000.0
+		/ CLOCKS_PER_SEC;
+	event_signal_phase(EVENT_GEN_PHASE_END, gen_phase_current,
+		(uint32_t) MAX(0.0, MIN(usec, 4294967295.0)));
+	gen_phase_current = -1;
+}
+
+/**
+ * Get the name of a generation phase given its index.  Return NULL if the
+ * index is out of bounds.
+ */
+const char *gen_phase_name(int i)
+{
+	return (i >= 0 && i < GEN_PHASE_MAX) ? gen_phase_names[i] : NULL;
+}
+
+/**
+ * Free the template arrays and any level built ahead of time
+ */
+static void cleanup_generate(void)
+{
+	pregen_free();
+	cleanup_template_parser();
+}
+
 /**
  * The generate module, which initialises template rooms and vaults
  * Should it clean up?
@@ -1622,5 +2123,5 @@ const char *get_level_profile_name_from_index(int i)
 struct init_module generate_module = {
 	.name = "generate",
 	.init = run_template_parser,
-	.cleanup = cleanup_template_parser
+	.cleanup = cleanup_generate
 };
@@ -35,6 +35,19 @@ enum
 	TYP_GREAT	/*!< Great object */
 };
 
+/**
+ * Phases of building a level, timed for the generation telemetry
+ */
+enum gen_phase
+{
+	GEN_PHASE_CARVE,	/*!< Laying out the basic terrain */
+	GEN_PHASE_ROOMS,	/*!< Rooms and vaults */
+	GEN_PHASE_TUNNELS,	/*!< Joining the rooms or regions up */
+	GEN_PHASE_STREAMERS,	/*!< Mineral veins */
+	GEN_PHASE_ALLOC,	/*!< Stairs, the player, monsters and objects */
+	GEN_PHASE_MAX
+};
+
 /**
  * Flag for room types
  */
@@ -318,11 +331,17 @@ extern struct room_template *room_templates;
 
 /* generate.c */
 void prepare_next_level(struct player *p);
+void pregenerate_level(struct player *p);
+void pregenerate_counts(uint32_t *built, uint32_t *used);
+void level_msg(const char *fmt, ...);
 int get_room_builder_count(void);
 int get_room_builder_index_from_name(const char *name);
 const char *get_room_builder_name_from_index(int i);
 int get_level_profile_index_from_name(const char *name);
 const char *get_level_profile_name_from_index(int i);
+void gen_phase_start(enum gen_phase phase);
+void gen_phase_stop(void);
+const char *gen_phase_name(int i);
 
 /* gen-cave.c */
 struct chunk *town_gen(struct player *p, int min_height, int min_width,
@@ -437,6 +456,9 @@ void alloc_stairs(struct chunk *c, int feat, int num, int minsep, bool sepany,
 void vault_objects(struct chunk *c, struct loc grid, int depth, int num);
 void vault_traps(struct chunk *c, struct loc grid, int yd, int xd, int num);
 void vault_monsters(struct chunk *c, struct loc grid, int depth, int num);
+bool monsters_overflowed(struct chunk *c);
+bool abandon_overflowed_level(struct chunk *c, struct player *p,
+	const char **p_error);
 int alloc_objects(struct chunk *c, int set, int typ, int num, int depth,
 	uint8_t origin);
 bool alloc_object(struct chunk *c, int set, int typ, int depth, uint8_t origin);
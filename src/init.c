@@ -2276,9 +2276,17 @@ static errr run_parse_feat(struct parser *p) {
 }
 
 static errr finish_parse_feat(struct parser *p) {
-	int shop_idx = 0, fidx;
+	int shop_idx = 0, fidx, flag;
 
+	assert(TF_MAX <= 32);
 	for (fidx = 0; fidx < FEAT_MAX; ++fidx) {
+		/* Pack the terrain flags for quick testing */
+		f_props[fidx] = 0;
+		for (flag = 1; flag < TF_MAX; flag++) {
+			if (tf_has(f_info[fidx].flags, flag)) {
+				f_props[fidx] |= 1U << flag;
+			}
+		}
 		/*
 		 * Assign shop index based on the order within the other
 		 * terrain.
@@ -4464,6 +4472,7 @@ static void cleanup_arrays(void)
 		cleanup_parser(pl[i].parser);
 
 	cleanup_parser(pl[0].parser);
+	cleanup_name_indices();
 }
 
 static struct init_module arrays_module = {
@@ -4480,6 +4489,7 @@ extern struct init_module obj_make_module;
 extern struct init_module ignore_module;
 extern struct init_module mon_make_module;
 extern struct init_module player_module;
+extern struct init_module pathfind_module;
 extern struct init_module store_module;
 extern struct init_module messages_module;
 extern struct init_module options_module;
@@ -4492,6 +4502,7 @@ static struct init_module *modules[] = {
 	&ui_visuals_module, /* This needs to load before monsters and objects. */
 	&arrays_module,
 	&player_module,
+	&pathfind_module,
 	&generate_module,
 	&rune_module,
 	&obj_make_module,
@@ -63,6 +63,7 @@ struct angband_constants
 	uint8_t slay_max;	/**< Maximum number of slays */
 	uint8_t brand_max;	/**< Maximum number of brands */
 	uint16_t mon_blows_max;	/**< Maximum number of monster blows */
+	uint16_t mon_light_max;	/**< Largest radius of monster light */
 	uint16_t blow_methods_max;	/**< Maximum number of monster blow methods */
 	uint16_t blow_effects_max;	/**< Maximum number of monster blow effects */
 	uint16_t equip_slots_max;	/**< Maximum number of player equipment slots */
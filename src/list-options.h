@@ -55,6 +55,10 @@ OP(notify_recharge,       "Notify on object recharge",
 INTERFACE, false)
 OP(effective_speed,       "Show effective speed as multiplier",
 INTERFACE, false)
+OP(pregenerate_levels,    "Prepare the next level while on stairs",
+INTERFACE, false)
+OP(compress_savefile,     "Compress the savefile",
+INTERFACE, true)
 OP(cheat_hear,            "Cheat: Peek into monster creation",
 CHEAT, false)
 OP(score_hear,            "Score: Peek into monster creation",
@@ -32,3 +32,4 @@ SQUARE(PROJECT,		"marked for projection processing")
 SQUARE(DTRAP,		"trap detected square")
 SQUARE(NO_STAIRS,	"square is not suitable for placing stairs")
 SQUARE(CLOSE_PLAYER,	"square is seen and in player's light radius or UNLIGHT detection radius")
+SQUARE(WASVIEW,		"previously in view (during update)")
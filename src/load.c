@@ -389,15 +389,16 @@ int rd_randomizer(void)
 {
 	int i;
 	uint32_t noop;
+	struct rng_state *rs = rng_default();
 
 	/* current value for the simple RNG */
-	rd_u32b(&Rand_value);
+	rd_u32b(&rs->value);
 
 	/* state index */
-	rd_u32b(&state_i);
+	rd_u32b(&rs->index);
 
-	/* for safety, make sure state_i < RAND_DEG */
-	state_i = state_i % RAND_DEG;
+	/* for safety, make sure the index < RAND_DEG */
+	rs->index = rs->index % RAND_DEG;
     
 	/* NULL padding for compatibility with previous versions */
 	rd_u32b(&noop);
@@ -406,13 +407,13 @@ int rd_randomizer(void)
     
 	/* RNG state */
 	for (i = 0; i < RAND_DEG; i++)
-		rd_u32b(&STATE[i]);
+		rd_u32b(&rs->table[i]);
 
 	/* NULL padding */
 	for (i = 0; i < 59 - RAND_DEG; i++)
 		rd_u32b(&noop);
 
-	Rand_quick = false;
+	rs->quick = false;
 
 	return 0;
 }
@@ -1287,11 +1288,12 @@ int rd_stores(void) { return rd_stores_aux(rd_item); }
 static int rd_dungeon_aux(struct chunk **c)
 {
 	struct chunk *c1;
-	int i, n, y, x;
+	int n, y, x;
+	size_t grids;
 
 	uint16_t height, width;
 
-	uint8_t count;
+	uint8_t *plane;
 	uint8_t tmp8u;
 	uint16_t tmp16u;
 	char name[100];
@@ -1307,54 +1309,30 @@ static int rd_dungeon_aux(struct chunk **c)
 	/* We need a cave struct */
 	c1 = cave_new(height, width);
 	c1->name = string_make(name);
-
-    /* Run length decoding of cave->squares[y][x].info */
+	grids = (size_t)height * width;
+
+	/*
+	 * Run length decoding of cave->squares[y][x].info; the info for all
+	 * the squares is one block, in grid order.  Flag bytes beyond the ones
+	 * this version knows about are read and dropped.
+	 */
+	plane = mem_alloc(MAX(grids, 1));
 	for (n = 0; n < square_size; n++) {
-		/* Load the dungeon data */
-		for (x = y = 0; y < c1->height; ) {
-			/* Grab RLE info */
-			rd_byte(&count);
-			rd_byte(&tmp8u);
-
-			/* Apply the RLE info */
-			for (i = count; i > 0; i--) {
-				/* Extract "info" */
-				c1->squares[y][x].info[n] = tmp8u;
-
-				/* Advance/Wrap */
-				if (++x >= c1->width) {
-					/* Wrap */
-					x = 0;
-
-					/* Advance/Wrap */
-					if (++y >= c1->height) break;
-				}
-			}
+		if (grids && n < (int)SQUARE_SIZE) {
+			rd_rle(c1->squares[0][0].info + n, grids, SQUARE_SIZE);
+		} else {
+			rd_rle(plane, grids, 1);
 		}
 	}
 
 	/* Run length decoding of dungeon data */
-	for (x = y = 0; y < c1->height; ) {
-		/* Grab RLE info */
-		rd_byte(&count);
-		rd_byte(&tmp8u);
-
-		/* Apply the RLE info */
-		for (i = count; i > 0; i--) {
-			/* Extract "feat" */
-			square_set_feat(c1, loc(x, y), tmp8u);
-
-			/* Advance/Wrap */
-			if (++x >= c1->width) {
-				/* Wrap */
-				x = 0;
-
-				/* Advance/Wrap */
-				if (++y >= c1->height) break;
-			}
+	rd_rle(plane, grids, 1);
+	for (y = 0; y < c1->height; y++) {
+		for (x = 0; x < c1->width; x++) {
+			square_set_feat(c1, loc(x, y), plane[y * c1->width + x]);
 		}
 	}
-
+	mem_free(plane);
 
 	/* Read "feeling" */
 	rd_byte(&tmp8u);
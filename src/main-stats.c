@@ -44,6 +44,10 @@
 #include "store.h"
 #include <stddef.h>
 #include <time.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #define OBJ_FEEL_MAX	 11
 #define MON_FEEL_MAX 	 10
@@ -70,9 +74,10 @@
  * they can be looped over and written to the database.
  */
 struct structure_introspection {
-	int (*inserter)(const struct structure_introspection*);
+	int (*inserter)(const struct structure_introspection*,
+			struct stats_db_writer*);
 				/**< inserts the values in the array into the
-					database */
+					database with the given bulk writer */
 	int (*n0_extractor)(void);
 				/**< returns the number of elements in the
 					fastest varying dimension; may be NULL
@@ -104,6 +109,8 @@ struct structure_introspection {
 	const char *tbl_cmd;	/**< string to pass to stats_db_exec() to
 					create the related table in the
 					database */
+	const char *columns;	/**< the table's columns, separated by
+					commas, for the bulk writer */
 	size_t offset;		/**< offset from the start of the structure for
 					the member */
 	int n0;			/**< number of elements in the fastest varying
@@ -115,17 +122,23 @@ struct structure_introspection {
 };
 
 static int stats_write_db_wearables_array(
-		const struct structure_introspection* member_desc);
+		const struct structure_introspection* member_desc,
+		struct stats_db_writer *writer);
 static int stats_write_db_wearables_2d_array(
-		const struct structure_introspection* member_desc);
+		const struct structure_introspection* member_desc,
+		struct stats_db_writer *writer);
 static int stats_write_db_level_data(
-		const struct structure_introspection* member_desc);
+		const struct structure_introspection* member_desc,
+		struct stats_db_writer *writer);
 static int stats_write_db_level_data_items(
-		const struct structure_introspection* member_desc);
+		const struct structure_introspection* member_desc,
+		struct stats_db_writer *writer);
+static bool stats_create_writers(void);
 static int get_artifact_count(void);
 static int get_consumables_count(void);
 static int get_ego_count(void);
 static int get_monster_race_count(void);
+static int get_profile_count(void);
 static uint32_t extract_arr_long_long(const uint8_t *p, int i0, int n0, int i1);
 static uint32_t extract_arr_uint32(const uint8_t *p, int i0, int n0, int i1);
 static uint32_t extract_arr_arr_uint32(const uint8_t *p, int i0, int n0,
@@ -140,6 +153,9 @@ static const char *chosen_race = NULL;
 static int randarts = 0;
 static int no_selling = 0;
 static uint32_t num_runs = 1;
+static int num_workers = 1;
+static uint32_t stats_seed = 0;
+static bool stats_seed_set = false;
 static bool quiet = false;
 static int nextkey = 0;
 static int running_stats = 0;
@@ -147,8 +163,11 @@ static char *ANGBAND_DIR_STATS;
 
 static int *consumables_index;
 static int *wearables_index;
+static int *consumables_kidx;
+static int *wearables_kidx;
 static int wearable_count = 0;
 static int consumable_count = 0;
+static int db_flags = 0;
 
 struct wearables_data {
 	uint32_t count;
@@ -175,6 +194,7 @@ static struct structure_introspection wearables_introspection[] = {
 		NULL,
 		"dice",
 		"CREATE TABLE wearables_dice(level INT, count INT, k_idx INT, origin INT, dd INT, ds INT, UNIQUE (level, k_idx, origin, dd, ds) ON CONFLICT REPLACE);",
+		"level,count,k_idx,origin,dd,ds",
 		offsetof(struct wearables_data, dice),
 		TOP_SIDES,
 		TOP_DICE
@@ -187,6 +207,7 @@ static struct structure_introspection wearables_introspection[] = {
 		NULL,
 		"ac",
 		"CREATE TABLE wearables_ac(level INT, count INT, k_idx INT, origin INT, ac INT, UNIQUE (level, k_idx, origin, ac) ON CONFLICT REPLACE);",
+		"level,count,k_idx,origin,ac",
 		offsetof(struct wearables_data, ac),
 		TOP_AC,
 		1
@@ -199,6 +220,7 @@ static struct structure_introspection wearables_introspection[] = {
 		NULL,
 		"hit",
 		"CREATE TABLE wearables_hit(level INT, count INT, k_idx INT, origin INT, to_h INT, UNIQUE (level, k_idx, origin, to_h) ON CONFLICT REPLACE);",
+		"level,count,k_idx,origin,to_h",
 		offsetof(struct wearables_data, hit),
 		TOP_PLUS,
 		1
@@ -211,6 +233,7 @@ static struct structure_introspection wearables_introspection[] = {
 		NULL,
 		"dam",
 		"CREATE TABLE wearables_dam(level INT, count INT, k_idx INT, origin INT, to_d INT, UNIQUE (level, k_idx, origin, to_d) ON CONFLICT REPLACE);",
+		"level,count,k_idx,origin,to_d",
 		offsetof(struct wearables_data, dam),
 		TOP_PLUS,
 		1
@@ -223,6 +246,7 @@ static struct structure_introspection wearables_introspection[] = {
 		NULL,
 		"egos",
 		"CREATE TABLE wearables_egos(level INT, count INT, k_idx INT, origin INT, e_idx INT, UNIQUE (level, k_idx, origin, e_idx) ON CONFLICT REPLACE);",
+		"level,count,k_idx,origin,e_idx",
 		offsetof(struct wearables_data, egos),
 		0,
 		1
@@ -235,6 +259,7 @@ static struct structure_introspection wearables_introspection[] = {
 		NULL,
 		"flags",
 		"CREATE TABLE wearables_flags(level INT, count INT, k_idx INT, origin INT, of_idx INT, UNIQUE (level, k_idx, origin, of_idx) ON CONFLICT REPLACE);",
+		"level,count,k_idx,origin,of_idx",
 		offsetof(struct wearables_data, flags),
 		OF_MAX,
 		1
@@ -247,6 +272,7 @@ static struct structure_introspection wearables_introspection[] = {
 		NULL,
 		"mods",
 		"CREATE TABLE wearables_mods(level INT, count INT, k_idx INT, origin INT, mod INT, mod_idx INT, UNIQUE (level, k_idx, origin, mod, mod_idx) ON CONFLICT REPLACE);",
+		"level,count,k_idx,origin,mod,mod_idx",
 		offsetof(struct wearables_data, modifiers),
 		OBJ_MOD_MAX + 1,
 		TOP_MOD
@@ -263,8 +289,16 @@ static struct level_data {
 	uint32_t *artifacts[ORIGIN_STATS];
 	uint32_t *consumables[ORIGIN_STATS];
 	struct wearables_data *wearables[ORIGIN_STATS];
+	uint32_t *gen_tries;
+	uint32_t gen_restarts[GEN_PHASE_MAX];
+	long long gen_usec[GEN_PHASE_MAX];
 } level_data[LEVEL_MAX];
 
+/**
+ * The last phase of building the current level that finished, or -1
+ */
+static int gen_last_phase = -1;
+
 /*
  * The elements here must match up with the array or pointer members of
  * struct level_data that will be written to the database.  The wearables
@@ -279,6 +313,7 @@ static struct structure_introspection level_introspection[] = {
 		NULL,
 		"monsters",
 		"CREATE TABLE monsters(level INT, count INT, k_idx INT, UNIQUE (level, k_idx) ON CONFLICT REPLACE);",
+		"level,count,k_idx",
 		offsetof(struct level_data, monsters),
 		0,
 		1
@@ -291,6 +326,7 @@ static struct structure_introspection level_introspection[] = {
 		NULL,
 		"obj_feelings",
 		"CREATE TABLE obj_feelings(level INT, count INT, feeling INT, UNIQUE (level, feeling) ON CONFLICT REPLACE);",
+		"level,count,feeling",
 		offsetof(struct level_data, obj_feelings),
 		OBJ_FEEL_MAX,
 		1
@@ -303,6 +339,7 @@ static struct structure_introspection level_introspection[] = {
 		NULL,
 		"mon_feelings",
 		"CREATE TABLE mon_feelings(level INT, count INT, feeling INT, UNIQUE (level, feeling) ON CONFLICT REPLACE);",
+		"level,count,feeling",
 		offsetof(struct level_data, mon_feelings),
 		MON_FEEL_MAX,
 		1
@@ -315,6 +352,7 @@ static struct structure_introspection level_introspection[] = {
 		NULL,
 		"gold",
 		"CREATE TABLE gold(level INT, count INT, origin INT, UNIQUE (level, origin) ON CONFLICT REPLACE);",
+		"level,count,origin",
 		offsetof(struct level_data, gold),
 		ORIGIN_STATS,
 		1
@@ -327,6 +365,7 @@ static struct structure_introspection level_introspection[] = {
 		NULL,
 		"artifacts",
 		"CREATE TABLE artifacts(level INT, count INT, a_idx INT, origin INT, UNIQUE (level, a_idx, origin) ON CONFLICT REPLACE);",
+		"level,count,a_idx,origin",
 		offsetof(struct level_data, artifacts),
 		0,
 		ORIGIN_STATS
@@ -339,12 +378,70 @@ static struct structure_introspection level_introspection[] = {
 		convert_to_consumables_index,
 		"consumables",
 		"CREATE TABLE consumables(level INT, count INT, k_idx INT, origin INT, UNIQUE (level, k_idx, origin) ON CONFLICT REPLACE);",
+		"level,count,k_idx,origin",
 		offsetof(struct level_data, consumables),
 		0,
 		ORIGIN_STATS
 	},
+	{
+		stats_write_db_level_data,
+		get_profile_count,
+		NULL,
+		extract_ptr_uint32,
+		NULL,
+		"gen_tries",
+		"CREATE TABLE gen_tries(level INT, count INT, profile INT, UNIQUE (level, profile) ON CONFLICT REPLACE);",
+		"level,count,profile",
+		offsetof(struct level_data, gen_tries),
+		0,
+		1
+	},
+	{
+		stats_write_db_level_data,
+		NULL,
+		NULL,
+		extract_arr_uint32,
+		NULL,
+		"gen_restarts",
+		"CREATE TABLE gen_restarts(level INT, count INT, phase INT, UNIQUE (level, phase) ON CONFLICT REPLACE);",
+		"level,count,phase",
+		offsetof(struct level_data, gen_restarts),
+		GEN_PHASE_MAX,
+		1
+	},
+	{
+		stats_write_db_level_data,
+		NULL,
+		NULL,
+		extract_arr_long_long,
+		NULL,
+		"gen_time",
+		"CREATE TABLE gen_time(level INT, count INT, phase INT, UNIQUE (level, phase) ON CONFLICT REPLACE);",
+		"level,count,phase",
+		offsetof(struct level_data, gen_usec),
+		GEN_PHASE_MAX,
+		1
+	},
 };
 
+/**
+ * Invert index, which maps kinds to indices in [0, count], so that
+ * kidx[value] is the first kind with that index, or -value if there is none.
+ */
+static int *invert_index(const int *index, int count)
+{
+	int *kidx = mem_alloc((count + 1) * sizeof(int));
+	int i;
+
+	for (i = 0; i <= count; i++) {
+		kidx[i] = -i;
+	}
+	for (i = z_info->k_max - 1; i >= 0; i--) {
+		kidx[index[i]] = i;
+	}
+	return kidx;
+}
+
 static void create_indices(void)
 {
 	int i;
@@ -366,6 +463,9 @@ static void create_indices(void)
 		else
 			consumables_index[i] = ++consumable_count;
 	}
+
+	wearables_kidx = invert_index(wearables_index, wearable_count);
+	consumables_kidx = invert_index(consumables_index, consumable_count);
 }
 
 static void alloc_memory(void)
@@ -374,6 +474,8 @@ static void alloc_memory(void)
 
 	for (i = 0; i < LEVEL_MAX; i++) {
 		level_data[i].monsters = mem_zalloc(z_info->r_max * sizeof(uint32_t));
+		level_data[i].gen_tries = mem_zalloc(z_info->profile_max *
+			sizeof(uint32_t));
 /*		level_data[i].vaults = mem_zalloc(z_info->v_max * sizeof(uint32_t));
 		level_data[i].pits = mem_zalloc(z_info->pit_max * sizeof(uint32_t)); */
 
@@ -402,6 +504,7 @@ static void free_stats_memory(void)
 	int i, j, k, l;
 	for (i = 0; i < LEVEL_MAX; i++) {
 		mem_free(level_data[i].monsters);
+		mem_free(level_data[i].gen_tries);
 /*		mem_free(level_data[i].vaults);
  		mem_free(level_data[i].pits); */
 		for (j = 0; j < ORIGIN_STATS; j++) {
@@ -418,6 +521,8 @@ static void free_stats_memory(void)
 	}
 	mem_free(consumables_index);
 	mem_free(wearables_index);
+	mem_free(consumables_kidx);
+	mem_free(wearables_kidx);
 	string_free(ANGBAND_DIR_STATS);
 }
 
@@ -500,18 +605,20 @@ static void generate_player_for_stats(void)
 	player->history = get_history(player->race->history);
 }
 
-static void initialize_character(void)
+/**
+ * Set up the character for a run.  Each run reseeds the random numbers from
+ * the base seed and the run's number, rather than the time, so that runs made
+ * at the same moment by different workers differ and a given seed can be
+ * repeated.
+ */
+static void initialize_character(uint32_t run)
 {
-	uint32_t seed;
-
 	if (!quiet) {
 		printf(" [I  ]\b\b\b\b\b\b");
 		fflush(stdout);
 	}
 
-	seed = (time(NULL));
-	Rand_quick = false;
-	Rand_state_init(seed);
+	rng_state_init(rng_default(), stats_seed + run);
 
 	player_init(player);
 	generate_player_for_stats();
@@ -662,6 +769,39 @@ static void log_all_objects(int level)
 	}
 }
 
+/**
+ * Count the attempts at building each level, and time the phases of
+ * building it.  Generation happens at the player's new depth.
+ */
+static void gen_level_start(game_event_type type, game_event_data *data,
+		void *user)
+{
+	int profile = get_level_profile_index_from_name(data->string);
+
+	gen_last_phase = -1;
+	if (profile < 0 || player->depth < 1 || player->depth >= LEVEL_MAX)
+		return;
+	level_data[player->depth].gen_tries[profile]++;
+}
+
+static void gen_level_restart(game_event_type type, game_event_data *data,
+		void *user)
+{
+	if (gen_last_phase < 0 || player->depth < 1 ||
+			player->depth >= LEVEL_MAX)
+		return;
+	level_data[player->depth].gen_restarts[gen_last_phase]++;
+}
+
+static void gen_phase_end(game_event_type type, game_event_data *data,
+		void *user)
+{
+	gen_last_phase = data->phase.phase;
+	if (player->depth < 1 || player->depth >= LEVEL_MAX) return;
+	level_data[player->depth].gen_usec[data->phase.phase] +=
+		data->phase.usec;
+}
+
 static void descend_dungeon(void)
 {
 	int level;
@@ -1164,6 +1304,40 @@ static int stats_dump_lists(void)
 
 	STATS_DB_FINALIZE(sql_stmt)
 
+	err = stats_db_stmt_prep(&sql_stmt,
+		"INSERT INTO level_profile_list VALUES(?,?);");
+	if (err) return err;
+
+	for (idx = 0; idx < z_info->profile_max; idx++) {
+		const char *name = get_level_profile_name_from_index(idx);
+
+		err = sqlite3_bind_int(sql_stmt, 1, idx);
+		if (err) return err;
+		err = sqlite3_bind_text(sql_stmt, 2, name, strlen(name),
+			SQLITE_STATIC);
+		if (err) return err;
+		STATS_DB_STEP_RESET(sql_stmt)
+	}
+
+	STATS_DB_FINALIZE(sql_stmt)
+
+	err = stats_db_stmt_prep(&sql_stmt,
+		"INSERT INTO gen_phase_list VALUES(?,?);");
+	if (err) return err;
+
+	for (idx = 0; idx < GEN_PHASE_MAX; idx++) {
+		const char *name = gen_phase_name(idx);
+
+		err = sqlite3_bind_int(sql_stmt, 1, idx);
+		if (err) return err;
+		err = sqlite3_bind_text(sql_stmt, 2, name, strlen(name),
+			SQLITE_STATIC);
+		if (err) return err;
+		STATS_DB_STEP_RESET(sql_stmt)
+	}
+
+	STATS_DB_FINALIZE(sql_stmt)
+
 	return SQLITE_OK;
 }
 
@@ -1240,6 +1414,8 @@ static int stats_dump_info(void)
  *     object_flags_list -- dump of list-object-flags.h
  *     object_mods_list -- dump of list-object-modifiers.h
  *     origin_flags_list -- dump of origin enum
+ *     level_profile_list -- dump of the level profiles
+ *     gen_phase_list -- dump of the phases of level generation
  * Count tables:
  *     monsters
  *     obj_feelings
@@ -1247,6 +1423,9 @@ static int stats_dump_info(void)
  *     gold
  *     artifacts
  *     consumables
+ *     gen_tries -- attempts at building each level profile
+ *     gen_restarts -- abandoned attempts by the last phase they finished
+ *     gen_time -- microseconds spent in each phase of level generation
  *     wearables_count
  *     wearables_dice
  *     wearables_ac
@@ -1262,7 +1441,7 @@ static bool stats_prep_db(void)
 	int err, i;
 
 	/* Open the database connection */
-	status = stats_db_open();
+	status = stats_db_open(db_flags);
 	if (!status) return status;
 
 	/* Create some tables */
@@ -1335,6 +1514,12 @@ static bool stats_prep_db(void)
 	err = stats_db_exec("CREATE TABLE origin_flags_list(idx INT PRIMARY KEY, name TEXT);");
 	if (err) return false;
 
+	err = stats_db_exec("CREATE TABLE level_profile_list(idx INT PRIMARY KEY, name TEXT);");
+	if (err) return false;
+
+	err = stats_db_exec("CREATE TABLE gen_phase_list(idx INT PRIMARY KEY, name TEXT);");
+	if (err) return false;
+
 	for (i = 0; i < (int)N_ELEMENTS(level_introspection); ++i) {
 		err = stats_db_exec(level_introspection[i].tbl_cmd);
 		if (err) return false;
@@ -1348,28 +1533,14 @@ static bool stats_prep_db(void)
 		if (err) return false;
 	}
 
+	if (!stats_create_writers()) return false;
+
 	err = stats_dump_info();
 	if (err) return false;
 
 	return true;
 }
 
-/**
- * Given a pointer to a dynamically allocated array and a value, look up
- * the index with that value; e.g. given wearables_index[k_idx], return k_idx.
- * If not found, return -1 * value.
- */
-static int stats_lookup_index(const int *index, int max_idx, int value)
-{
-	int idx;
-
-	for (idx = 0; idx < max_idx; idx ++) {
-		if (index[idx] == value) return idx;
-	}
-
-	return -1 * value;
-}
-
 static int get_artifact_count(void)
 {
 	return z_info->a_max;
@@ -1390,6 +1561,11 @@ static int get_monster_race_count(void)
 	return z_info->r_max;
 }
 
+static int get_profile_count(void)
+{
+	return z_info->profile_max;
+}
+
 /**
  * Intended for use as struct structure_introspection's value_extractor
  * member when the structure member it is describing is declared as
@@ -1451,23 +1627,17 @@ static uint32_t extract_ptr_uint32(const uint8_t *p, int i0, int n0, int i1)
 
 static int convert_to_consumables_index(int i0)
 {
-	return stats_lookup_index(consumables_index, z_info->k_max, i0);
+	return consumables_kidx[i0];
 }
 
 static int stats_write_db_level_data(
-		const struct structure_introspection* member_desc)
+		const struct structure_introspection* member_desc,
+		struct stats_db_writer *writer)
 {
-	char sql_buf[256];
-	sqlite3_stmt *sql_stmt;
 	int n = (member_desc->n0_extractor)
 		? (*member_desc->n0_extractor)() : member_desc->n0;
 	int err, level, i;
 
-	strnfmt(sql_buf, 256, "INSERT INTO %s VALUES(?,?,?);",
-		member_desc->name);
-	err = stats_db_stmt_prep(&sql_stmt, sql_buf);
-	if (err) return err;
-
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (i = 0; i < n; i++) {
 			uint32_t count = (*member_desc->value_extractor)(
@@ -1476,32 +1646,23 @@ static int stats_write_db_level_data(
 
 			if (!count) continue;
 
-			err = stats_db_bind_ints(sql_stmt, 3, 0,
-				level, count, i);
+			err = stats_db_writer_add(writer, level, count, i);
 			if (err) return err;
-
-			STATS_DB_STEP_RESET(sql_stmt)
 		}
 
-	return sqlite3_finalize(sql_stmt);
+	return SQLITE_OK;
 }
 
 static int stats_write_db_level_data_items(
-		const struct structure_introspection* member_desc)
+		const struct structure_introspection* member_desc,
+		struct stats_db_writer *writer)
 {
-	char sql_buf[256];
-	sqlite3_stmt *sql_stmt;
 	int nj = (member_desc->n1_extractor) ?
 		(*member_desc->n1_extractor)() : member_desc->n1;
 	int ni = (member_desc->n0_extractor) ?
 		(*member_desc->n0_extractor)() : member_desc->n0;
 	int err, level, j, i;
 
-	strnfmt(sql_buf, 256, "INSERT INTO %s VALUES(?,?,?,?);",
-		member_desc->name);
-	err = stats_db_stmt_prep(&sql_stmt, sql_buf);
-	if (err) return err;
-
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (j = 0; j < nj; j++)
 			for (i = 0; i < ni; i++) {
@@ -1512,27 +1673,20 @@ static int stats_write_db_level_data_items(
 
 				if (!count) continue;
 
-				err = stats_db_bind_ints(sql_stmt, 4, 0, level,
-					count, (member_desc->index_converter)
+				err = stats_db_writer_add(writer, level, count,
+					(member_desc->index_converter)
 					? (*member_desc->index_converter)(i) : i,
 					j);
 				if (err) return err;
-
-				STATS_DB_STEP_RESET(sql_stmt)
 			}
 
-	return sqlite3_finalize(sql_stmt);
+	return SQLITE_OK;
 }
 
-static int stats_write_db_wearables_count(void)
+static int stats_write_db_wearables_count(struct stats_db_writer *writer)
 {
-	sqlite3_stmt *sql_stmt;
 	int err, level, origin, k_idx, idx;
 
-	err = stats_db_stmt_prep(&sql_stmt, 
-		"INSERT INTO wearables_count VALUES(?,?,?,?);");
-	if (err) return err;
-
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (origin = 0; origin < ORIGIN_STATS; origin++)
 			for (idx = 0; idx < wearable_count + 1; idx++) {
@@ -1540,41 +1694,37 @@ static int stats_write_db_wearables_count(void)
 				/* Skip if object did not appear */
 				if (!count) continue;
 
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
 
-				err = stats_db_bind_ints(sql_stmt, 4, 0,
-					level, count, k_idx, origin);
+				err = stats_db_writer_add(writer, level, count,
+					k_idx, origin);
 				if (err) return err;
-
-				STATS_DB_STEP_RESET(sql_stmt)
 			}
 
-	return sqlite3_finalize(sql_stmt);
+	return SQLITE_OK;
 }
 
 static int stats_write_db_wearables_array(
-		const struct structure_introspection* member_desc)
+		const struct structure_introspection* member_desc,
+		struct stats_db_writer *writer)
 {
-	char sql_buf[256];
-	sqlite3_stmt *sql_stmt;
 	int n = (member_desc->n0_extractor)
 		? (*member_desc->n0_extractor)() : member_desc->n0;
 	int err, level, origin, idx, k_idx, i;
 
-	strnfmt(sql_buf, 256, "INSERT INTO wearables_%s VALUES(?,?,?,?,?);",
-		member_desc->name);
-	err = stats_db_stmt_prep(&sql_stmt, sql_buf);
-	if (err) return err;
-
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (origin = 0; origin < ORIGIN_STATS; origin++)
 			for (idx = 0; idx < wearable_count + 1; idx++) {
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				const struct wearables_data *w =
+					&level_data[level].wearables[origin][idx];
+
+				/* Skip if object did not appear */
+				if (!w->count) continue;
+
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
@@ -1582,43 +1732,40 @@ static int stats_write_db_wearables_array(
 				for (i = 0; i < n; i++) {
 					uint32_t count =
 						(*member_desc->value_extractor)(
-						(const uint8_t*)&level_data[level].wearables[origin][idx]
+						(const uint8_t*)w
 						+ member_desc->offset, i, n, 0);
 
 					if (!count) continue;
 
-					err = stats_db_bind_ints(sql_stmt, 5, 0,
-						level, count, k_idx, origin, i);
+					err = stats_db_writer_add(writer, level,
+						count, k_idx, origin, i);
 					if (err) return err;
-
-					STATS_DB_STEP_RESET(sql_stmt)
 				}
 			}
 
-	return sqlite3_finalize(sql_stmt);
+	return SQLITE_OK;
 }
 
 static int stats_write_db_wearables_2d_array(
-		const struct structure_introspection* member_desc)
+		const struct structure_introspection* member_desc,
+		struct stats_db_writer *writer)
 {
-	char sql_buf[256];
-	sqlite3_stmt *sql_stmt;
 	int nj = (member_desc->n1_extractor) ?
 		(*member_desc->n1_extractor)() : member_desc->n1;
 	int ni = (member_desc->n0_extractor) ?
 		(*member_desc->n0_extractor)() : member_desc->n0;
 	int err, level, origin, idx, k_idx, i, j;
 
-	strnfmt(sql_buf, 256, "INSERT INTO wearables_%s VALUES(?,?,?,?,?,?);",
-		member_desc->name);
-	err = stats_db_stmt_prep(&sql_stmt, sql_buf);
-	if (err) return err;
-
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (origin = 0; origin < ORIGIN_STATS; origin++)
 			for (idx = 0; idx < wearable_count + 1; idx++) {
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				const struct wearables_data *w =
+					&level_data[level].wearables[origin][idx];
+
+				/* Skip if object did not appear */
+				if (!w->count) continue;
+
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
@@ -1630,22 +1777,92 @@ static int stats_write_db_wearables_2d_array(
 						if (i == 0 && j == 0) continue;
 
 						count = (*member_desc->value_extractor)(
-							(const uint8_t*)&level_data[level].wearables[origin][idx]
+							(const uint8_t*)w
 							+ member_desc->offset,
 							i, ni, j);
 
 						if (!count) continue;
 
-						err = stats_db_bind_ints(sql_stmt, 6, 0,
-							level, count, k_idx, origin, 
-							j, i);
+						err = stats_db_writer_add(writer,
+							level, count, k_idx,
+							origin, j, i);
 						if (err) return err;
-
-						STATS_DB_STEP_RESET(sql_stmt)
 					}
 			}
 
-	return sqlite3_finalize(sql_stmt);
+	return SQLITE_OK;
+}
+
+/**
+ * Bulk writers for the count tables, in the same order as the entries of
+ * level_introspection and wearables_introspection; they are created with the
+ * tables and reused for every checkpoint.
+ */
+static struct stats_db_writer *level_writers[N_ELEMENTS(level_introspection)];
+static struct stats_db_writer *wearables_count_writer;
+static struct stats_db_writer *wearables_writers[
+	N_ELEMENTS(wearables_introspection)];
+
+static bool stats_create_writers(void)
+{
+	char name[80];
+	int i;
+
+	for (i = 0; i < (int)N_ELEMENTS(level_introspection); ++i) {
+		level_writers[i] = stats_db_writer_new(
+			level_introspection[i].name,
+			level_introspection[i].columns);
+		if (!level_writers[i]) return false;
+	}
+
+	wearables_count_writer = stats_db_writer_new("wearables_count",
+		"level,count,k_idx,origin");
+	if (!wearables_count_writer) return false;
+
+	for (i = 0; i < (int)N_ELEMENTS(wearables_introspection); ++i) {
+		strnfmt(name, sizeof(name), "wearables_%s",
+			wearables_introspection[i].name);
+		wearables_writers[i] = stats_db_writer_new(name,
+			wearables_introspection[i].columns);
+		if (!wearables_writers[i]) return false;
+	}
+
+	return true;
+}
+
+/**
+ * Free the bulk writers and close the database.
+ */
+static void stats_close_db(void)
+{
+	int i;
+
+	for (i = 0; i < (int)N_ELEMENTS(level_introspection); ++i) {
+		stats_db_writer_free(level_writers[i]);
+		level_writers[i] = NULL;
+	}
+	stats_db_writer_free(wearables_count_writer);
+	wearables_count_writer = NULL;
+	for (i = 0; i < (int)N_ELEMENTS(wearables_introspection); ++i) {
+		stats_db_writer_free(wearables_writers[i]);
+		wearables_writers[i] = NULL;
+	}
+	stats_db_close();
+}
+
+/**
+ * Replace the contents of one count table with the current counts.
+ */
+static int stats_write_db_table(struct stats_db_writer *writer,
+		const struct structure_introspection* member_desc)
+{
+	int err = stats_db_writer_begin(writer);
+
+	if (err) return err;
+	err = (member_desc) ? (*member_desc->inserter)(member_desc, writer)
+		: stats_write_db_wearables_count(writer);
+	if (err) return err;
+	return stats_db_writer_end(writer);
 }
 
 static int stats_write_db(uint32_t run)
@@ -1663,16 +1880,16 @@ static int stats_write_db(uint32_t run)
 	if (err) return err;
 
 	for (i = 0; i < (int)N_ELEMENTS(level_introspection); ++i) {
-		err = (*level_introspection[i].inserter)(
+		err = stats_write_db_table(level_writers[i],
 			&level_introspection[i]);
 		if (err) return err;
 	}
 
-	err = stats_write_db_wearables_count();
+	err = stats_write_db_table(wearables_count_writer, NULL);
 	if (err) return err;
 
 	for (i = 0; i < (int)N_ELEMENTS(wearables_introspection); ++i) {
-		err = (*wearables_introspection[i].inserter)(
+		err = stats_write_db_table(wearables_writers[i],
 			&wearables_introspection[i]);
 		if (err) return err;
 	}
@@ -1697,7 +1914,7 @@ static void progress_bar(uint32_t run, time_t start) {
 
 	time_t delta = time(NULL) - start;
 	uint32_t togo = num_runs - run;
-	uint32_t expect = delta ?
+	uint32_t expect = (delta && run) ?
 		((long long)delta * (long long)togo) / run : 0;
 
 	int h = expect / 3600;
@@ -1736,6 +1953,400 @@ static void stats_cleanup_angband_run(void)
 	player->history = NULL;
 }
 
+/**
+ * Perform one descent, adding its results to level_data.
+ */
+static void stats_do_run(uint32_t run, const struct artifact *a_info_save,
+		const struct artifact_upkeep *aup_info_save)
+{
+	unsigned int i;
+
+	if (randarts) {
+		for (i = 0; i < z_info->a_max; i++) {
+			memcpy(&a_info[i], &a_info_save[i],
+				sizeof(struct artifact));
+			memcpy(&aup_info[i], &aup_info_save[i],
+				sizeof(struct artifact_upkeep));
+		}
+	}
+
+	initialize_character(run);
+	unkill_uniques();
+	reset_artifacts();
+	descend_dungeon();
+	stats_cleanup_angband_run();
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Parallel runs
+ *
+ * With more than one worker, each worker is a forked copy of this process,
+ * so it has its own game state, chunks and random number stream.  A worker
+ * adds its results to its own copy of level_data.  After its share of each
+ * checkpoint's runs, it sends every nonzero count down a pipe, as a record
+ * giving the count's position in the order used by visit_level_data().  It
+ * then zeroes the counts it sent, so the next batch only carries new counts.
+ * The parent adds the batches from all the workers, in worker order, to its
+ * own level_data and writes the checkpoint.  Runs are dealt to workers in
+ * turn, so for a given seed and number of workers the results do not
+ * depend on scheduling.
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Marks the end of a worker's batch in place of a position
+ */
+#define STATS_BATCH_END	0xFFFFFFFFFFFFFFFFULL
+
+/**
+ * One count sent from a worker to the parent
+ */
+struct stats_record {
+	uint64_t pos;
+	uint64_t value;
+};
+
+/**
+ * Buffered reader for a worker's pipe; stdio is not used so that the parent
+ * can poll() the pipe without data hiding in a FILE buffer.
+ */
+struct stats_reader {
+	int fd;
+	size_t len;
+	size_t off;
+	uint8_t buf[65536];
+};
+
+/**
+ * State shared between the visitors and the functions that use them
+ */
+struct stats_visit {
+	uint64_t pos;
+	FILE *out;
+	struct stats_reader *in;
+	struct stats_record rec;
+	bool done;
+	bool failed;
+};
+
+typedef void (*level_data_visitor)(struct stats_visit *v, void *block,
+	size_t n, bool wide);
+
+/**
+ * Call func on every block of counts in level_data, always in the same
+ * order.  wide is true for blocks of long long rather than uint32_t.
+ */
+static void visit_level_data(level_data_visitor func, struct stats_visit *v)
+{
+	int level, j, k, l;
+
+	for (level = 1; level < LEVEL_MAX; level++) {
+		struct level_data *ld = &level_data[level];
+
+		func(v, ld->monsters, z_info->r_max, false);
+		func(v, ld->obj_feelings, OBJ_FEEL_MAX, false);
+		func(v, ld->mon_feelings, MON_FEEL_MAX, false);
+		func(v, ld->gold, ORIGIN_STATS, true);
+		func(v, ld->gen_tries, z_info->profile_max, false);
+		func(v, ld->gen_restarts, GEN_PHASE_MAX, false);
+		func(v, ld->gen_usec, GEN_PHASE_MAX, true);
+		for (j = 0; j < ORIGIN_STATS; j++) {
+			func(v, ld->artifacts[j], z_info->a_max, false);
+			func(v, ld->consumables[j], consumable_count + 1, false);
+			for (k = 0; k < wearable_count + 1; k++) {
+				struct wearables_data *w = &ld->wearables[j][k];
+
+				func(v, &w->count, 1, false);
+				func(v, w->dice, TOP_DICE * TOP_SIDES, false);
+				func(v, w->ac, TOP_AC, false);
+				func(v, w->hit, TOP_PLUS, false);
+				func(v, w->dam, TOP_PLUS, false);
+				func(v, w->egos, z_info->e_max, false);
+				func(v, w->flags, OF_MAX, false);
+				for (l = 0; l < TOP_MOD; l++) {
+					func(v, w->modifiers[l], OBJ_MOD_MAX + 1,
+						false);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Visitor for a worker:  send the nonzero counts in a block and zero them.
+ */
+static void send_block(struct stats_visit *v, void *block, size_t n,
+		bool wide)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		struct stats_record rec;
+
+		if (wide) {
+			long long *p = (long long*)block + i;
+
+			if (!*p) continue;
+			rec.value = (uint64_t)*p;
+			*p = 0;
+		} else {
+			uint32_t *p = (uint32_t*)block + i;
+
+			if (!*p) continue;
+			rec.value = *p;
+			*p = 0;
+		}
+		rec.pos = v->pos + i;
+		if (fwrite(&rec, sizeof(rec), 1, v->out) != 1) {
+			v->failed = true;
+		}
+	}
+	v->pos += n;
+}
+
+/**
+ * Return whether the reader has buffered data or its pipe is readable,
+ * waiting at most timeout milliseconds.
+ */
+static bool stats_reader_ready(struct stats_reader *r, int timeout)
+{
+	struct pollfd pfd;
+
+	if (r->off < r->len) return true;
+	pfd.fd = r->fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	return poll(&pfd, 1, timeout) > 0;
+}
+
+/**
+ * Read one record from a worker; return false at the end of the pipe.
+ */
+static bool stats_reader_get(struct stats_reader *r, struct stats_record *rec)
+{
+	uint8_t *dest = (uint8_t*)rec;
+	size_t need = sizeof(*rec);
+
+	while (need) {
+		size_t avail = r->len - r->off;
+
+		if (!avail) {
+			ssize_t got = read(r->fd, r->buf, sizeof(r->buf));
+
+			if (got < 0 && errno == EINTR) continue;
+			if (got <= 0) return false;
+			r->len = got;
+			r->off = 0;
+			continue;
+		}
+		if (avail > need) avail = need;
+		memcpy(dest, r->buf + r->off, avail);
+		r->off += avail;
+		dest += avail;
+		need -= avail;
+	}
+	return true;
+}
+
+/**
+ * Read the next record for the parent's visitor.
+ */
+static void receive_next(struct stats_visit *v)
+{
+	if (!stats_reader_get(v->in, &v->rec)) {
+		v->failed = true;
+		v->done = true;
+	} else if (v->rec.pos == STATS_BATCH_END) {
+		v->done = true;
+	}
+}
+
+/**
+ * Visitor for the parent:  add the counts a worker sent for a block.
+ */
+static void receive_block(struct stats_visit *v, void *block, size_t n,
+		bool wide)
+{
+	while (!v->done && v->rec.pos < v->pos + n) {
+		size_t i = v->rec.pos - v->pos;
+
+		if (v->rec.pos < v->pos) {
+			/* Out of order; the stream is corrupt */
+			v->failed = true;
+			v->done = true;
+			break;
+		}
+		if (wide) {
+			((long long*)block)[i] += (long long)v->rec.value;
+		} else {
+			((uint32_t*)block)[i] += (uint32_t)v->rec.value;
+		}
+		receive_next(v);
+	}
+	v->pos += n;
+}
+
+/**
+ * Do a worker's share of the runs, sending the counts after each batch,
+ * then exit.
+ */
+static void stats_worker(int worker, int fd, uint32_t *progress,
+		const struct artifact *a_info_save,
+		const struct artifact_upkeep *aup_info_save)
+{
+	FILE *out = fdopen(fd, "wb");
+	uint32_t first;
+
+	if (!out) _exit(1);
+	quiet = true;
+	for (first = 1; first <= num_runs; first += RUNS_PER_CHECKPOINT) {
+		uint32_t last = MIN(num_runs, first + RUNS_PER_CHECKPOINT - 1);
+		struct stats_visit v = { 0, out, NULL, { 0, 0 }, false, false };
+		struct stats_record end = { STATS_BATCH_END, 0 };
+		uint32_t run;
+
+		for (run = first + worker; run <= last; run += num_workers) {
+			stats_do_run(run, a_info_save, aup_info_save);
+			progress[worker]++;
+		}
+
+		visit_level_data(send_block, &v);
+		if (v.failed || fwrite(&end, sizeof(end), 1, out) != 1
+				|| fflush(out)) {
+			_exit(1);
+		}
+	}
+	fclose(out);
+
+	/* Leave without running exit handlers meant for the parent */
+	_exit(0);
+}
+
+/**
+ * Return the number of runs finished by all the workers.
+ */
+static uint32_t stats_progress(const uint32_t *progress)
+{
+	uint32_t total = 0;
+	int i;
+
+	for (i = 0; i < num_workers; i++) {
+		total += ((volatile const uint32_t*)progress)[i];
+	}
+	return total;
+}
+
+/**
+ * Run the descents in num_workers worker processes and merge their counts,
+ * writing a checkpoint after each batch.  Returns the value of run to
+ * record for the final write.
+ */
+static uint32_t run_stats_parallel(time_t start,
+		const struct artifact *a_info_save,
+		const struct artifact_upkeep *aup_info_save)
+{
+	pid_t *pids = mem_zalloc(num_workers * sizeof(*pids));
+	struct stats_reader *readers =
+		mem_zalloc(num_workers * sizeof(*readers));
+	uint32_t *progress;
+	uint32_t first;
+	int i;
+
+	progress = mmap(NULL, num_workers * sizeof(*progress),
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (progress == MAP_FAILED) {
+		stats_close_db();
+		quit("Couldn't allocate memory for the workers!");
+	}
+	memset(progress, 0, num_workers * sizeof(*progress));
+
+	/* Don't let the workers repeat pending output */
+	fflush(stdout);
+
+	for (i = 0; i < num_workers; i++) {
+		int fds[2];
+
+		if (pipe(fds)) {
+			stats_close_db();
+			quit("Couldn't create a pipe for a worker!");
+		}
+		pids[i] = fork();
+		if (pids[i] < 0) {
+			stats_close_db();
+			quit("Couldn't start a worker!");
+		}
+		if (pids[i] == 0) {
+			int j;
+
+			close(fds[0]);
+			for (j = 0; j < i; j++) {
+				close(readers[j].fd);
+			}
+			stats_worker(i, fds[1], progress, a_info_save,
+				aup_info_save);
+		}
+		close(fds[1]);
+		readers[i].fd = fds[0];
+	}
+
+	for (first = 1; first <= num_runs; first += RUNS_PER_CHECKPOINT) {
+		uint32_t last = MIN(num_runs, first + RUNS_PER_CHECKPOINT - 1);
+
+		for (i = 0; i < num_workers; i++) {
+			struct stats_visit v = {
+				0, NULL, &readers[i], { 0, 0 }, false, false
+			};
+
+			while (!stats_reader_ready(&readers[i], 250)) {
+				if (!quiet) {
+					progress_bar(stats_progress(progress),
+						start);
+				}
+			}
+			receive_next(&v);
+			visit_level_data(receive_block, &v);
+			if (v.failed || !v.done) {
+				stats_close_db();
+				quit_fmt("Stats worker %d failed!", i);
+			}
+		}
+
+		/* Checkpoint after every full batch */
+		if (last % RUNS_PER_CHECKPOINT == 0) {
+			int err = stats_write_db(last);
+
+			if (err) {
+				stats_close_db();
+				quit_fmt("Problems writing to database!  sqlite3 errno %d.",
+						 err);
+			}
+		}
+
+		if (quiet) {
+			printf("Finished %d runs.\n", last);
+			fflush(stdout);
+		} else {
+			progress_bar(last, start);
+		}
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		int status;
+
+		close(readers[i].fd);
+		if (waitpid(pids[i], &status, 0) != pids[i]
+				|| !WIFEXITED(status) || WEXITSTATUS(status)) {
+			stats_close_db();
+			quit_fmt("Stats worker %d failed!", i);
+		}
+	}
+	munmap(progress, num_workers * sizeof(*progress));
+	mem_free(readers);
+	mem_free(pids);
+
+	return num_runs + 1;
+}
+
 static errr run_stats(void)
 {
 	uint32_t run;
@@ -1750,6 +2361,9 @@ static errr run_stats(void)
 	prep_output_dir();
 	create_indices();
 	alloc_memory();
+	event_add_handler(EVENT_GEN_LEVEL_START, gen_level_start, NULL);
+	event_add_handler(EVENT_GEN_LEVEL_RESTART, gen_level_restart, NULL);
+	event_add_handler(EVENT_GEN_PHASE_END, gen_phase_end, NULL);
 	if (randarts) {
 		a_info_save = mem_zalloc(z_info->a_max * sizeof(struct artifact));
 		aup_info_save = mem_zalloc(z_info->a_max
@@ -1768,44 +2382,39 @@ static errr run_stats(void)
 	status = stats_prep_db();
 	if (!status) quit("Couldn't prepare database!");
 
+	if (!stats_seed_set) stats_seed = (uint32_t)time(NULL);
+	if (num_workers > (int)num_runs) num_workers = MAX(num_runs, 1);
+
 	if (!quiet) {
-		printf("Beginning %d runs...\n", num_runs);
+		printf("Beginning %d runs (seed %lu)...\n", num_runs,
+			(unsigned long)stats_seed);
 		fflush(stdout);
 	}
 
 	start = time(NULL);
-	for (run = 1; run <= num_runs; run++) {
-		if (!quiet) progress_bar(run - 1, start);
-
-		if (randarts) {
-			for (i = 0; i < z_info->a_max; i++) {
-				memcpy(&a_info[i], &a_info_save[i],
-					sizeof(struct artifact));
-				memcpy(&aup_info[i], &aup_info_save[i],
-					sizeof(struct artifact_upkeep));
+	if (num_workers > 1) {
+		run = run_stats_parallel(start, a_info_save, aup_info_save);
+	} else {
+		for (run = 1; run <= num_runs; run++) {
+			if (!quiet) progress_bar(run - 1, start);
+
+			stats_do_run(run, a_info_save, aup_info_save);
+
+			/* Checkpoint every so many runs */
+			if (run % RUNS_PER_CHECKPOINT == 0) {
+				err = stats_write_db(run);
+				if (err) {
+					stats_close_db();
+					quit_fmt("Problems writing to database!  sqlite3 errno %d.",
+							 err);
+				}
 			}
-		}
-
-		initialize_character();
-		unkill_uniques();
-		reset_artifacts();
-		descend_dungeon();
-		stats_cleanup_angband_run();
 
-		/* Checkpoint every so many runs */
-		if (run % RUNS_PER_CHECKPOINT == 0) {
-			err = stats_write_db(run);
-			if (err) {
-				stats_db_close();
-				quit_fmt("Problems writing to database!  sqlite3 errno %d.",
-						 err);
+			if (quiet && run % 1000 == 0) {
+				printf("Finished %d runs.\n", run);
+				fflush(stdout);
 			}
 		}
-
-		if (quiet && run % 1000 == 0) {
-			printf("Finished %d runs.\n", run);
-			fflush(stdout);
-		}
 	}
 
 	if (!quiet) {
@@ -1815,13 +2424,16 @@ static errr run_stats(void)
 	}
 
 	err = stats_write_db(run);
-	stats_db_close();
+	stats_close_db();
 	if (err) quit_fmt("Problems writing to database!  sqlite3 errno %d.", err);
 
 	if (randarts) {
 		mem_free(aup_info_save);
 		mem_free(a_info_save);
 	}
+	event_remove_handler(EVENT_GEN_PHASE_END, gen_phase_end, NULL);
+	event_remove_handler(EVENT_GEN_LEVEL_RESTART, gen_level_restart, NULL);
+	event_remove_handler(EVENT_GEN_LEVEL_START, gen_level_start, NULL);
 	free_stats_memory();
 	if (!quiet) printf("Done!\n");
 	quit(NULL);
@@ -1950,17 +2562,25 @@ static void term_data_link(int i) {
 	angband_term[i] = t;
 }
 
-const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling) -C(class name) -R(race name)";
+const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -j(# of workers) -S(eed) -s(no selling) -f(ast dump) -c(sv counts) -C(class name) -R(race name)";
 
 /**
  * Usage:
  *
- * angband -mstats -- [-q] [-r] [-nNNNN] [-s]
+ * angband -mstats -- [-q] [-r] [-nNNNN] [-jNN] [-SNNNN] [-s] [-f] [-c]
  *
  *   -q      Quiet mode (turn off progress messages)
  *   -r      Turn on randarts
  *   -nNNNN  Make NNNN runs through the dungeon (default: 1)
+ *   -jNN    Split the runs between NN worker processes (default: 1).  For
+ *           a given seed and number of workers, the results are the same
+ *           from one invocation to the next.
+ *   -SNNNN  Use NNNN as the base random seed (default: the current time)
  *   -s      Turn on no-selling
+ *   -f      Write the database without syncing it to disk, which is faster
+ *           but leaves it corrupt if the machine crashes
+ *   -c      Write the counts to CSV files next to the database, one per
+ *           count table, rather than into the database itself
  *   -Cname  Use name, case-insensitive, as the player's class.  When not set,
  *           the player's class is the first class in lib/gamedata/class.txt.
  *   -Rname  Use name, case-insensitive, as the player's race.  When not set,
@@ -1984,10 +2604,27 @@ errr init_stats(int argc, char *argv[]) {
 			num_runs = atoi(&argv[i][2]);
 			continue;
 		}
+		if (prefix(argv[i], "-j")) {
+			num_workers = MAX(atoi(&argv[i][2]), 1);
+			continue;
+		}
+		if (prefix(argv[i], "-S")) {
+			stats_seed = (uint32_t)strtoul(&argv[i][2], NULL, 0);
+			stats_seed_set = true;
+			continue;
+		}
 		if (prefix(argv[i], "-s")) {
 			no_selling = 1;
 			continue;
 		}
+		if (streq(argv[i], "-f")) {
+			db_flags |= STATS_DB_FAST;
+			continue;
+		}
+		if (streq(argv[i], "-c")) {
+			db_flags |= STATS_DB_CSV;
+			continue;
+		}
 		if (prefix(argv[i], "-C")) {
 			chosen_class = argv[i] + 2;
 			continue;
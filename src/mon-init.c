@@ -1753,16 +1753,59 @@ static errr run_parse_monster(struct parser *p) {
 	return parse_file_quit_not_found(p, "monster");
 }
 
+/**
+ * Order races by name, ignoring case, with ties going to the lower index so
+ * that the first race of a given name sorts first.
+ */
+static int cmp_race_name(const void *a, const void *b)
+{
+	const struct monster_race *ra = *(const struct monster_race * const *) a;
+	const struct monster_race *rb = *(const struct monster_race * const *) b;
+	int c = my_stricmp(ra->name, rb->name);
+
+	if (c) return c;
+	return (ra->ridx < rb->ridx) ? -1 : ((ra->ridx > rb->ridx) ? 1 : 0);
+}
+
+/**
+ * Look up the race a friend or shape line refers to.  Names which match a
+ * race exactly are found by binary search of the sorted list; anything else
+ * falls back to the substring match of lookup_monster(), so the result is
+ * the same as calling that directly.
+ */
+static struct monster_race *find_race_by_name(struct monster_race **sorted,
+		int n, const char *name)
+{
+	int lo = 0, hi = n;
+
+	/* Find the first race whose name is not less than the one wanted */
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (my_stricmp(sorted[mid]->name, name) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo < n && !my_stricmp(sorted[lo]->name, name)) {
+		return sorted[lo];
+	}
+	return lookup_monster(name);
+}
+
 static errr finish_parse_monster(struct parser *p) {
 	struct monster_race *r, *n;
+	struct monster_race **sorted;
 	size_t i;
-	int ridx;
+	int ridx, n_sorted;
 	errr result = PARSE_ERROR_NONE;
 	int maxe = get_parser_error_limit(), counte = 0;
 
-	/* Scan the list for the max id and max blows */
+	/* Scan the list for the max id, max blows and largest light */
 	z_info->r_max = 0;
 	z_info->mon_blows_max = 0;
+	z_info->mon_light_max = 0;
 	r = parser_priv(p);
 	while (r) {
 		int max_blows = 0;
@@ -1774,6 +1817,8 @@ static errr finish_parse_monster(struct parser *p) {
 		}
 		if (max_blows > z_info->mon_blows_max)
 			z_info->mon_blows_max = max_blows;
+		if (ABS(r->light) - 1 > z_info->mon_light_max)
+			z_info->mon_light_max = ABS(r->light) - 1;
 		r = r->next;
 	}
 
@@ -1826,7 +1871,18 @@ static errr finish_parse_monster(struct parser *p) {
 	}
 	z_info->r_max += 1;
 
-	/* Convert friend and shape names into race pointers */
+	/*
+	 * Convert friend and shape names into race pointers, using a list of
+	 * the races sorted by name so this isn't quadratic in the race count
+	 */
+	sorted = mem_alloc(z_info->r_max * sizeof(*sorted));
+	n_sorted = 0;
+	for (i = 0; i < z_info->r_max; i++) {
+		if (r_info[i].name) {
+			sorted[n_sorted++] = &r_info[i];
+		}
+	}
+	qsort(sorted, n_sorted, sizeof(*sorted), cmp_race_name);
 	for (i = 0; i < z_info->r_max; i++) {
 		struct monster_race *race = &r_info[i];
 		struct monster_friends *f;
@@ -1835,7 +1891,8 @@ static errr finish_parse_monster(struct parser *p) {
 			if (!my_stricmp(f->name, "same")) {
 				f->race = race;
 			} else {
-				f->race = lookup_monster(f->name);
+				f->race = find_race_by_name(sorted, n_sorted,
+					f->name);
 			}
 			if (!f->race) {
 				if (result == PARSE_ERROR_NONE) {
@@ -1859,7 +1916,7 @@ static errr finish_parse_monster(struct parser *p) {
 				s->name = NULL;
 				continue;
 			}
-			s->race = lookup_monster(s->name);
+			s->race = find_race_by_name(sorted, n_sorted, s->name);
 			if (!s->race) {
 				if (result == PARSE_ERROR_NONE) {
 					result = PARSE_ERROR_INVALID_MONSTER;
@@ -1878,6 +1935,7 @@ static errr finish_parse_monster(struct parser *p) {
 			s->name = NULL;
 		}
 	}
+	mem_free(sorted);
 
 	/* Allocate space for the monster lore */
 	l_list = mem_zalloc(z_info->r_max * sizeof(struct monster_lore));
@@ -19,10 +19,12 @@
 #include "angband.h"
 #include "alloc.h"
 #include "game-world.h"
+#include "generate.h"
 #include "init.h"
 #include "mon-group.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-predicate.h"
 #include "mon-timed.h"
 #include "mon-util.h"
@@ -49,10 +51,32 @@
  * - prob3 is calculated by get_mon_num(), which checks whether universal
  *         restrictions apply (for example, unique monsters can only appear
  *         once on a given level); prob3 is always either prob2 or 0.
+ *
+ * get_mon_num() keeps the running totals of prob3 for the levels it was last
+ * asked about, and only works them out again when those levels change, when
+ * get_mon_num_prep() changes prob2, or when one of the uniques that could be
+ * chosen appears or disappears.
  * ------------------------------------------------------------------------ */
 static int16_t alloc_race_size;
 static struct alloc_entry *alloc_race_table;
 
+/* alloc_race_total[i] is the total prob3 of the table entries before i */
+static uint32_t *alloc_race_total;
+
+/* Number of entries covered by alloc_race_total, or -1 if it is out of date */
+static int alloc_race_count = -1;
+
+/* Levels alloc_race_total was worked out for */
+static int alloc_race_generated_level;
+static int alloc_race_current_level;
+
+/* Entries for uniques whose prob3 depends only on whether they're around */
+static int *alloc_race_uniques;
+static int alloc_race_num_uniques;
+
+/* Whether get_mon_num_prep() has restricted prob2 */
+static bool alloc_race_restricted;
+
 /**
  * Initialize monster allocation info
  */
@@ -93,6 +117,10 @@ static void init_race_allocs(void) {
 
 	/* Allocate the alloc_race_table */
 	alloc_race_table = mem_zalloc(alloc_race_size * sizeof(alloc_entry));
+	alloc_race_total = mem_zalloc((alloc_race_size + 1) * sizeof(uint32_t));
+	alloc_race_uniques = mem_zalloc(alloc_race_size * sizeof(int));
+	alloc_race_count = -1;
+	alloc_race_restricted = false;
 
 	/* Get the table entry */
 	table = alloc_race_table;
@@ -137,6 +165,8 @@ static void init_race_allocs(void) {
 }
 
 static void cleanup_race_allocs(void) {
+	mem_free(alloc_race_uniques);
+	mem_free(alloc_race_total);
 	mem_free(alloc_race_table);
 }
 
@@ -151,6 +181,11 @@ void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 {
 	int i;
 
+	/* Nothing to undo */
+	if (!get_mon_num_hook && !alloc_race_restricted) return;
+	alloc_race_restricted = get_mon_num_hook != NULL;
+	alloc_race_count = -1;
+
 	/* Scan the allocation table */
 	for (i = 0; i < alloc_race_size; i++) {
 		alloc_entry *entry = &alloc_race_table[i];
@@ -168,28 +203,111 @@ void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 }
 
 /**
- * Helper function for get_mon_num(). Scans the prepared monster allocation
- * table and picks a random monster. Returns the index of a monster in
- * `table`.
+ * Helper function for get_mon_num(). Check whether the running totals are
+ * still right for the given levels.
  */
-static struct monster_race *get_mon_race_aux(long total,
-											 const alloc_entry *table)
+static bool race_allocs_current(int generated_level, int current_level)
 {
 	int i;
 
-	/* Pick a monster */
-	long value = randint0(total);
+	if (alloc_race_count < 0) return false;
+	if (generated_level != alloc_race_generated_level) return false;
+	if (current_level != alloc_race_current_level) return false;
+
+	/* Only one copy of a unique must be around at the same time */
+	for (i = 0; i < alloc_race_num_uniques; i++) {
+		const alloc_entry *entry = &alloc_race_table[alloc_race_uniques[i]];
+		const struct monster_race *race = &r_info[entry->index];
+		if ((race->cur_num < race->max_num) != (entry->prob3 > 0))
+			return false;
+	}
+
+	return true;
+}
 
-	/* Find the monster */
+/**
+ * Helper function for get_mon_num(). Works out prob3 and its running totals
+ * for the given levels.
+ */
+static void race_allocs_total(int generated_level, int current_level)
+{
+	int i;
+	alloc_entry *table = alloc_race_table;
+	time_t cur_time = time(NULL);
+	struct tm *date = localtime(&cur_time);
+	bool christmas = date->tm_mon == 11 && date->tm_mday >= 24
+		&& date->tm_mday <= 26;
+
+	alloc_race_num_uniques = 0;
+	alloc_race_total[0] = 0;
+
+	/* Process probabilities */
 	for (i = 0; i < alloc_race_size; i++) {
-		/* Found the entry */
-		if (value < table[i].prob3) break;
+		struct monster_race *race;
+
+		/* Monsters are sorted by depth */
+		if (table[i].level > generated_level) break;
+
+		/* Default */
+		table[i].prob3 = 0;
+		alloc_race_total[i + 1] = alloc_race_total[i];
+
+		/* No town monsters in dungeon */
+		if (generated_level > 0 && table[i].level <= 0) continue;
+
+		/* Get the chosen monster */
+		race = &r_info[table[i].index];
+
+		/* No seasonal monsters outside of Christmas */
+		if (rf_has(race->flags, RF_SEASONAL) && !christmas)
+			continue;
+
+		/* Some monsters never appear out of depth */
+		if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > current_level)
+			continue;
+
+		/* Only one copy of a unique must be around at the same time */
+		if (rf_has(race->flags, RF_UNIQUE)) {
+			if (table[i].prob2) {
+				alloc_race_uniques[alloc_race_num_uniques++] = i;
+			}
+			if (race->cur_num >= race->max_num) continue;
+		}
+
+		/* Accept */
+		table[i].prob3 = table[i].prob2;
 
-		/* Decrement */
-		value -= table[i].prob3;
+		/* Total */
+		alloc_race_total[i + 1] += table[i].prob3;
+	}
+
+	alloc_race_count = i;
+	alloc_race_generated_level = generated_level;
+	alloc_race_current_level = current_level;
+}
+
+/**
+ * Helper function for get_mon_num(). Picks a random monster from the
+ * prepared allocation table, using a binary search of the running totals.
+ */
+static struct monster_race *get_mon_race_aux(uint32_t total)
+{
+	int ilow = 0, ihigh = alloc_race_count;
+
+	/* Pick a monster */
+	uint32_t value = randint0(total);
+
+	/* Find the entry with alloc_race_total[i] <= value < [i + 1] */
+	while (ilow < ihigh - 1) {
+		int imid = ilow + (ihigh - ilow) / 2;
+		if (alloc_race_total[imid] <= value) {
+			ilow = imid;
+		} else {
+			ihigh = imid;
+		}
 	}
 
-	return &r_info[table[i].index];
+	return &r_info[alloc_race_table[ilow].index];
 }
 
 /**
@@ -220,59 +338,25 @@ static struct monster_race *get_mon_race_aux(long total,
  */
 struct monster_race *get_mon_num(int generated_level, int current_level)
 {
-	int i, p;
-	long total;
+	int p;
+	uint32_t total;
 	struct monster_race *race;
-	alloc_entry *table = alloc_race_table;
-	time_t cur_time = time(NULL);
-	struct tm *date = localtime(&cur_time);
 
 	/* Occasionally produce a nastier monster in the dungeon */
 	if (generated_level > 0 && one_in_(z_info->ood_monster_chance))
 		generated_level += MIN(generated_level / 4 + 2,
 			z_info->ood_monster_amount);
 
-	total = 0L;
-
 	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++) {
-		/* Monsters are sorted by depth */
-		if (table[i].level > generated_level) break;
-
-		/* Default */
-		table[i].prob3 = 0;
-
-		/* No town monsters in dungeon */
-		if (generated_level > 0 && table[i].level <= 0) continue;
-
-		/* Get the chosen monster */
-		race = &r_info[table[i].index];
-
-		/* No seasonal monsters outside of Christmas */
-		if (rf_has(race->flags, RF_SEASONAL) &&
-			!(date->tm_mon == 11 && date->tm_mday >= 24 && date->tm_mday <= 26))
-			continue;
-
-		/* Only one copy of a unique must be around at the same time */
-		if (rf_has(race->flags, RF_UNIQUE) && (race->cur_num >= race->max_num))
-			continue;
-
-		/* Some monsters never appear out of depth */
-		if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > current_level)
-			continue;
-
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
-
-		/* Total */
-		total += table[i].prob3;
-	}
+	if (!race_allocs_current(generated_level, current_level))
+		race_allocs_total(generated_level, current_level);
+	total = alloc_race_total[alloc_race_count];
 
 	/* No legal monsters */
-	if (total <= 0) return NULL;
+	if (!total) return NULL;
 
 	/* Pick a monster */
-	race = get_mon_race_aux(total, table);
+	race = get_mon_race_aux(total);
 
 	/* Try for a "harder" monster once (50%) or twice (10%) */
 	p = randint0(100);
@@ -281,7 +365,7 @@ struct monster_race *get_mon_num(int generated_level, int current_level)
 		struct monster_race *old = race;
 
 		/* Pick a new monster */
-		race = get_mon_race_aux(total, table);
+		race = get_mon_race_aux(total);
 
 		/* Keep the deepest one */
 		if (race->level < old->level) race = old;
@@ -292,7 +376,7 @@ struct monster_race *get_mon_num(int generated_level, int current_level)
 		struct monster_race *old = race;
 
 		/* Pick a monster */
-		race = get_mon_race_aux(total, table);
+		race = get_mon_race_aux(total);
 
 		/* Keep the deepest one */
 		if (race->level < old->level) race = old;
@@ -462,6 +546,10 @@ void monster_index_move(struct chunk *c, int i1, int i2)
 
 	/* Wipe hole */
 	memset(cave_monster(c, i1), 0, sizeof(struct monster));
+
+	/* The monster calendar goes by index, as do monsters to update */
+	c->mon_resched = true;
+	monsters_need_update(c);
 }
 
 
@@ -623,11 +711,14 @@ void wipe_mon_list(struct chunk *c, struct player *p)
 	/* Reset "reproducer" count */
 	c->num_repro = 0;
 
-	/* No more target */
-	target_set_monster(0);
+	/* Levels other than the current one can't hold the target */
+	if (c == cave) {
+		/* No more target */
+		target_set_monster(0);
 
-	/* No more tracking */
-	health_track(p->upkeep, 0);
+		/* No more tracking */
+		health_track(p->upkeep, 0);
+	}
 }
 
 /**
@@ -1050,6 +1141,9 @@ int16_t place_monster(struct chunk *c, struct loc grid, struct monster *mon,
 		mon_create_mimicked_object(c, new_mon, m_idx);
 	}
 
+	/* Enter it in the monster calendar */
+	schedule_new_monster(c, new_mon);
+
 	/* Result */
 	return m_idx;
 }
@@ -1116,16 +1210,16 @@ static bool place_new_monster_one(struct chunk *c, struct loc grid,
 	if (race->level > c->depth) {
 		if (rf_has(race->flags, RF_UNIQUE)) { /* OOD unique */
 			if (OPT(player, cheat_hear))
-				msg("Deep unique (%s).", race->name);
+				level_msg("Deep unique (%s).", race->name);
 		} else { /* Normal monsters but OOD */
 			if (OPT(player, cheat_hear))
-				msg("Deep monster (%s).", race->name);
+				level_msg("Deep monster (%s).", race->name);
 		}
 		/* Boost rating by power per 10 levels OOD */
 		add_to_monster_rating(c, (race->level - c->depth) * race->level
 			* race->level);
 	} else if (rf_has(race->flags, RF_UNIQUE) && OPT(player, cheat_hear)) {
-		msg("Unique (%s).", race->name);
+		level_msg("Unique (%s).", race->name);
 	}
 
 	/* Get local monster */
@@ -1870,110 +1870,419 @@ static void regen_monster(struct monster *mon, int num)
 
 /**
  * ------------------------------------------------------------------------
- * Monster processing routines to be called by the main game loop
+ * Monster scheduling
  * ------------------------------------------------------------------------ */
 /**
- * Process all the "live" monsters, once per game turn.
+ * Every monster gains energy every game turn, but on most turns most of them
+ * are only saving it up.  So rather than visiting every monster every turn,
+ * the energy of a monster is only brought up to date when it is needed:
+ * mon->energy is the monster's energy before its gain for turn
+ * mon->energy_turn.  Each monster is also entered in the level's calendar
+ * for the turn on which it will next have enough energy to move, and
+ * process_monsters() only visits the monsters which come up in the calendar
+ * (and all of them on the turns when monsters regenerate).
  *
- * During each game turn, we scan through the list of all the "live" monsters,
- * (backwards, so we can excise any "freshly dead" monsters), energizing each
- * monster, and allowing fully energized monsters to move, attack, pass, etc.
+ * The calendar has a bitmap of monster indices for each of the next
+ * MON_CALENDAR_TURNS turns, which gives the monsters for a turn in the same
+ * order the full scan would.  Monsters which won't be able to move by the
+ * end of the calendar are entered on its last day, and just get their energy
+ * when they come up.
  *
- * This function and its children are responsible for a considerable fraction
- * of the processor time in normal situations, greater if the character is
- * resting.
+ * The last monster pass of a game turn goes down from the highest monster
+ * index, so a monster which isn't due to move has had that turn's energy
+ * once the pass has gone below it.  Anything which changes a monster's
+ * energy or speed needs to call monster_energy_sync() before the change and
+ * schedule_monster() after it.
  */
-void process_monsters(int minimum_energy)
+#define MON_CALENDAR_TURNS	128
+
+/**
+ * Number of 32-bit words in one day of the monster calendar
+ */
+#define MON_CALENDAR_WORDS	((z_info->level_monster_max + 31) / 32)
+
+/**
+ * The energy a monster gains each game turn at its current speed
+ */
+static int monster_turn_energy(const struct monster *mon)
+{
+	int mspeed = mon->mspeed;
+
+	if (mon->m_timed[MON_TMD_FAST])
+		mspeed += 10;
+	if (mon->m_timed[MON_TMD_SLOW]) {
+		int slow_level = monster_effect_level(mon, MON_TMD_SLOW);
+		mspeed -= (2 * slow_level);
+	}
+
+	return turn_energy(mspeed);
+}
+
+/**
+ * Is this a monster on a level whose monsters are being scheduled?
+ */
+static bool monster_is_scheduled(struct chunk *c, const struct monster *mon)
+{
+	return c && c->mon_calendar && mon->race && mon->midx > 0 &&
+		mon->midx < cave_monster_max(c) &&
+		cave_monster(c, mon->midx) == mon;
+}
+
+/**
+ * The bitmap word holding a monster's entry for a given turn
+ */
+static uint32_t *monster_calendar_word(struct chunk *c, int32_t when, int i)
+{
+	return &c->mon_calendar[(when % MON_CALENDAR_TURNS) * MON_CALENDAR_WORDS
+		+ i / 32];
+}
+
+/**
+ * The first game turn the monster has not yet had its energy for
+ */
+static int32_t monster_energy_limit(struct chunk *c,
+		const struct monster *mon)
+{
+	if (c->mon_pass_turn == turn && mon->midx > c->mon_pass_pos)
+		return turn + 1;
+	return turn;
+}
+
+/**
+ * Bring a monster's energy up to date
+ */
+void monster_energy_sync(struct chunk *c, struct monster *mon)
+{
+	int32_t limit;
+
+	if (!monster_is_scheduled(c, mon)) return;
+
+	/* None of the turns skipped could have left it able to move */
+	limit = monster_energy_limit(c, mon);
+	if (mon->energy_turn < limit) {
+		mon->energy += (limit - mon->energy_turn) * monster_turn_energy(mon);
+		mon->energy_turn = limit;
+	}
+}
+
+/**
+ * Work out when a monster will next be able to move, and enter it in the
+ * calendar for then
+ */
+void schedule_monster(struct chunk *c, struct monster *mon)
+{
+	int need, gain;
+	int32_t when;
+
+	if (!monster_is_scheduled(c, mon)) return;
+
+	/* Take out any old entry */
+	if (mon->act_turn >= turn) {
+		*monster_calendar_word(c, mon->act_turn, mon->midx) &=
+			~(1U << (mon->midx % 32));
+	}
+
+	need = z_info->move_energy - mon->energy;
+	gain = monster_turn_energy(mon);
+	if (need <= 0) {
+		when = mon->energy_turn;
+	} else if (gain > 0) {
+		when = mon->energy_turn + (need + gain - 1) / gain;
+	} else {
+		/* Never going to move */
+		mon->act_turn = -1;
+		return;
+	}
+
+	if (when <= turn && c->mon_due_turn == turn) {
+		/* Already waiting to move this turn */
+		mon->act_turn = -1;
+		return;
+	}
+	mon->act_turn = MIN(MAX(when, turn), turn + MON_CALENDAR_TURNS - 1);
+	*monster_calendar_word(c, mon->act_turn, mon->midx) |=
+		1U << (mon->midx % 32);
+}
+
+/**
+ * Start scheduling a newly placed monster
+ */
+void schedule_new_monster(struct chunk *c, struct monster *mon)
 {
+	if (!monster_is_scheduled(c, mon)) return;
+
+	/* A monster placed above the last pass misses this turn, as before */
+	mon->energy_turn = monster_energy_limit(c, mon);
+	mon->act_turn = -1;
+	schedule_monster(c, mon);
+}
+
+/**
+ * Set up the calendar for a level, either from scratch or because the
+ * monster indices have changed
+ */
+static void schedule_monsters(struct chunk *c)
+{
+	size_t size = MON_CALENDAR_TURNS * MON_CALENDAR_WORDS * sizeof(uint32_t);
 	int i;
-	int mspeed;
 
-	/* Only process some things every so often */
-	bool regen = false;
+	if (!c->mon_calendar) {
+		c->mon_calendar = mem_zalloc(size);
+		c->mon_due = mem_zalloc(z_info->level_monster_max * sizeof(int));
+		c->mon_pass_turn = -1;
+
+		/* Any monster marked as handled has already had this turn */
+		for (i = 1; i < cave_monster_max(c); i++) {
+			struct monster *mon = cave_monster(c, i);
+			if (!mon->race) continue;
+			mon->energy_turn = mflag_has(mon->mflag, MFLAG_HANDLED) ?
+				turn + 1 : turn;
+			mflag_off(mon->mflag, MFLAG_HANDLED);
+		}
+	} else {
+		memset(c->mon_calendar, 0, size);
+	}
 
-	/* Regenerate hitpoints and mana every 100 game turns */
-	if (turn % 100 == 0)
-		regen = true;
+	c->mon_due_count = 0;
+	c->mon_due_turn = -1;
+	c->mon_resched = false;
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+		mon->act_turn = -1;
+		schedule_monster(c, mon);
+	}
+}
 
-	/* Process the monsters (backwards) */
-	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
-		struct monster *mon;
-		bool moving;
+/**
+ * Collect the monsters which have enough energy to move this turn, in the
+ * order process_monsters() handles them
+ */
+static void gather_due_monsters(struct chunk *c)
+{
+	uint32_t *day;
+	int w;
 
-		/* Handle "leaving" */
-		if (player->is_dead || player->upkeep->generate_level) break;
+	if (!c->mon_calendar || c->mon_resched) {
+		schedule_monsters(c);
+	}
+	if (c->mon_due_turn == turn) return;
 
-		/* Get a 'live' monster */
-		mon = cave_monster(cave, i);
-		if (!mon->race) continue;
+	c->mon_due_count = 0;
+	day = monster_calendar_word(c, turn, 0);
+	for (w = MON_CALENDAR_WORDS - 1; w >= 0; w--) {
+		int b;
 
-		/* Ignore monsters that have already been handled */
-		if (mflag_has(mon->mflag, MFLAG_HANDLED))
-			continue;
+		if (!day[w]) continue;
+		for (b = 31; b >= 0; b--) {
+			int i = w * 32 + b;
+			struct monster *mon;
 
-		/* Not enough energy to move yet */
-		if (mon->energy < minimum_energy) continue;
+			if (!(day[w] & (1U << b)) || i >= cave_monster_max(c))
+				continue;
 
-		/* Does this monster have enough energy to move? */
-		moving = mon->energy >= z_info->move_energy ? true : false;
+			/* Skip monsters which have died since being entered */
+			mon = cave_monster(c, i);
+			if (!mon->race || mon->act_turn != turn) continue;
+			mon->act_turn = -1;
+			c->mon_due[c->mon_due_count++] = i;
+		}
+		day[w] = 0;
+	}
+	c->mon_due_turn = turn;
+}
 
-		/* Prevent reprocessing */
-		mflag_on(mon->mflag, MFLAG_HANDLED);
+/**
+ * Bring the energy of all the monsters on a level up to date, marking the
+ * ones which have already been handled this turn, so the level can be saved
+ * or left
+ */
+void sync_monster_energy(struct chunk *c)
+{
+	int i;
 
-		/* Handle monster regeneration if requested */
-		if (regen)
-			regen_monster(mon, 1);
+	if (!c->mon_calendar) return;
 
-		/* Calculate the net speed */
-		mspeed = mon->mspeed;
-		if (mon->m_timed[MON_TMD_FAST])
-			mspeed += 10;
-		if (mon->m_timed[MON_TMD_SLOW]) {
-			int slow_level = monster_effect_level(mon, MON_TMD_SLOW);
-			mspeed -= (2 * slow_level);
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+		if (!mon->race) continue;
+		monster_energy_sync(c, mon);
+		if (mon->energy_turn > turn) {
+			mflag_on(mon->mflag, MFLAG_HANDLED);
+		} else {
+			mflag_off(mon->mflag, MFLAG_HANDLED);
 		}
+	}
+}
 
-		/* Give this monster some energy */
-		mon->energy += turn_energy(mspeed);
+/**
+ * Stop scheduling the monsters on a level the player is leaving
+ */
+void unschedule_monsters(struct chunk *c)
+{
+	if (!c->mon_calendar) return;
+
+	sync_monster_energy(c);
+	mem_free(c->mon_calendar);
+	c->mon_calendar = NULL;
+	mem_free(c->mon_due);
+	c->mon_due = NULL;
+	c->mon_due_count = 0;
+}
 
-		/* End the turn of monsters without enough energy to move */
-		if (!moving)
-			continue;
+/**
+ * ------------------------------------------------------------------------
+ * Monster processing routines to be called by the main game loop
+ * ------------------------------------------------------------------------ */
+/**
+ * Energize a monster, and let it move if it has enough energy
+ */
+static void process_monster(struct chunk *c, int i, int minimum_energy,
+		bool regen)
+{
+	struct monster *mon = cave_monster(c, i);
+	bool moving;
+
+	/* Get a 'live' monster */
+	if (!mon->race) return;
+
+	/* Ignore monsters that have already been handled */
+	if (mon->energy_turn > turn) return;
+
+	/* Catch up on the energy it has gained since it was last handled */
+	monster_energy_sync(c, mon);
 
-		/* Use up "some" energy */
+	/* Not enough energy to move yet */
+	if (mon->energy < minimum_energy) return;
+
+	/* Does this monster have enough energy to move? */
+	moving = mon->energy >= z_info->move_energy ? true : false;
+
+	/* Handle monster regeneration if requested */
+	if (regen)
+		regen_monster(mon, 1);
+
+	/* Give this monster some energy, and prevent reprocessing */
+	mon->energy += monster_turn_energy(mon);
+	mon->energy_turn = turn + 1;
+
+	/* Use up "some" energy */
+	if (moving)
 		mon->energy -= z_info->move_energy;
 
-		/* Mimics lie in wait */
-		if (monster_is_mimicking(mon)) continue;
+	/* Work out its next move */
+	schedule_monster(c, mon);
 
-		/* Check if the monster is active */
-		if (monster_check_active(mon)) {
-			/* Process timed effects - skip turn if necessary */
-			if (process_monster_timed(mon))
-				continue;
+	/* End the turn of monsters without enough energy to move */
+	if (!moving)
+		return;
 
-			/*
-			 * Cannot break (only want to do so when it is the
-			 * player's turn to act), but keep the user interface
-			 * responsive.
-			 */
-			(void)check_break(false, 0);
+	/* Mimics lie in wait */
+	if (monster_is_mimicking(mon)) return;
 
-			/* Set this monster to be the current actor */
-			cave->mon_current = i;
+	/* Check if the monster is active */
+	if (monster_check_active(mon)) {
+		/* Process timed effects - skip turn if necessary */
+		if (process_monster_timed(mon))
+			return;
+
+		/*
+		 * Cannot break (only want to do so when it is the
+		 * player's turn to act), but keep the user interface
+		 * responsive.
+		 */
+		(void)check_break(false, 0);
 
-			/* The monster takes its turn */
-			monster_turn(mon);
+		/* Set this monster to be the current actor */
+		c->mon_current = i;
 
-			/*
-			 * For symmetry with the player, monster can take
-			 * terrain damage after its turn.
-			 */
-			monster_take_terrain_damage(mon);
+		/* The monster takes its turn */
+		monster_turn(mon);
 
-			/* Monster is no longer current */
-			cave->mon_current = -1;
+		/*
+		 * For symmetry with the player, monster can take
+		 * terrain damage after its turn.
+		 */
+		monster_take_terrain_damage(mon);
+
+		/* Monster is no longer current */
+		c->mon_current = -1;
+	}
+}
+
+/**
+ * Process all the "live" monsters, once per game turn.
+ *
+ * During each game turn, we scan through the list of all the "live" monsters,
+ * (backwards, so we can excise any "freshly dead" monsters), energizing each
+ * monster, and allowing fully energized monsters to move, attack, pass, etc.
+ * Only the monsters with enough energy to move are actually visited, except
+ * on turns when monsters regenerate; the rest get their energy when it is
+ * next needed (see monster_energy_sync()).
+ *
+ * This function and its children are responsible for a considerable fraction
+ * of the processor time in normal situations, greater if the character is
+ * resting.
+ */
+void process_monsters(int minimum_energy)
+{
+	struct chunk *c = cave;
+	int i, n;
+
+	/* Only process some things every so often */
+	bool regen = false;
+
+	/* Regenerate hitpoints and mana every 100 game turns */
+	if (turn % 100 == 0)
+		regen = true;
+
+	/* Find the monsters that can move this turn */
+	gather_due_monsters(c);
+
+	if (minimum_energy > z_info->move_energy) {
+		/* Only monsters that can move have this much energy */
+		for (n = 0; n < c->mon_due_count; n++) {
+			/* Handle "leaving" */
+			if (player->is_dead || player->upkeep->generate_level) break;
+
+			process_monster(c, c->mon_due[n], minimum_energy, regen);
 		}
+	} else if (minimum_energy > 0) {
+		/* Process the monsters (backwards) */
+		for (i = cave_monster_max(c) - 1; i >= 1; i--) {
+			/* Handle "leaving" */
+			if (player->is_dead || player->upkeep->generate_level) break;
+
+			process_monster(c, i, minimum_energy, regen);
+		}
+	} else {
+		/* Every monster gets its energy in this pass */
+		c->mon_pass_turn = turn;
+		c->mon_pass_pos = cave_monster_max(c) - 1;
+		if (regen) {
+			/* Process the monsters (backwards) */
+			for (i = cave_monster_max(c) - 1; i >= 1; i--) {
+				/* Handle "leaving" */
+				if (player->is_dead || player->upkeep->generate_level)
+					break;
+
+				c->mon_pass_pos = i;
+				process_monster(c, i, 0, true);
+			}
+		} else {
+			/* Process the ones that can move (backwards) */
+			for (n = 0; n < c->mon_due_count; n++) {
+				/* Handle "leaving" */
+				if (player->is_dead || player->upkeep->generate_level)
+					break;
+
+				c->mon_pass_pos = c->mon_due[n];
+				process_monster(c, c->mon_due[n], 0, false);
+			}
+		}
+
+		/* The pass reached all the way down unless it was cut short */
+		if (!player->is_dead && !player->upkeep->generate_level)
+			c->mon_pass_pos = 0;
 	}
 
 	/* Update monster visibility after this */
@@ -1982,23 +2291,33 @@ void process_monsters(int minimum_energy)
 }
 
 /**
- * Clear 'moved' status from all monsters.
+ * Finish off the monsters' game turn.
  *
- * Clear noise if appropriate.
+ * If the last pass was cut short, the monsters it did not reach miss their
+ * energy for this turn.
  */
 void reset_monsters(void)
 {
 	int i;
-	struct monster *mon;
 
-	/* Process the monsters (backwards) */
+	/* The pass was completed */
+	if (!cave->mon_calendar || cave->mon_pass_turn != turn ||
+		!cave->mon_pass_pos)
+		return;
+
 	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
 		/* Access the monster */
-		mon = cave_monster(cave, i);
+		struct monster *mon = cave_monster(cave, i);
+		if (!mon->race) continue;
 
-		/* Monster is ready to go again */
-		mflag_off(mon->mflag, MFLAG_HANDLED);
+		/* Monster is ready to go again next turn */
+		monster_energy_sync(cave, mon);
+		mon->energy_turn = MAX(mon->energy_turn, turn + 1);
 	}
+	cave->mon_pass_pos = 0;
+
+	/* Queue the ones which were due to move again */
+	cave->mon_resched = true;
 }
 
 /**
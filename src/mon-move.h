@@ -18,6 +18,7 @@
 #ifndef MONSTER_MOVE_H
 #define MONSTER_MOVE_H
 
+#include "monster.h"
 
 enum monster_stagger {
 	 NO_STAGGER = 0,
@@ -26,6 +27,11 @@ enum monster_stagger {
 };
 
 bool multiply_monster(const struct monster *mon);
+void monster_energy_sync(struct chunk *c, struct monster *mon);
+void schedule_monster(struct chunk *c, struct monster *mon);
+void schedule_new_monster(struct chunk *c, struct monster *mon);
+void sync_monster_energy(struct chunk *c);
+void unschedule_monsters(struct chunk *c);
 void process_monsters(int minimum_energy);
 void reset_monsters(void);
 void restore_monsters(void);
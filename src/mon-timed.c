@@ -19,6 +19,7 @@
 #include "angband.h"
 #include "mon-desc.h"
 #include "mon-lore.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-predicate.h"
 #include "mon-spell.h"
@@ -188,7 +189,15 @@ static bool mon_set_timed(struct monster *mon,
 		resisted = true;
 		m_note = MON_MSG_UNAFFECTED;
 	} else {
+		bool speed = effect_type == MON_TMD_FAST
+			|| effect_type == MON_TMD_SLOW;
+
+		/* Speed changes need the monster's energy brought up to date */
+		if (speed)
+			monster_energy_sync(cave, mon);
 		mon->m_timed[effect_type] = timer;
+		if (speed)
+			schedule_monster(cave, mon);
 		update = true;
 	}
 
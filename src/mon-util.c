@@ -25,6 +25,7 @@
 #include "mon-list.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-predicate.h"
 #include "mon-spell.h"
@@ -223,6 +224,9 @@ static void path_analyse(struct chunk *c, struct loc grid)
 	for (i = 0; i < path_n - 1; ++i) {
 		/* Forget grids which would block los */
 		if (!square_allowslos(player->cave, path_g[i])) {
+			if (square(c, path_g[i])->mon > 0) {
+				monster_needs_update(c, square(c, path_g[i])->mon);
+			}
 			sqinfo_off(square(c, path_g[i])->info, SQUARE_SEEN);
 			square_forget(c, path_g[i]);
 			square_light_spot(c, path_g[i]);
@@ -230,6 +234,43 @@ static void path_analyse(struct chunk *c, struct loc grid)
 	}
 }
 
+/**
+ * The parts of the player's state which update_mon() looks at for every
+ * monster, as they were when update_monsters() last looked at every monster
+ */
+static struct {
+	bool telepathy;
+	bool see_invis;
+	bool blind;
+	int see_infra;
+} mon_view_basis;
+
+/**
+ * Get the grid distances to monsters are measured from
+ */
+static struct loc mon_view_origin(struct chunk *c)
+{
+	/* If still generating the level, measure distances from the middle */
+	return character_dungeon ? player->grid :
+		loc(c->width / 2, c->height / 2);
+}
+
+/**
+ * Get the approximate distance from a grid to a monster, as kept in "cdis"
+ */
+static int mon_view_distance(const struct monster *mon, struct loc pgrid)
+{
+	/* Distance components */
+	int dy = ABS(pgrid.y - mon->grid.y);
+	int dx = ABS(pgrid.x - mon->grid.x);
+
+	/* Approximate distance */
+	int d = (dy > dx) ? (dy + (dx >>  1)) : (dx + (dy >> 1));
+
+	/* Restrict distance */
+	return MIN(d, 255);
+}
+
 /**
  * This function updates the monster record of the given monster
  *
@@ -294,9 +335,7 @@ void update_mon(struct monster *mon, struct chunk *c, bool full)
 
 	int d;
 
-	/* If still generating the level, measure distances from the middle */
-	struct loc pgrid = character_dungeon ? player->grid :
-		loc(c->width / 2, c->height / 2);
+	struct loc pgrid = mon_view_origin(c);
 
 	/* Seen at all */
 	bool flag = false;
@@ -318,15 +357,7 @@ void update_mon(struct monster *mon, struct chunk *c, bool full)
 	
 	/* Compute distance, or just use the current one */
 	if (full) {
-		/* Distance components */
-		int dy = ABS(pgrid.y - mon->grid.y);
-		int dx = ABS(pgrid.x - mon->grid.x);
-
-		/* Approximate distance */
-		d = (dy > dx) ? (dy + (dx >>  1)) : (dx + (dy >> 1));
-
-		/* Restrict distance */
-		if (d > 255) d = 255;
+		d = mon_view_distance(mon, pgrid);
 
 		/* Save the distance */
 		mon->cdis = d;
@@ -476,20 +507,103 @@ void update_mon(struct monster *mon, struct chunk *c, bool full)
 }
 
 /**
- * Updates all the (non-dead) monsters via update_mon().
+ * Check whether update_mon() would leave a monster as it is because it is
+ * out of sight range, was out of sight range before, hasn't been detected
+ * and wasn't visible.
+ */
+static bool monster_stays_unseen(const struct monster *mon, int old_cdis)
+{
+	return old_cdis > z_info->max_sight && mon->cdis > z_info->max_sight
+		&& !mflag_has(mon->mflag, MFLAG_MARK)
+		&& !monster_is_visible(mon) && !monster_is_in_view(mon);
+}
+
+/**
+ * Note that a monster's visibility may have changed without update_mon()
+ * being called for it, so the next update_monsters() must look at it.
+ */
+void monster_needs_update(struct chunk *c, int m_idx)
+{
+	if (c->mon_stale_all) return;
+
+	/* Too many to list, so look at them all */
+	if (c->mon_stale_count >= z_info->level_monster_max) {
+		c->mon_stale_all = true;
+		return;
+	}
+
+	if (!c->mon_stale) {
+		c->mon_stale = mem_alloc(z_info->level_monster_max *
+			sizeof(*c->mon_stale));
+	}
+	c->mon_stale[c->mon_stale_count++] = m_idx;
+}
+
+/**
+ * Note that the next update_monsters() must look at every monster.
+ */
+void monsters_need_update(struct chunk *c)
+{
+	c->mon_stale_all = true;
+}
+
+/**
+ * Updates the (non-dead) monsters via update_mon().
+ *
+ * Only monsters whose visibility could have changed are looked at: those
+ * noted with monster_needs_update(), such as the ones on grids update_view()
+ * moved into or out of view, or all of them if the player moved or the
+ * player's telepathy, see invisible, infravision or blindness changed.
+ * Monsters which are out of sight range and stay that way are skipped.
  */
 void update_monsters(bool full)
 {
+	struct loc pgrid = mon_view_origin(cave);
+	bool telepathy = player_of_has(player, OF_TELEPATHY);
+	bool see_invis = player_of_has(player, OF_SEE_INVIS);
+	bool blind = player->timed[TMD_BLIND] != 0;
+	int see_infra = player->state.see_infra;
 	int i;
 
-	/* Update each (live) monster */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
+	if (full || cave->mon_stale_all
+			|| telepathy != mon_view_basis.telepathy
+			|| see_invis != mon_view_basis.see_invis
+			|| blind != mon_view_basis.blind
+			|| see_infra != mon_view_basis.see_infra) {
+		cave->mon_stale_count = 0;
+		cave->mon_stale_all = false;
+
+		/* Update each (live) monster */
+		for (i = 1; i < cave_monster_max(cave); i++) {
+			struct monster *mon = cave_monster(cave, i);
+			int old_cdis = mon->cdis;
+
+			if (!mon->race) continue;
+			if (full) {
+				mon->cdis = mon_view_distance(mon, pgrid);
+			}
+			if (monster_stays_unseen(mon, old_cdis)) continue;
+			update_mon(mon, cave, false);
+		}
 
-		/* Update the monster if alive */
-		if (mon->race)
-			update_mon(mon, cave, full);
+		mon_view_basis.telepathy = telepathy;
+		mon_view_basis.see_invis = see_invis;
+		mon_view_basis.blind = blind;
+		mon_view_basis.see_infra = see_infra;
+	}
+
+	/*
+	 * Update the monsters which may have changed, including any noted
+	 * while updating the others
+	 */
+	for (i = 0; i < cave->mon_stale_count && !cave->mon_stale_all; i++) {
+		struct monster *mon = cave_monster(cave, cave->mon_stale[i]);
+
+		if (mon->race) {
+			update_mon(mon, cave, false);
+		}
 	}
+	cave->mon_stale_count = 0;
 }
 
 
@@ -1665,9 +1779,11 @@ bool monster_change_shape(struct monster *mon)
 
 	/* Set the race */
 	if (race) {
+		monster_energy_sync(cave, mon);
 		if (!mon->original_race) mon->original_race = mon->race;
 		mon->race = race;
 		mon->mspeed += mon->race->speed - mon->original_race->speed;
+		schedule_monster(cave, mon);
 	}
 
 	/* Emergency teleport if needed */
@@ -1696,9 +1812,11 @@ bool monster_revert_shape(struct monster *mon)
 			player->upkeep->redraw |= (PR_MONLIST);
 			square_light_spot(cave, mon->grid);
 		}
+		monster_energy_sync(cave, mon);
 		mon->mspeed += mon->original_race->speed - mon->race->speed;
 		mon->race = mon->original_race;
 		mon->original_race = NULL;
+		schedule_monster(cave, mon);
 
 		/* Emergency teleport if needed */
 		if (!monster_passes_walls(mon) &&
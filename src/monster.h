@@ -396,6 +396,8 @@ struct monster {
 
 	uint8_t mspeed;				/* Monster "speed" */
 	uint8_t energy;				/* Monster "energy" */
+	int32_t energy_turn;			/* First turn not yet added to energy */
+	int32_t act_turn;			/* Turn the monster next has enough energy to move */
 
 	uint8_t cdis;				/* Current dis from player */
 
@@ -3158,8 +3158,7 @@ void do_randart(uint32_t randart_seed, bool create_file)
 	struct artifact_set_data *randarts;
 
 	/* Prepare to use the Angband "simple" RNG. */
-	Rand_value = randart_seed;
-	Rand_quick = true;
+	rng_state_init_quick(rng_default(), randart_seed);
 
 	/* Open the log file for writing */
 	path_build(fname, sizeof(fname), ANGBAND_DIR_USER, "randart.log");
@@ -3215,5 +3214,5 @@ void do_randart(uint32_t randart_seed, bool create_file)
 	}
 
 	/* When done, resume use of the Angband "complex" RNG. */
-	Rand_quick = false;
+	rng_default()->quick = false;
 }
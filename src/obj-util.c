@@ -155,11 +155,8 @@ void flavor_init(void)
 {
 	int i, j;
 
-	/* Use the "simple" RNG */
-	Rand_quick = true;
-
-	/* Induce consistent flavors */
-	Rand_value = seed_flavor;
+	/* Use the "simple" RNG, with a seed to induce consistent flavors */
+	rng_state_init_quick(rng_default(), seed_flavor);
 
 	/* Scrub all flavors and re-parse for new players */
 	if (turn == 1) {
@@ -227,7 +224,7 @@ void flavor_init(void)
 	flavor_assign_random(TV_SCROLL);
 
 	/* Use the "complex" RNG */
-	Rand_quick = false;
+	rng_default()->quick = false;
 
 	/* Analyze every object */
 	for (i = 0; i < z_info->k_max; i++) {
@@ -40,10 +40,15 @@
 
 /**
  * A parser has a list of hooks (which are run across new lines given to
- * parser_parse()) and a list of the set of named values for the current line.
+ * parser_parse()) and the set of named values for the current line.
  * Each hook has a list of specs, which are essentially named formal parameters;
  * when we run a particular hook across a line, each spec in the hook is
  * assigned a value.
+ *
+ * Hooks are found by directive through an open-addressed hash table, and the
+ * values for a line are kept in an array in the same order as the specs of
+ * the hook that matched it, so parsing a line doesn't allocate anything once
+ * the parser has seen its longest line.
  */
 
 enum {
@@ -61,15 +66,17 @@ struct parser_spec {
 	struct parser_spec *next;
 	int type;
 	const char *name;
+	uint32_t hash;
+	int slot;
 };
 
 struct parser_value {
-	struct parser_spec spec;
+	const struct parser_spec *spec;
 	union {
 		wchar_t cval;
 		int ival;
 		unsigned int uval;
-		char *sval;
+		const char *sval;
 		random_value rval;
 	} u;
 };
@@ -78,8 +85,12 @@ struct parser_hook {
 	struct parser_hook *next;
 	enum parser_error (*func)(struct parser *p);
 	char *dir;
+	uint32_t hash;
+	int nspecs;
 	struct parser_spec *fhead;
 	struct parser_spec *ftail;
+	struct parser_spec **names;
+	size_t names_size;
 };
 
 struct parser {
@@ -88,8 +99,15 @@ struct parser {
 	unsigned int colno;
 	char errmsg[1024];
 	struct parser_hook *hooks;
-	struct parser_value *fhead;
-	struct parser_value *ftail;
+	struct parser_hook **table;
+	size_t table_size;
+	size_t table_count;
+	struct parser_hook *cur;
+	struct parser_value *vals;
+	int nvals;
+	int maxvals;
+	char *line;
+	size_t line_size;
 	void *priv;
 };
 
@@ -102,25 +120,58 @@ struct parser *parser_new(void) {
 }
 
 static struct parser_hook *findhook(struct parser *p, const char *dir) {
-	struct parser_hook *h = p->hooks;
-	while (h) {
-		if (streq(h->dir, dir))
-			break;
-		h = h->next;
+	uint32_t hash;
+	size_t i;
+
+	if (!p->table_size)
+		return NULL;
+	hash = djb2_hash(dir);
+	for (i = hash & (p->table_size - 1); p->table[i];
+			i = (i + 1) & (p->table_size - 1)) {
+		struct parser_hook *h = p->table[i];
+		if (h->hash == hash && streq(h->dir, dir))
+			return h;
 	}
-	return h;
+	return NULL;
 }
 
-static void parser_freeold(struct parser *p) {
-	struct parser_value *v;
-	while (p->fhead) {
-		int t = p->fhead->spec.type & ~PARSE_T_OPT;
-		v = (struct parser_value *)p->fhead->spec.next;
-		if (t == PARSE_T_SYM || t == PARSE_T_STR)
-			mem_free(p->fhead->u.sval);
-		mem_free(p->fhead);
-		p->fhead = v;
+/**
+ * Put a hook in the directive table, replacing any hook with the same
+ * directive.
+ */
+static void table_insert(struct parser *p, struct parser_hook *h) {
+	size_t i;
+
+	for (i = h->hash & (p->table_size - 1); p->table[i];
+			i = (i + 1) & (p->table_size - 1)) {
+		if (p->table[i]->hash == h->hash && streq(p->table[i]->dir, h->dir)) {
+			p->table[i] = h;
+			return;
+		}
+	}
+	p->table[i] = h;
+	p->table_count++;
+}
+
+/**
+ * Add a newly registered hook to the directive table, growing the table so
+ * it is never more than half full.
+ */
+static void table_add(struct parser *p, struct parser_hook *h) {
+	if (2 * (p->table_count + 1) > p->table_size) {
+		struct parser_hook **old = p->table;
+		size_t old_size = p->table_size, i;
+
+		p->table_size = old_size ? 2 * old_size : 32;
+		p->table = mem_zalloc(p->table_size * sizeof(*p->table));
+		p->table_count = 0;
+		for (i = 0; i < old_size; i++) {
+			if (old[i])
+				table_insert(p, old[i]);
+		}
+		mem_free(old);
 	}
+	table_insert(p, h);
 }
 
 static bool parse_random(const char *str, random_value *bonus) {
@@ -225,16 +276,15 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	struct parser_spec *s;
 	struct parser_value *v;
 	char *sp = NULL;
+	size_t len;
 
 	assert(p);
 	assert(line);
 
-	parser_freeold(p);
-
 	p->lineno++;
 	p->colno = 1;
-	p->fhead = NULL;
-	p->ftail = NULL;
+	p->cur = NULL;
+	p->nvals = 0;
 
 	/* Ignore empty lines and comments. */
 	while (*line && (isspace((unsigned char)*line)))
@@ -242,11 +292,18 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!*line || *line == '#')
 		return PARSE_ERROR_NONE;
 
-	cline = string_make(line);
+	/* Work on a copy of the line, which the string values point into */
+	len = strlen(line) + 1;
+	if (len > p->line_size) {
+		mem_free(p->line);
+		p->line_size = MAX(len, 2 * p->line_size);
+		p->line = mem_alloc(p->line_size);
+	}
+	cline = p->line;
+	memcpy(cline, line, len);
 
 	tok = strtok(cline, ":");
 	if (!tok) {
-		mem_free(cline);
 		p->error = PARSE_ERROR_MISSING_FIELD;
 		return PARSE_ERROR_MISSING_FIELD;
 	}
@@ -255,9 +312,9 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!h) {
 		my_strcpy(p->errmsg, tok, sizeof(p->errmsg));
 		p->error = PARSE_ERROR_UNDEFINED_DIRECTIVE;
-		mem_free(cline);
 		return PARSE_ERROR_UNDEFINED_DIRECTIVE;
 	}
+	p->cur = h;
 
 	/* There's a little bit of trickiness here to account for optional
 	 * types. The optional flag has a bit assigned to it in the spec's type
@@ -284,7 +341,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 						my_strcpy(p->errmsg, s->name,
 							sizeof(p->errmsg));
 						p->error = PARSE_ERROR_FIELD_TOO_LONG;
-						mem_free(cline);
 						return PARSE_ERROR_FIELD_TOO_LONG;
 					}
 				}
@@ -297,25 +353,20 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			if (!(s->type & PARSE_T_OPT)) {
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_MISSING_FIELD;
-				mem_free(cline);
 				return PARSE_ERROR_MISSING_FIELD;
 			}
 			break;
 		}
 
-		/* Allocate a value node. */
-		v = mem_alloc(sizeof *v);
-		v->spec.next = NULL;
-		v->spec.type = s->type;
-		v->spec.name = s->name;
+		/* Take the next value slot. */
+		v = &p->vals[p->nvals];
+		v->spec = s;
 
 		/* Parse out its value. */
 		if (t == PARSE_T_INT) {
 			char *z = NULL;
 			v->u.ival = strtol(tok, &z, 0);
 			if (z == tok) {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -324,8 +375,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			char *z = NULL;
 			v->u.uval = strtoul(tok, &z, 0);
 			if (z == tok || *tok == '-') {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -333,27 +382,18 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		} else if (t == PARSE_T_CHAR) {
 			text_mbstowcs(&v->u.cval, tok, 1);
 		} else if (t == PARSE_T_SYM || t == PARSE_T_STR) {
-			v->u.sval = string_make(tok);
+			v->u.sval = tok;
 		} else if (t == PARSE_T_RAND) {
 			if (!parse_random(tok, &v->u.rval)) {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_RANDOM;
 				return PARSE_ERROR_NOT_RANDOM;
 			}
 		}
 
-		/* Link it into the value list. */
-		if (!p->fhead)
-			p->fhead = v;
-		else
-			p->ftail->spec.next = &v->spec;
-		p->ftail = v;
+		p->nvals++;
 	}
 
-	mem_free(cline);
-
 	p->error = h->func(p);
 	return p->error;
 }
@@ -404,6 +444,7 @@ static void clean_specs(struct parser_hook *h) {
 		mem_free((void*)s->name);
 		mem_free(s);
 	}
+	mem_free(h->names);
 }
 
 /**
@@ -411,13 +452,15 @@ static void clean_specs(struct parser_hook *h) {
  */
 void parser_destroy(struct parser *p) {
 	struct parser_hook *h;
-	parser_freeold(p);
 	while (p->hooks) {
 		h = p->hooks->next;
 		clean_specs(p->hooks);
 		mem_free(p->hooks);
 		p->hooks = h;
 	}
+	mem_free(p->table);
+	mem_free(p->vals);
+	mem_free(p->line);
 	mem_free(p);
 }
 
@@ -434,8 +477,12 @@ static errr parse_specs(struct parser_hook *h, char *fmt) {
 	if (!name)
 		return -EINVAL;
 	h->dir = string_make(name);
+	h->hash = djb2_hash(name);
+	h->nspecs = 0;
 	h->fhead = NULL;
 	h->ftail = NULL;
+	h->names = NULL;
+	h->names_size = 0;
 	while (name) {
 		/* Lack of a type is legal; that means we're at the end of the line. */
 		stype = strtok(NULL, " ");
@@ -470,17 +517,48 @@ static errr parse_specs(struct parser_hook *h, char *fmt) {
 		s = mem_alloc(sizeof *s);
 		s->type = type;
 		s->name = string_make(name);
+		s->hash = djb2_hash(name);
+		s->slot = h->nspecs;
 		s->next = NULL;
 		if (h->fhead)
 			h->ftail->next = s;
 		else
 			h->fhead = s;
 		h->ftail = s;
+		h->nspecs++;
 	}
 
 	return 0;
 }
 
+/**
+ * Builds the table a hook's values are looked up in by name.  A value is
+ * parsed into the slot matching its spec's position, so the table resolves
+ * each name straight to that slot; where a name is repeated the first spec
+ * wins, as it always has.
+ */
+static void index_specs(struct parser_hook *h) {
+	struct parser_spec *s;
+	size_t i;
+
+	if (!h->nspecs)
+		return;
+	h->names_size = 4;
+	while (h->names_size < 2 * (size_t)h->nspecs)
+		h->names_size *= 2;
+	h->names = mem_zalloc(h->names_size * sizeof(*h->names));
+	for (s = h->fhead; s; s = s->next) {
+		for (i = s->hash & (h->names_size - 1); h->names[i];
+				i = (i + 1) & (h->names_size - 1)) {
+			if (h->names[i]->hash == s->hash
+					&& streq(h->names[i]->name, s->name))
+				break;
+		}
+		if (!h->names[i])
+			h->names[i] = s;
+	}
+}
+
 /**
  * Registers a parser hook.
  *
@@ -515,7 +593,13 @@ errr parser_reg(struct parser *p, const char *fmt,
 		return r;
 	}
 
+	index_specs(h);
 	p->hooks = h;
+	table_add(p, h);
+	if (h->nspecs > p->maxvals) {
+		p->maxvals = h->nspecs;
+		p->vals = mem_realloc(p->vals, p->maxvals * sizeof(*p->vals));
+	}
 	mem_free(cfmt);
 	return 0;
 }
@@ -527,27 +611,40 @@ enum parser_error ignored(struct parser *p) {
 	return PARSE_ERROR_NONE;
 }
 
+/**
+ * Finds the value named `name` on the current line, or NULL if the line's
+ * directive has no such field or the line stopped short of it.
+ */
+static struct parser_value *findval(struct parser *p, const char *name) {
+	const struct parser_hook *h = p->cur;
+	uint32_t hash;
+	size_t i;
+
+	if (!h || !h->names_size)
+		return NULL;
+	hash = djb2_hash(name);
+	for (i = hash & (h->names_size - 1); h->names[i];
+			i = (i + 1) & (h->names_size - 1)) {
+		const struct parser_spec *s = h->names[i];
+		if (s->hash == hash && streq(s->name, name))
+			return (s->slot < p->nvals) ? &p->vals[s->slot] : NULL;
+	}
+	return NULL;
+}
+
 /**
  * Returns whether the parser has a value named `name`.
  *
  * Used to test for presence of optional values.
  */
 bool parser_hasval(struct parser *p, const char *name) {
-	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next) {
-		if (streq(v->spec.name, name))
-			return true;
-	}
-	return false;
+	return findval(p, name) != NULL;
 }
 
 static struct parser_value *parser_getval(struct parser *p, const char *name) {
-	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next) {
-		if (streq(v->spec.name, name)) {
-			return v;
-		}
-	}
+	struct parser_value *v = findval(p, name);
+	if (v)
+		return v;
 	quit_fmt("parser_getval error: name is %s\n", name);
 	return 0; /* Needed to avoid Windows compiler warning */
 }
@@ -557,7 +654,7 @@ static struct parser_value *parser_getval(struct parser *p, const char *name) {
  */
 const char *parser_getsym(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_SYM);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_SYM);
 	return v->u.sval;
 }
 
@@ -566,7 +663,7 @@ const char *parser_getsym(struct parser *p, const char *name) {
  */
 int parser_getint(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_INT);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_INT);
 	return v->u.ival;
 }
 
@@ -575,7 +672,7 @@ int parser_getint(struct parser *p, const char *name) {
  */
 unsigned int parser_getuint(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_UINT);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_UINT);
 	return v->u.uval;
 }
 
@@ -584,7 +681,7 @@ unsigned int parser_getuint(struct parser *p, const char *name) {
  */
 const char *parser_getstr(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_STR);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_STR);
 	return v->u.sval;
 }
 
@@ -593,7 +690,7 @@ const char *parser_getstr(struct parser *p, const char *name) {
  */
 struct random parser_getrand(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_RAND);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_RAND);
 	return v->u.rval;
 }
 
@@ -602,7 +699,7 @@ struct random parser_getrand(struct parser *p, const char *name) {
  */
 wchar_t parser_getchar(struct parser *p, const char *name) {
 	struct parser_value *v = parser_getval(p, name);
-	assert((v->spec.type & ~PARSE_T_OPT) == PARSE_T_CHAR);
+	assert((v->spec->type & ~PARSE_T_OPT) == PARSE_T_CHAR);
 	return v->u.cval;
 }
 
@@ -2542,6 +2542,12 @@ void notice_stuff(struct player *p)
 	if (p->upkeep->notice & PN_IGNORE) {
 		p->upkeep->notice &= ~(PN_IGNORE);
 		ignore_drop(p);
+
+		/* Mimics of ignored items can't be seen */
+		if (cave) {
+			monsters_need_update(cave);
+			p->upkeep->update |= PU_MONSTERS;
+		}
 	}
 
 	/* Combine the pack */
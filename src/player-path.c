@@ -45,8 +45,14 @@
 struct pfdistances {
 	/** This is height * width entries to store the distances. */
 	int *buffer;
-	/** This is height pointers to the start of each row in buffer. */
-	int **rows;
+	/**
+	 * This is height * width generation stamps.  An entry in buffer
+	 * is only valid if its stamp matches stamp; otherwise the grid has
+	 * not been reached.  That way clearing the distances for reuse is
+	 * just incrementing stamp.
+	 */
+	uint32_t *stamps;
+	uint32_t stamp;
 	/** This is the grid from which the distances are computed. */
 	struct loc start;
 	/**
@@ -54,20 +60,42 @@ struct pfdistances {
 	 * view of the cave.
 	 */
 	int height, width;
+	/** This is true if the storage belongs to the workspace. */
+	bool borrowed;
 };
 
 /**
  * This is a patched version (non-overlapping squares of patch_size by
  * patch_size; patch size is a power of 2) of pfdistances for use in
- * find_path().
+ * find_path().  Each patch is initialized when first touched; a patch whose
+ * stamp doesn't match stamp has not been touched since the last clear.
  */
 struct pfdistances_patched {
-	int ***patches;
+	int *patches;
+	uint32_t *stamps;
+	uint32_t stamp;
 	int patch_size, patch_shift, patch_mask;
 	int npatchy, npatchx;
 	int height, width;
 };
 
+/**
+ * This is the storage kept from one pathfinding call to the next so that
+ * travel, exploration and click-to-move don't allocate and initialize
+ * arrays the size of the cave every time.  It is sized for the most
+ * recently seen cave and resized when the cave's dimensions change.
+ */
+static struct {
+	/** Distances lent out by prepare_pfdistances() */
+	struct pfdistances distances;
+	bool distances_lent;
+	/** Feasible grids for prepare_pfdistances() */
+	struct queue *pending;
+	/** Distances and feasible paths for find_path() */
+	struct pfdistances_patched patched;
+	struct priority_queue *ppending;
+} pf_workspace;
+
 /**
  * Scale factor for distances in an array of path distances; used to allow for
  * fractional turns; must be positive
@@ -285,6 +313,70 @@ static int compute_rubble_penalty(struct player *p)
 	return convert_turn_penalty(penalty, p);
 }
 
+/**
+ * Move on to a new generation of distances, which leaves every grid unset.
+ */
+static void clear_pfdistances(struct pfdistances *a)
+{
+	++a->stamp;
+	if (!a->stamp) {
+		/* Wrapped around, so the old stamps have to be wiped. */
+		memset(a->stamps, 0, a->height * a->width * sizeof(*a->stamps));
+		a->stamp = 1;
+	}
+}
+
+/**
+ * Size a distance array for the given dimensions, reusing its storage when
+ * the dimensions haven't changed.
+ */
+static void size_pfdistances(struct pfdistances *a, int height, int width)
+{
+	if (a->buffer && a->height == height && a->width == width) {
+		clear_pfdistances(a);
+		return;
+	}
+	mem_free(a->buffer);
+	mem_free(a->stamps);
+	a->buffer = mem_alloc(height * width * sizeof(*a->buffer));
+	a->stamps = mem_zalloc(height * width * sizeof(*a->stamps));
+	a->stamp = 1;
+	a->height = height;
+	a->width = width;
+}
+
+/**
+ * Get the distance stored for a grid; grids that have not been set are
+ * unreachable.
+ */
+static int get_pfdistance(const struct pfdistances *a, struct loc grid)
+{
+	int i = grid_to_i(grid, a->width);
+
+	return (a->stamps[i] == a->stamp) ? a->buffer[i] : -1;
+}
+
+/**
+ * Get the distance for a grid while computing distances, setting it up
+ * first if this is the first time the grid has been looked at:  the outer
+ * edge and grids that can not be traversed are unreachable (negative
+ * distance); other grids start with the assumption of the maximum possible
+ * distance.
+ */
+static int *fetch_pfdistance(struct pfdistances *a, struct player *p,
+		struct loc grid, bool only_known, bool forbid_traps)
+{
+	int i = grid_to_i(grid, a->width);
+
+	if (a->stamps[i] != a->stamp) {
+		a->stamps[i] = a->stamp;
+		a->buffer[i] = (square_in_bounds_fully(p->cave, grid)
+			&& is_valid_pf(p, grid, only_known, forbid_traps)) ?
+			INT_MAX : -1;
+	}
+	return a->buffer + i;
+}
+
 /**
  * Compute the distances, in movement turns, from a given location to all
  * locations in the cave.
@@ -316,43 +408,25 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 		return NULL;
 	}
 
-	result = mem_alloc(sizeof(*result));
-	result->buffer = mem_alloc(p->cave->height * p->cave->width
-		* sizeof(*result->buffer));
-	result->rows = mem_alloc(p->cave->height * sizeof(*result->rows));
-	result->start = start;
-	result->height = p->cave->height;
-	result->width = p->cave->width;
-
-	/* Set up the row pointers. */
-	for (grid.y = 0; grid.y < result->height; ++grid.y) {
-		result->rows[grid.y] = result->buffer + grid.y * result->width;
-	}
-
 	/*
-	 * Mark the outer edge as unreachable (negative distance).  Keeps
-	 * things in bounds without extra checks later.  Inner grids may
-	 * be unreachable; otherwise they start with the assumption of
-	 * the maximum possible distance.
+	 * Use the workspace's storage unless it is already in use.  The
+	 * distances are filled in lazily by fetch_pfdistance(), so only
+	 * the grids the search touches are initialized.  The outer edge is
+	 * always unreachable, which keeps things in bounds without extra
+	 * checks later.
 	 */
-	grid.y = 0;
-	for (grid.x = 0; grid.x < result->width; ++grid.x) {
-		result->rows[0][grid.x] = -1;
-	}
-	for (grid.y = 1; grid.y < result->height - 1; ++grid.y) {
-		result->rows[grid.y][0] = -1;
-		for (grid.x = 1; grid.x < result->width - 1; ++grid.x) {
-			result->rows[grid.y][grid.x] = (is_valid_pf(p, grid,
-				only_known, forbid_traps)) ?  INT_MAX : -1;
-		}
-		result->rows[grid.y][result->width - 1] = -1;
-	}
-	for (grid.x = 0; grid.x < result->width; ++grid.x) {
-		result->rows[result->height - 1][grid.x] = -1;
+	if (!pf_workspace.distances_lent) {
+		result = &pf_workspace.distances;
+		pf_workspace.distances_lent = true;
+		result->borrowed = true;
+	} else {
+		result = mem_zalloc(sizeof(*result));
 	}
+	size_pfdistances(result, p->cave->height, p->cave->width);
+	result->start = start;
 
 	/* The distance to the starting point is zero. */
-	result->rows[result->start.y][result->start.x] = 0;
+	*fetch_pfdistance(result, p, start, only_known, forbid_traps) = 0;
 
 	/* Precompute quantities to penalize traversing some terrain. */
 	unlocked_penalty = compute_unlocked_penalty(p);
@@ -365,7 +439,12 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 	 * at how many feasible points may be present at once.  Will try to
 	 * resize if that turns out to be inadequate.
 	 */
-	pending = q_new(2 * (result->width + result->height - 2));
+	if (!pf_workspace.pending) {
+		pf_workspace.pending = q_new(2 * (result->width
+			+ result->height - 2));
+	}
+	pending = pf_workspace.pending;
+	assert(q_len(pending) == 0);
 	/* The starting point is the point to consider. */
 	q_push_int(pending, grid_to_i(result->start, result->width));
 
@@ -377,7 +456,7 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 		int cur_distance, i;
 
 		i_to_grid(q_pop_int(pending), result->width, &grid);
-		cur_distance = result->rows[grid.y][grid.x];
+		cur_distance = get_pfdistance(result, grid);
 		/*
 		 * Move one grid, i.e. PF_SCL, to get to the next grid.  If
 		 * that exceeds the maximum distance possible, have no
@@ -391,13 +470,15 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 		/* Try the neighbors. */
 		for (i = 0; i < 8; ++i) {
 			struct loc next = loc_sum(grid, ddgrid_ddd[i]);
+			int *next_distance = fetch_pfdistance(result, p, next,
+				only_known, forbid_traps);
 
 			/*
 			 * Skip points that are unreachable or which have
 			 * already been reached by a path which is at least
 			 * as short as the path under consideration.
 			 */
-			if (result->rows[next.y][next.x] <= cur_distance) {
+			if (*next_distance <= cur_distance) {
 				continue;
 			}
 			/*
@@ -406,7 +487,7 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 			 */
 			if (!square_isknown(p->cave, next)
 					|| square_ispassable(p->cave, next)) {
-				result->rows[next.y][next.x] = cur_distance;
+				*next_distance = cur_distance;
 			} else {
 				int penalty, penalized_distance;
 
@@ -432,8 +513,7 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 					continue;
 				}
 				penalized_distance = cur_distance + penalty;
-				if (result->rows[next.y][next.x]
-						<= penalized_distance) {
+				if (*next_distance <= penalized_distance) {
 					/*
 					 * Already have a path there that is
 					 * shorter or the same length.  Do not
@@ -441,8 +521,7 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 					 */
 					continue;
 				}
-				result->rows[next.y][next.x] =
-					penalized_distance;
+				*next_distance = penalized_distance;
 			}
 
 			assert(q_len(pending) <= q_size(pending)
@@ -462,8 +541,6 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 		}
 	} while (q_len(pending) > 0);
 
-	q_free(pending);
-
 	return result;
 }
 
@@ -478,14 +555,18 @@ struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
  */
 int pfdistances_to_turncount(const struct pfdistances *a, struct loc grid)
 {
+	int distance;
+
 	if (!a || grid.y < 0 || grid.y >= a->height || grid.x < 0 ||
-			grid.x >= a->width || a->rows[grid.y][grid.x] < 0
-			|| a->rows[grid.y][grid.x] == INT_MAX) {
+			grid.x >= a->width) {
+		return -1;
+	}
+	distance = get_pfdistance(a, grid);
+	if (distance < 0 || distance == INT_MAX) {
 		return -1;
 	}
-	return a->rows[grid.y][grid.x] / PF_SCL
-		+ (((a->rows[grid.y][grid.x] % PF_SCL) >= (PF_SCL + 1) / 2)
-		? 1 : 0);
+	return distance / PF_SCL
+		+ (((distance % PF_SCL) >= (PF_SCL + 1) / 2) ? 1 : 0);
 }
 
 /**
@@ -510,7 +591,7 @@ int pfdistances_to_path(const struct pfdistances *a, struct loc grid,
 	int allocated, length;
 
 	if (!a || grid.y < 0 || grid.y >= a->height || grid.x < 0 ||
-			grid.x >= a->width || a->rows[grid.y][grid.x] < 0) {
+			grid.x >= a->width || get_pfdistance(a, grid) < 0) {
 		if (step_dirs) {
 			*step_dirs = NULL;
 		}
@@ -528,7 +609,7 @@ int pfdistances_to_path(const struct pfdistances *a, struct loc grid,
 	length = 0;
 	steps = mem_alloc(allocated * sizeof(*steps));
 	while (!loc_eq(grid, a->start)) {
-		int k, best_k = -1, best_distance = a->rows[grid.y][grid.x];
+		int k, best_k = -1, best_distance = get_pfdistance(a, grid);
 
 		/* Find the next step. */
 		for (k = 0; k < 8; ++k) {
@@ -541,7 +622,7 @@ int pfdistances_to_path(const struct pfdistances *a, struct loc grid,
 			 */
 			assert(next.y >= 0 && next.y < a->height
 				&& next.x >= 0 && next.x < a->width);
-			try_distance = a->rows[next.y][next.x];
+			try_distance = get_pfdistance(a, next);
 			if (try_distance >= 0 && best_distance > try_distance) {
 				best_distance = try_distance;
 				best_k = k;
@@ -594,19 +675,50 @@ int pfdistances_to_path(const struct pfdistances *a, struct loc grid,
  */
 void release_pfdistances(struct pfdistances *a)
 {
-	if (a) {
+	if (!a) return;
+	if (a->borrowed) {
+		/* Hand the storage back to the workspace for the next call. */
+		assert(a == &pf_workspace.distances);
+		pf_workspace.distances_lent = false;
+	} else {
 		mem_free(a->buffer);
-		mem_free(a->rows);
+		mem_free(a->stamps);
 		mem_free(a);
 	}
 }
 
-static void initialize_patched_distances(struct pfdistances_patched *distances,
+static void clear_patched_distances(struct pfdistances_patched *distances)
+{
+	assert(distances->patches && distances->npatchy > 0
+		&& distances->npatchx > 0);
+	++distances->stamp;
+	if (!distances->stamp) {
+		/* Wrapped around, so the old stamps have to be wiped. */
+		memset(distances->stamps, 0, distances->npatchy
+			* distances->npatchx * sizeof(*distances->stamps));
+		distances->stamp = 1;
+	}
+}
+
+/**
+ * Get the patched distances ready for a new search:  size them for the cave,
+ * reusing the storage when the dimensions haven't changed, and mark every
+ * patch as not yet initialized.
+ */
+static void prepare_patched_distances(struct pfdistances_patched *distances,
 		int height, int width)
 {
-	int i;
+	int npatch;
 
 	assert(height > 0 && width > 0);
+	if (distances->patches && distances->height == height
+			&& distances->width == width) {
+		clear_patched_distances(distances);
+		return;
+	}
+
+	mem_free(distances->patches);
+	mem_free(distances->stamps);
 	distances->patch_shift = 4;
 	distances->patch_size = 1 << distances->patch_shift;
 	distances->patch_mask = distances->patch_size - 1;
@@ -620,47 +732,53 @@ static void initialize_patched_distances(struct pfdistances_patched *distances,
 	}
 	distances->height = height;
 	distances->width = width;
-	distances->patches = mem_alloc(distances->npatchy
-		* sizeof(*distances->patches));
-	for (i = 0; i < distances->npatchy; ++i) {
-		distances->patches[i] = mem_zalloc(distances->npatchx
-			* sizeof(**distances->patches));
-	}
+	npatch = distances->npatchy * distances->npatchx;
+	distances->patches = mem_alloc(npatch * distances->patch_size
+		* distances->patch_size * sizeof(*distances->patches));
+	distances->stamps = mem_zalloc(npatch * sizeof(*distances->stamps));
+	distances->stamp = 1;
 }
 
 static void release_patched_distances(struct pfdistances_patched *distances)
 {
-	int i;
-
-	assert(distances->patches && distances->npatchy > 0
-		&& distances->npatchx > 0);
-	for (i = 0; i < distances->npatchy; ++i) {
-		int j;
-
-		assert(distances->patches[i]);
-		for (j = 0; j < distances->npatchx; ++j) {
-			mem_free(distances->patches[i][j]);
-		}
-		mem_free(distances->patches[i]);
-	}
 	mem_free(distances->patches);
+	mem_free(distances->stamps);
+	memset(distances, 0, sizeof(*distances));
 }
 
-static void clear_patched_distances(struct pfdistances_patched *distances)
+/**
+ * Return the index of the patch containing a grid.
+ */
+static int get_patch_index(const struct pfdistances_patched *distances,
+		struct loc grid)
 {
-	int i;
+	int patchy, patchx;
 
-	assert(distances->patches && distances->npatchy > 0
-		&& distances->npatchx > 0);
-	for (i = 0; i < distances->npatchy; ++i) {
-		int j;
+	assert(grid.y >= 0 && grid.y < distances->height
+		&& grid.x >= 0 && grid.x < distances->width);
+	patchy = grid.y >> distances->patch_shift;
+	assert(patchy >= 0 && patchy < distances->npatchy);
+	patchx = grid.x >> distances->patch_shift;
+	assert(patchx >= 0 && patchx < distances->npatchx);
+	return patchy * distances->npatchx + patchx;
+}
 
-		assert(distances->patches[i]);
-		for (j = 0; j < distances->npatchx; ++j) {
-			mem_free(distances->patches[i][j]);
-			distances->patches[i][j] = NULL;
-		}
-	}
+/**
+ * Return the storage for a grid's distance.  The patch containing it must
+ * have been initialized.
+ */
+static int *get_patched_slot(const struct pfdistances_patched *distances,
+		struct loc grid)
+{
+	int patch = get_patch_index(distances, grid), patchi;
+
+	assert(distances->stamps[patch] == distances->stamp);
+	patchi = ((grid.y & distances->patch_mask) << distances->patch_shift)
+		+ (grid.x & distances->patch_mask);
+	assert(patchi >= 0 && patchi < distances->patch_size
+		* distances->patch_size);
+	return distances->patches + (patch << (2 * distances->patch_shift))
+		+ patchi;
 }
 
 static void initialize_patch(struct pfdistances_patched *distances,
@@ -668,22 +786,16 @@ static void initialize_patch(struct pfdistances_patched *distances,
 		bool forbid_traps)
 {
 	int *block;
-	int patchy, patchx, i;
+	int patch, i;
 	struct loc corner, cursor;
 
-	assert(grid.y >= 0 && grid.y < distances->height
-		&& grid.x >= 0 && grid.x < distances->width);
-	patchy = grid.y >> distances->patch_shift;
-	assert(patchy >= 0 && patchy < distances->npatchy);
-	patchx = grid.x >> distances->patch_shift;
-	assert(patchx >= 0 && patchx < distances->npatchx);
-	assert(!distances->patches[patchy][patchx]);
-	block = mem_alloc(distances->patch_size * distances->patch_size
-		* sizeof(*block));
-	distances->patches[patchy][patchx] = block;
+	patch = get_patch_index(distances, grid);
+	assert(distances->stamps[patch] != distances->stamp);
+	distances->stamps[patch] = distances->stamp;
+	block = distances->patches + (patch << (2 * distances->patch_shift));
 
-	corner.y = patchy << distances->patch_shift;
-	corner.x = patchx << distances->patch_shift;
+	corner.y = (grid.y >> distances->patch_shift) << distances->patch_shift;
+	corner.x = (grid.x >> distances->patch_shift) << distances->patch_shift;
 	for (cursor.y = corner.y, i = 0; cursor.y < corner.y
 			+ distances->patch_size; ++cursor.y) {
 		for (cursor.x = corner.x; cursor.x < corner.x
@@ -698,53 +810,20 @@ static void initialize_patch(struct pfdistances_patched *distances,
 static bool has_patched_distance(const struct pfdistances_patched *distances,
 		struct loc grid)
 {
-	int patchy, patchx;
-
-	assert(grid.y >= 0 && grid.y < distances->height
-		&& grid.x >= 0 && grid.x < distances->width);
-	patchy = grid.y >> distances->patch_shift;
-	assert(patchy >= 0 && patchy < distances->npatchy);
-	patchx = grid.x >> distances->patch_shift;
-	assert(patchx >= 0 && patchx < distances->npatchx);
-	return distances->patches[patchy][patchx];
+	return distances->stamps[get_patch_index(distances, grid)]
+		== distances->stamp;
 }
 
 static int get_patched_distance(const struct pfdistances_patched *distances,
 		struct loc grid)
 {
-	int patchy, patchx, patchi;
-
-	assert(grid.y >= 0 && grid.y < distances->height
-		&& grid.x >= 0 && grid.x < distances->width);
-	patchy = grid.y >> distances->patch_shift;
-	assert(patchy >= 0 && patchy < distances->npatchy);
-	patchx = grid.x >> distances->patch_shift;
-	assert(patchx >= 0 && patchx < distances->npatchx);
-	assert(distances->patches[patchy][patchx]);
-	patchi = ((grid.y & distances->patch_mask) << distances->patch_shift)
-		+ (grid.x & distances->patch_mask);
-	assert(patchi >= 0 && patchi < distances->patch_size
-		* distances->patch_size);
-	return distances->patches[patchy][patchx][patchi];
+	return *get_patched_slot(distances, grid);
 }
 
 static void set_patched_distance(struct pfdistances_patched *distances,
 		struct loc grid, int distance)
 {
-	int patchy, patchx, patchi;
-
-	assert(grid.y >= 0 && grid.y < distances->height
-		&& grid.x >= 0 && grid.x < distances->width);
-	patchy = grid.y >> distances->patch_shift;
-	assert(patchy >= 0 && patchy < distances->npatchy);
-	patchx = grid.x >> distances->patch_shift;
-	assert(patchx >= 0 && patchx < distances->npatchx);
-	assert(distances->patches[patchy][patchx]);
-	patchi = ((grid.y & distances->patch_mask) << distances->patch_shift)
-		+ (grid.x & distances->patch_mask);
-	assert(patchi >= 0 && patchi < distances->patch_size
-		* distances->patch_size);
-	distances->patches[patchy][patchx][patchi] = distance;
+	*get_patched_slot(distances, grid) = distance;
 }
 
 static int patched_distances_to_path(const struct pfdistances_patched
@@ -1043,6 +1122,806 @@ int path_nearest_unknown(struct player *p, struct loc start,
 	}
 }
 
+/**
+ * ------------------------------------------------------------------------
+ * Hierarchical pathfinding over the player's map
+ * ------------------------------------------------------------------------ */
+/**
+ * For long trips, find_path() plans over a coarse graph rather than grid by
+ * grid.  The player's map is cut into clusters of PG_CLUSTER by PG_CLUSTER
+ * grids.  Each run of grids where the border between two clusters can be
+ * crossed contributes one crossing (from its middle) or two (from its ends if
+ * the run is long), and the grids on either side of a crossing are the nodes
+ * of the graph.  Nodes in the same cluster are joined by the cost of the best
+ * path that stays inside the cluster.  A trip is then a search over those
+ * nodes, and only the legs it uses are expanded back into grid steps.  The
+ * result can be a little longer than the best path over the grids.
+ *
+ * The graph only covers remembered grids without known visible traps.  It
+ * lives with the map and is brought up to date, one cluster at a time, when
+ * the map's terrain stamp says that something was learned or forgotten.
+ */
+#define PG_SHIFT 4
+#define PG_CLUSTER (1 << PG_SHIFT)
+#define PG_AREA (PG_CLUSTER * PG_CLUSTER)
+
+/**
+ * Border runs at least this long get a crossing at each end
+ */
+#define PG_LONG_RUN 6
+
+/**
+ * Trips shorter than this, as a Chebyshev distance, are left to find_path()
+ */
+#define PG_MIN_TRIP (2 * PG_CLUSTER)
+
+/**
+ * Grids that cost more than this to enter are left to find_path(); this
+ * keeps the sums of costs over the whole map well away from overflowing
+ */
+#define PG_MAX_ENTER 65536
+
+/**
+ * Marks a remembered grid with a trap in path_cluster's known
+ */
+#define PG_TRAPPED 0x8000
+
+/**
+ * How the planner sees a grid:  the cost of entering it depends on this
+ */
+enum {
+	PG_BLOCKED = 0,
+	PG_OPEN,
+	PG_DOOR,
+	PG_LOCKED,
+	PG_RUBBLE,
+	PG_CLASS_MAX
+};
+
+struct path_crossing {
+	struct loc from, to;
+};
+
+struct path_cluster {
+	struct loc tl;			/**< Top left grid */
+	int height, width;		/**< Smaller at the map's edges */
+	uint16_t known[PG_AREA];	/**< Remembered terrain and traps */
+	uint8_t classes[PG_AREA];	/**< What the costs were computed for */
+	int16_t node_at[PG_AREA];	/**< Node at each grid, or -1 */
+	bool stale;			/**< Costs need recomputing */
+	int nnodes;
+	struct loc *nodes;
+	int *costs;			/**< nnodes by nnodes, -1 if no path */
+	int base;			/**< Graph index of the first node */
+};
+
+struct path_graph {
+	int height, width;		/**< Size of the map */
+	int cheight, cwidth;		/**< Size in clusters */
+	bool checked;			/**< Classes match the map at stamp */
+	uint32_t stamp;
+	int enter[PG_CLASS_MAX];	/**< Cost to enter, -1 if impassable */
+	bool trapsafe;
+	struct path_cluster *clusters;
+
+	/* Crossings, rebuilt with the node numbering */
+	struct path_crossing *crossings;
+	int ncrossings, crossings_alloc;
+
+	/* Nodes of the whole graph; links of node n are from link_start[n]
+	 * to link_start[n + 1] - 1 */
+	int nnodes, nodes_alloc;
+	int *owner;
+	int *link_start;
+	int *link_to;
+	int *link_cost;
+	int links_alloc;
+
+	/* Storage for searches */
+	int *dist;
+	int *from;
+	uint32_t *seen;
+	uint32_t *done;
+	uint32_t search;
+	int *exit_cost;
+	int exit_alloc;
+	struct priority_queue *open;
+	int local_dist[PG_AREA];
+	int local_from[PG_AREA];
+	bool local_done[PG_AREA];
+};
+
+/**
+ * Classify a grid of the player's map for the planner
+ */
+static uint8_t pg_classify(struct player *p, struct loc grid)
+{
+	if (!is_valid_pf(p, grid, true, true)) return PG_BLOCKED;
+	if (square_ispassable(p->cave, grid)) return PG_OPEN;
+	if (square_iscloseddoor(p->cave, grid)) {
+		return square_islockeddoor(p->cave, grid) ? PG_LOCKED : PG_DOOR;
+	}
+	if (square_isrubble(p->cave, grid)) return PG_RUBBLE;
+	return PG_BLOCKED;
+}
+
+static struct path_cluster *pg_cluster(struct path_graph *g, struct loc grid)
+{
+	return &g->clusters[(grid.y >> PG_SHIFT) * g->cwidth
+		+ (grid.x >> PG_SHIFT)];
+}
+
+static int pg_local(const struct path_cluster *cl, struct loc grid)
+{
+	return (grid.y - cl->tl.y) * PG_CLUSTER + grid.x - cl->tl.x;
+}
+
+static struct loc pg_grid(const struct path_cluster *cl, int i)
+{
+	return loc(cl->tl.x + i % PG_CLUSTER, cl->tl.y + i / PG_CLUSTER);
+}
+
+/**
+ * Cost of entering a grid, or -1 if the planner won't use it
+ */
+static int pg_enter(const struct path_graph *g, struct loc grid)
+{
+	const struct path_cluster *cl =
+		&g->clusters[(grid.y >> PG_SHIFT) * g->cwidth
+		+ (grid.x >> PG_SHIFT)];
+
+	return g->enter[cl->classes[pg_local(cl, grid)]];
+}
+
+static void pg_push(struct priority_queue *q, int priority, int payload)
+{
+	if (qp_len(q) == qp_size(q)) {
+		(void) qp_resize(q, 2 * qp_size(q), NULL);
+	}
+	qp_push_int(q, priority, payload);
+}
+
+/**
+ * Search from one grid of a cluster without leaving the cluster, leaving the
+ * costs in local_dist (-1 where not reached) and the previous grid of each
+ * path in local_from.
+ *
+ * \param g is the graph.
+ * \param cl is the cluster.
+ * \param start is the grid to search from.
+ * \param stop is the local index at which to stop, or -1 to search the whole
+ * cluster.  When there is one, the search heads for it.
+ * \param backward is true to compute the cost of getting from each grid to
+ * start rather than from start to each grid.
+ */
+static void pg_local_search(struct path_graph *g,
+		const struct path_cluster *cl, struct loc start, int stop,
+		bool backward)
+{
+	struct loc target = start;
+	int i;
+
+	for (i = 0; i < PG_AREA; i++) {
+		g->local_dist[i] = -1;
+		g->local_done[i] = false;
+	}
+	qp_flush(g->open, NULL);
+	if (stop >= 0) {
+		target = pg_grid(cl, stop);
+	}
+	i = pg_local(cl, start);
+	g->local_dist[i] = 0;
+	g->local_from[i] = -1;
+	pg_push(g->open, 0, i);
+	while (qp_len(g->open)) {
+		int d, k, step = 0;
+		struct loc grid;
+
+		i = qp_pop_int(g->open);
+		if (g->local_done[i]) continue;
+		g->local_done[i] = true;
+		if (i == stop) break;
+		d = g->local_dist[i];
+		grid = pg_grid(cl, i);
+		if (backward) {
+			/* Paths from the neighbours have to enter this grid */
+			step = g->enter[cl->classes[i]];
+			if (step < 0) continue;
+		}
+		for (k = 0; k < 8; k++) {
+			struct loc next = loc_sum(grid, ddgrid_ddd[k]);
+			int j, cost;
+
+			if (next.y < cl->tl.y || next.y >= cl->tl.y + cl->height
+					|| next.x < cl->tl.x
+					|| next.x >= cl->tl.x + cl->width) {
+				continue;
+			}
+			j = pg_local(cl, next);
+			if (g->enter[cl->classes[j]] < 0) continue;
+			cost = d + (backward ? step : g->enter[cl->classes[j]]);
+			if (g->local_dist[j] < 0 || cost < g->local_dist[j]) {
+				int estimate = (stop >= 0) ? PF_SCL
+					* MAX(ABS(target.y - next.y),
+					ABS(target.x - next.x)) : 0;
+
+				g->local_dist[j] = cost;
+				g->local_from[j] = i;
+				pg_push(g->open, cost + estimate, j);
+			}
+		}
+	}
+}
+
+static void pg_add_crossing(struct path_graph *g, struct loc from,
+		struct loc to)
+{
+	if (g->ncrossings == g->crossings_alloc) {
+		g->crossings_alloc = MAX(64, 2 * g->crossings_alloc);
+		g->crossings = mem_realloc(g->crossings,
+			g->crossings_alloc * sizeof(*g->crossings));
+	}
+	g->crossings[g->ncrossings].from = from;
+	g->crossings[g->ncrossings].to = to;
+	g->ncrossings++;
+}
+
+/**
+ * Note the crossings over the border between two neighbouring clusters.
+ *
+ * \param g is the graph.
+ * \param first is the first grid of the left or upper cluster's side.
+ * \param across is the offset from that side to the other cluster's side.
+ * \param along is the offset from one grid of the side to the next.
+ * \param length is the number of grids along the side.
+ */
+static void pg_find_crossings(struct path_graph *g, struct loc first,
+		struct loc across, struct loc along, int length)
+{
+	int i, run = 0;
+
+	for (i = 0; i <= length; i++) {
+		struct loc a = loc_sum(first, loc(along.x * i, along.y * i));
+		struct loc b = loc_sum(a, across);
+		bool open = i < length && pg_enter(g, a) >= 0
+			&& pg_enter(g, b) >= 0;
+
+		if (open) {
+			run++;
+			continue;
+		}
+		if (run >= PG_LONG_RUN) {
+			struct loc end = loc_diff(a, along);
+			struct loc start = loc_diff(a,
+				loc(along.x * run, along.y * run));
+
+			pg_add_crossing(g, start, loc_sum(start, across));
+			pg_add_crossing(g, end, loc_sum(end, across));
+		} else if (run) {
+			struct loc mid = loc_diff(a,
+				loc(along.x * ((run + 1) / 2),
+				along.y * ((run + 1) / 2)));
+
+			pg_add_crossing(g, mid, loc_sum(mid, across));
+		} else if (i > 0 && i < length) {
+			/*
+			 * Where the border can only be crossed diagonally,
+			 * add that crossing.
+			 */
+			struct loc prev = loc_diff(a, along);
+
+			if (pg_enter(g, prev) >= 0 && pg_enter(g,
+					loc_sum(prev, across)) < 0
+					&& pg_enter(g, a) < 0
+					&& pg_enter(g, loc_sum(a, across)) >= 0) {
+				pg_add_crossing(g, prev, loc_sum(a, across));
+			} else if (pg_enter(g, prev) < 0
+					&& pg_enter(g, loc_sum(prev, across)) >= 0
+					&& pg_enter(g, a) >= 0
+					&& pg_enter(g, loc_sum(a, across)) < 0) {
+				pg_add_crossing(g, a, loc_sum(prev, across));
+			}
+		}
+		run = 0;
+	}
+}
+
+/**
+ * Add a node to a cluster for a grid if it doesn't have one
+ */
+static void pg_add_node(struct path_cluster *cl, struct loc grid, int *alloc)
+{
+	int i = pg_local(cl, grid);
+
+	if (cl->node_at[i] >= 0) return;
+	if (cl->nnodes == *alloc) {
+		*alloc = MAX(8, 2 * *alloc);
+		cl->nodes = mem_realloc(cl->nodes, *alloc * sizeof(*cl->nodes));
+	}
+	cl->node_at[i] = cl->nnodes;
+	cl->nodes[cl->nnodes++] = grid;
+}
+
+/**
+ * Recompute the costs between the nodes of a cluster
+ */
+static void pg_cluster_costs(struct path_graph *g, struct path_cluster *cl)
+{
+	int i, j;
+
+	mem_free(cl->costs);
+	cl->costs = mem_alloc(MAX(1, cl->nnodes * cl->nnodes)
+		* sizeof(*cl->costs));
+	for (i = 0; i < cl->nnodes; i++) {
+		pg_local_search(g, cl, cl->nodes[i], -1, false);
+		for (j = 0; j < cl->nnodes; j++) {
+			cl->costs[i * cl->nnodes + j] =
+				g->local_dist[pg_local(cl, cl->nodes[j])];
+		}
+	}
+	cl->stale = false;
+}
+
+/**
+ * Bring the graph up to date with the player's map
+ */
+static void pg_update(struct path_graph *g, struct player *p)
+{
+	int enter[PG_CLASS_MAX], penalty[PG_CLASS_MAX];
+	bool trapsafe = player_is_trapsafe(p), changed = false;
+	int c, i, n;
+
+	/* The cost of entering each kind of grid */
+	penalty[PG_BLOCKED] = -1;
+	penalty[PG_OPEN] = 0;
+	penalty[PG_DOOR] = compute_unlocked_penalty(p);
+	penalty[PG_LOCKED] = compute_locked_penalty(p);
+	penalty[PG_RUBBLE] = compute_rubble_penalty(p);
+	for (i = 0; i < PG_CLASS_MAX; i++) {
+		enter[i] = (penalty[i] >= 0 && penalty[i] <= PG_MAX_ENTER) ?
+			PF_SCL + penalty[i] : -1;
+	}
+	if (memcmp(enter, g->enter, sizeof(enter))) {
+		memcpy(g->enter, enter, sizeof(enter));
+		for (c = 0; c < g->cheight * g->cwidth; c++) {
+			g->clusters[c].stale = true;
+		}
+		changed = true;
+	}
+	if (trapsafe != g->trapsafe) {
+		g->trapsafe = trapsafe;
+		g->checked = false;
+	}
+
+	/*
+	 * Reclassify the clusters where the map has changed; comparing what
+	 * is remembered first is much cheaper than classifying every grid.
+	 */
+	if (!g->checked || g->stamp != p->cave->terrain_stamp) {
+		for (c = 0; c < g->cheight * g->cwidth; c++) {
+			struct path_cluster *cl = &g->clusters[c];
+			uint16_t known[PG_AREA];
+			uint8_t classes[PG_AREA];
+			int y, x;
+
+			memset(known, 0, sizeof(known));
+			for (y = 0; y < cl->height; y++) {
+				const struct square *sq =
+					&p->cave->squares[cl->tl.y + y][cl->tl.x];
+
+				for (x = 0; x < cl->width; x++) {
+					known[y * PG_CLUSTER + x] = sq[x].feat
+						| (sq[x].trap ? PG_TRAPPED : 0);
+				}
+			}
+			if (g->checked && !memcmp(known, cl->known,
+					sizeof(known))) {
+				continue;
+			}
+			memcpy(cl->known, known, sizeof(known));
+			memset(classes, PG_BLOCKED, sizeof(classes));
+			for (y = 0; y < cl->height; y++) {
+				for (x = 0; x < cl->width; x++) {
+					classes[y * PG_CLUSTER + x] = pg_classify(p,
+						loc_sum(cl->tl, loc(x, y)));
+				}
+			}
+			if (memcmp(classes, cl->classes, sizeof(classes))) {
+				memcpy(cl->classes, classes, sizeof(classes));
+				cl->stale = true;
+				changed = true;
+			}
+		}
+		g->checked = true;
+		g->stamp = p->cave->terrain_stamp;
+	}
+	if (!changed) return;
+
+	/* Find the crossings between neighbouring clusters */
+	g->ncrossings = 0;
+	for (c = 0; c < g->cheight * g->cwidth; c++) {
+		struct path_cluster *cl = &g->clusters[c];
+
+		if (cl->tl.x + cl->width < g->width) {
+			pg_find_crossings(g, loc(cl->tl.x + cl->width - 1,
+				cl->tl.y), loc(1, 0), loc(0, 1), cl->height);
+		}
+		if (cl->tl.y + cl->height < g->height) {
+			pg_find_crossings(g, loc(cl->tl.x,
+				cl->tl.y + cl->height - 1), loc(0, 1),
+				loc(1, 0), cl->width);
+		}
+	}
+
+	/*
+	 * Rebuild the nodes.  A cluster whose nodes change needs its costs
+	 * recomputed even if its own grids did not change.
+	 */
+	for (c = 0; c < g->cheight * g->cwidth; c++) {
+		struct path_cluster *cl = &g->clusters[c];
+		struct loc *old = cl->nodes;
+		int nold = cl->nnodes, alloc = 0;
+
+		cl->nodes = NULL;
+		cl->nnodes = 0;
+		for (i = 0; i < PG_AREA; i++) {
+			cl->node_at[i] = -1;
+		}
+		for (i = 0; i < g->ncrossings; i++) {
+			struct path_crossing *x = &g->crossings[i];
+
+			if (pg_cluster(g, x->from) == cl) {
+				pg_add_node(cl, x->from, &alloc);
+			}
+			if (pg_cluster(g, x->to) == cl) {
+				pg_add_node(cl, x->to, &alloc);
+			}
+		}
+		if (nold != cl->nnodes || (nold && memcmp(old, cl->nodes,
+				nold * sizeof(*old)))) {
+			cl->stale = true;
+		}
+		mem_free(old);
+	}
+	n = 0;
+	for (c = 0; c < g->cheight * g->cwidth; c++) {
+		struct path_cluster *cl = &g->clusters[c];
+
+		if (cl->stale) {
+			pg_cluster_costs(g, cl);
+		}
+		cl->base = n;
+		n += cl->nnodes;
+	}
+
+	/* Number the nodes and link them across the crossings */
+	g->nnodes = n;
+	if (n + 1 > g->nodes_alloc) {
+		g->nodes_alloc = 2 * (n + 1);
+		g->owner = mem_realloc(g->owner,
+			g->nodes_alloc * sizeof(*g->owner));
+		g->link_start = mem_realloc(g->link_start,
+			(g->nodes_alloc + 1) * sizeof(*g->link_start));
+		g->dist = mem_realloc(g->dist,
+			g->nodes_alloc * sizeof(*g->dist));
+		g->from = mem_realloc(g->from,
+			g->nodes_alloc * sizeof(*g->from));
+		mem_free(g->seen);
+		g->seen = mem_zalloc(g->nodes_alloc * sizeof(*g->seen));
+		mem_free(g->done);
+		g->done = mem_zalloc(g->nodes_alloc * sizeof(*g->done));
+		g->search = 0;
+	}
+	if (2 * g->ncrossings > g->links_alloc) {
+		g->links_alloc = 4 * g->ncrossings;
+		g->link_to = mem_realloc(g->link_to,
+			g->links_alloc * sizeof(*g->link_to));
+		g->link_cost = mem_realloc(g->link_cost,
+			g->links_alloc * sizeof(*g->link_cost));
+	}
+	for (c = 0; c < g->cheight * g->cwidth; c++) {
+		struct path_cluster *cl = &g->clusters[c];
+
+		for (i = 0; i < cl->nnodes; i++) {
+			g->owner[cl->base + i] = c;
+		}
+	}
+	memset(g->link_start, 0, (n + 2) * sizeof(*g->link_start));
+	for (i = 0; i < g->ncrossings; i++) {
+		struct path_crossing *x = &g->crossings[i];
+		struct path_cluster *a = pg_cluster(g, x->from);
+		struct path_cluster *b = pg_cluster(g, x->to);
+
+		g->link_start[a->base + a->node_at[pg_local(a, x->from)] + 2]++;
+		g->link_start[b->base + b->node_at[pg_local(b, x->to)] + 2]++;
+	}
+	for (i = 2; i <= n + 1; i++) {
+		g->link_start[i] += g->link_start[i - 1];
+	}
+	for (i = 0; i < g->ncrossings; i++) {
+		struct path_crossing *x = &g->crossings[i];
+		struct path_cluster *a = pg_cluster(g, x->from);
+		struct path_cluster *b = pg_cluster(g, x->to);
+		int na = a->base + a->node_at[pg_local(a, x->from)];
+		int nb = b->base + b->node_at[pg_local(b, x->to)];
+		int l = g->link_start[na + 1]++;
+
+		g->link_to[l] = nb;
+		g->link_cost[l] = pg_enter(g, x->to);
+		l = g->link_start[nb + 1]++;
+		g->link_to[l] = na;
+		g->link_cost[l] = pg_enter(g, x->from);
+	}
+}
+
+static struct path_graph *pg_new(struct chunk *c)
+{
+	struct path_graph *g = mem_zalloc(sizeof(*g));
+	int cy, cx;
+
+	g->height = c->height;
+	g->width = c->width;
+	g->cheight = (c->height + PG_CLUSTER - 1) >> PG_SHIFT;
+	g->cwidth = (c->width + PG_CLUSTER - 1) >> PG_SHIFT;
+	g->clusters = mem_zalloc(g->cheight * g->cwidth
+		* sizeof(*g->clusters));
+	for (cy = 0; cy < g->cheight; cy++) {
+		for (cx = 0; cx < g->cwidth; cx++) {
+			struct path_cluster *cl =
+				&g->clusters[cy * g->cwidth + cx];
+
+			cl->tl = loc(cx << PG_SHIFT, cy << PG_SHIFT);
+			cl->height = MIN(PG_CLUSTER, c->height - cl->tl.y);
+			cl->width = MIN(PG_CLUSTER, c->width - cl->tl.x);
+			cl->stale = true;
+		}
+	}
+	g->open = qp_new(PG_AREA);
+	return g;
+}
+
+/**
+ * Free a chunk's path planner
+ */
+void path_graph_free(struct path_graph *g)
+{
+	int c;
+
+	if (!g) return;
+	for (c = 0; c < g->cheight * g->cwidth; c++) {
+		mem_free(g->clusters[c].nodes);
+		mem_free(g->clusters[c].costs);
+	}
+	mem_free(g->clusters);
+	mem_free(g->crossings);
+	mem_free(g->owner);
+	mem_free(g->link_start);
+	mem_free(g->link_to);
+	mem_free(g->link_cost);
+	mem_free(g->dist);
+	mem_free(g->from);
+	mem_free(g->seen);
+	mem_free(g->done);
+	mem_free(g->exit_cost);
+	qp_free(g->open, NULL);
+	mem_free(g);
+}
+
+/**
+ * Append the steps of the best path between two grids of a cluster
+ */
+static bool pg_append_leg(struct path_graph *g, const struct path_cluster *cl,
+		struct loc from, struct loc to, int16_t **steps, int *length,
+		int *alloc)
+{
+	int stop = pg_local(cl, to), i, k, n = 0;
+
+	if (loc_eq(from, to)) return true;
+	pg_local_search(g, cl, from, stop, false);
+	if (g->local_dist[stop] < 0) return false;
+
+	/* Count the steps, then fill them in from the end */
+	for (i = stop; g->local_from[i] >= 0; i = g->local_from[i]) n++;
+	if (*length + n > *alloc) {
+		*alloc = MAX(2 * *alloc, *length + n);
+		*steps = mem_realloc(*steps, *alloc * sizeof(**steps));
+	}
+	*length += n;
+	for (i = stop, k = *length - 1; g->local_from[i] >= 0;
+			i = g->local_from[i], k--) {
+		(*steps)[k] = motion_dir(pg_grid(cl, g->local_from[i]),
+			pg_grid(cl, i));
+	}
+	return true;
+}
+
+/**
+ * Plan a path between two remembered grids that are far apart with the
+ * player's map's graph.
+ *
+ * \return the number of steps, with the steps as for find_path(), or -1 if
+ * the graph has no path.
+ */
+static int pg_find_path(struct player *p, struct loc start, struct loc dest,
+		int16_t **step_dirs)
+{
+	struct path_graph *g = p->cave->path_graph;
+	struct path_cluster *sc, *dc;
+	int16_t *steps = NULL;
+	int length = 0, alloc = 0, goal, n, i, last;
+
+	if (!g || g->height != p->cave->height
+			|| g->width != p->cave->width) {
+		path_graph_free(g);
+		g = pg_new(p->cave);
+		p->cave->path_graph = g;
+	}
+	pg_update(g, p);
+	sc = pg_cluster(g, start);
+	dc = pg_cluster(g, dest);
+	if (sc == dc || pg_enter(g, dest) < 0) return -1;
+
+	/* Start a fresh search */
+	if (++g->search == 0) {
+		memset(g->seen, 0, g->nodes_alloc * sizeof(*g->seen));
+		memset(g->done, 0, g->nodes_alloc * sizeof(*g->done));
+		g->search = 1;
+	}
+	goal = g->nnodes;
+
+	/* How the trip could end */
+	if (dc->nnodes > g->exit_alloc) {
+		g->exit_alloc = 2 * dc->nnodes;
+		g->exit_cost = mem_realloc(g->exit_cost,
+			g->exit_alloc * sizeof(*g->exit_cost));
+	}
+	pg_local_search(g, dc, dest, -1, true);
+	for (i = 0; i < dc->nnodes; i++) {
+		g->exit_cost[i] = g->local_dist[pg_local(dc, dc->nodes[i])];
+	}
+
+	/* How it could start */
+	pg_local_search(g, sc, start, -1, false);
+	qp_flush(g->open, NULL);
+	for (i = 0; i < sc->nnodes; i++) {
+		int d = g->local_dist[pg_local(sc, sc->nodes[i])];
+
+		if (d >= 0) {
+			struct loc grid = sc->nodes[i];
+
+			n = sc->base + i;
+			g->seen[n] = g->search;
+			g->dist[n] = d;
+			g->from[n] = -1;
+			pg_push(g->open, d + PF_SCL * MAX(ABS(dest.y - grid.y),
+				ABS(dest.x - grid.x)), n);
+		}
+	}
+
+	/* A* over the nodes */
+	while (1) {
+		struct path_cluster *cl;
+		int k;
+
+		if (!qp_len(g->open)) return -1;
+		n = qp_pop_int(g->open);
+		if (n == goal) break;
+		if (g->done[n] == g->search) continue;
+		g->done[n] = g->search;
+		cl = &g->clusters[g->owner[n]];
+
+		for (k = 0; k <= cl->nnodes + g->link_start[n + 1]
+				- g->link_start[n]; k++) {
+			int m, d;
+
+			if (k < cl->nnodes) {
+				/* Across the cluster */
+				int cost = cl->costs[(n - cl->base)
+					* cl->nnodes + k];
+
+				if (cost < 0 || k == n - cl->base) continue;
+				m = cl->base + k;
+				d = g->dist[n] + cost;
+			} else if (k < cl->nnodes + g->link_start[n + 1]
+					- g->link_start[n]) {
+				/* Over the border */
+				int l = g->link_start[n] + k - cl->nnodes;
+
+				m = g->link_to[l];
+				d = g->dist[n] + g->link_cost[l];
+			} else {
+				/* Out of the graph to the destination */
+				if (cl != dc || g->exit_cost[n - cl->base] < 0) {
+					continue;
+				}
+				if (g->seen[goal] == g->search
+						&& g->dist[goal] <= g->dist[n]
+						+ g->exit_cost[n - cl->base]) {
+					continue;
+				}
+				g->seen[goal] = g->search;
+				g->dist[goal] = g->dist[n]
+					+ g->exit_cost[n - cl->base];
+				g->from[goal] = n;
+				pg_push(g->open, g->dist[goal], goal);
+				continue;
+			}
+			if (g->done[m] != g->search && (g->seen[m] != g->search
+					|| d < g->dist[m])) {
+				struct path_cluster *mc =
+					&g->clusters[g->owner[m]];
+				struct loc grid = mc->nodes[m - mc->base];
+
+				g->seen[m] = g->search;
+				g->dist[m] = d;
+				g->from[m] = n;
+				pg_push(g->open, d + PF_SCL
+					* MAX(ABS(dest.y - grid.y),
+					ABS(dest.x - grid.x)), m);
+			}
+		}
+	}
+
+	/*
+	 * Expand the legs into steps.  Turn the chain of nodes around first
+	 * so the legs can be walked from the start.
+	 */
+	last = -1;
+	for (n = g->from[goal]; n >= 0; ) {
+		int prev = g->from[n];
+
+		g->from[n] = last;
+		last = n;
+		n = prev;
+	}
+	{
+		struct loc at = start;
+		const struct path_cluster *cl = sc;
+
+		for (n = last; n >= 0; n = g->from[n]) {
+			const struct path_cluster *nc =
+				&g->clusters[g->owner[n]];
+			struct loc grid = nc->nodes[n - nc->base];
+
+			if (nc == cl) {
+				if (!pg_append_leg(g, cl, at, grid, &steps,
+						&length, &alloc)) {
+					break;
+				}
+			} else {
+				if (length == alloc) {
+					alloc = MAX(16, 2 * alloc);
+					steps = mem_realloc(steps,
+						alloc * sizeof(*steps));
+				}
+				steps[length++] = motion_dir(at, grid);
+				cl = nc;
+			}
+			at = grid;
+		}
+		if (n >= 0 || cl != dc || !pg_append_leg(g, cl, at, dest,
+				&steps, &length, &alloc)) {
+			/* Should not happen; let find_path() search instead */
+			mem_free(steps);
+			return -1;
+		}
+	}
+
+	/* Steps are handed back last first */
+	for (i = 0; i < length / 2; i++) {
+		int16_t t = steps[i];
+
+		steps[i] = steps[length - 1 - i];
+		steps[length - 1 - i] = t;
+	}
+	if (step_dirs) {
+		*step_dirs = steps;
+	} else {
+		mem_free(steps);
+	}
+	return length;
+}
+
 /**
  * Compute the path from one location to another using the given player's
  * knowledge of the cave.
@@ -1064,7 +1943,9 @@ int path_nearest_unknown(struct player *p, struct loc start,
  * pfdistances_to_path(), and release_pfdistances().  When there are paths
  * of the same distances (in expected turncounts) between start and dest, the
  * path returned by find_path() may be different than that returned by
- * pfdistances_to_path().
+ * pfdistances_to_path().  Long trips over remembered grids are planned
+ * with the map's path graph (see pg_find_path()) and may be slightly longer
+ * than the best path.
  */
 int find_path(struct player *p, struct loc start, struct loc dest,
 		int16_t **step_dirs)
@@ -1076,7 +1957,7 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 	 * parts of the cave that are not traversed when moving to the
 	 * destination.
 	 */
-	struct pfdistances_patched distances;
+	struct pfdistances_patched *distances = &pf_workspace.patched;
 	struct priority_queue *pending;
 	struct loc next;
 	int dist_next;
@@ -1125,6 +2006,19 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 		}
 		return -1;
 	}
+	/*
+	 * Plan long trips over remembered grids with the map's graph; fall
+	 * back to the search below if that fails.
+	 */
+	if (only_known && forbid_traps && MAX(ABS(dest.y - start.y),
+			ABS(dest.x - start.x)) >= PG_MIN_TRIP) {
+		int length = pg_find_path(p, start, dest, step_dirs);
+
+		if (length > 0) {
+			return length;
+		}
+	}
+
 	/*
 	 * Remember if the pathfinding would change because of a known visible
 	 * trap.
@@ -1136,15 +2030,19 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 	locked_penalty = compute_locked_penalty(p);
 	rubble_penalty = compute_rubble_penalty(p);
 
-	initialize_patched_distances(&distances, p->cave->height,
+	prepare_patched_distances(distances, p->cave->height,
 		p->cave->width);
 
 	/* Set up the priority queue of feasible paths to consider. */
-	pending = qp_new(4 * (2 + MAX(ABS(start.y - dest.y),
-		ABS(start.x - dest.x))));
+	if (!pf_workspace.ppending) {
+		pf_workspace.ppending = qp_new(4 * (2 + MAX(ABS(start.y
+			- dest.y), ABS(start.x - dest.x))));
+	}
+	pending = pf_workspace.ppending;
+	qp_flush(pending, NULL);
 
-	initialize_patch(&distances, start, p, only_known, forbid_traps);
-	set_patched_distance(&distances, start, 0);
+	initialize_patch(distances, start, p, only_known, forbid_traps);
+	set_patched_distance(distances, start, 0);
 	next = start;
 	dist_next = 0;
 	while (1) {
@@ -1159,20 +2057,15 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 
 			if (loc_eq(this_grid, dest)) {
 				/* Reached the destination. */
-				int length = patched_distances_to_path(
-					&distances, start, dest,
-					step_dirs);
-
-				release_patched_distances(&distances);
-				qp_free(pending, NULL);
-				return length;
+				return patched_distances_to_path(distances,
+					start, dest, step_dirs);
 			}
 
-			if (!has_patched_distance(&distances, this_grid)) {
-				initialize_patch(&distances, this_grid,
+			if (!has_patched_distance(distances, this_grid)) {
+				initialize_patch(distances, this_grid,
 					p, only_known, forbid_traps);
 			}
-			dist_stored = get_patched_distance(&distances,
+			dist_stored = get_patched_distance(distances,
 				this_grid);
 			if (dist_stored <= dist_this) {
 				/*
@@ -1260,9 +2153,6 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 						 * Could not resize so give
 						 * up.
 						 */
-						release_patched_distances(
-							&distances);
-						qp_free(pending, NULL);
 						if (step_dirs) {
 							*step_dirs = NULL;
 						}
@@ -1273,7 +2163,7 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 			}
 			add_grid = grid_to_i(this_grid, p->cave->width);
 			add_priority = dist_this + penalty + dist_remaining;
-			set_patched_distance(&distances, this_grid,
+			set_patched_distance(distances, this_grid,
 				dist_this + penalty);
 		}
 
@@ -1293,10 +2183,10 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 					 * known visible traps.
 					 */
 					forbid_traps = false;
-					clear_patched_distances(&distances);
-					initialize_patch(&distances, start,
+					clear_patched_distances(distances);
+					initialize_patch(distances, start,
 						p, only_known, forbid_traps);
-					set_patched_distance(&distances,
+					set_patched_distance(distances,
 						start, 0);
 					next = start;
 					dist_next = 0;
@@ -1314,18 +2204,16 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 						forbid_traps = false;
 					}
 					hit_trap = false;
-					clear_patched_distances(&distances);
-					initialize_patch(&distances, start,
+					clear_patched_distances(distances);
+					initialize_patch(distances, start,
 						p, only_known, forbid_traps);
-					set_patched_distance(&distances,
+					set_patched_distance(distances,
 						start, 0);
 					next = start;
 					dist_next = 0;
 					continue;
 				}
 				/* Nothing to retry so give up. */
-				release_patched_distances(&distances);
-				qp_free(pending, NULL);
 				if (step_dirs) {
 					*step_dirs = NULL;
 				}
@@ -1334,11 +2222,35 @@ int find_path(struct player *p, struct loc start, struct loc dest,
 			i_to_grid(qp_pop_int(pending), p->cave->width, &next);
 		}
 		/* The relevant patch should already have been initialized. */
-		assert(has_patched_distance(&distances, next));
-		dist_next = get_patched_distance(&distances, next);
+		assert(has_patched_distance(distances, next));
+		dist_next = get_patched_distance(distances, next);
 	}
 }
 
+/**
+ * Release the storage kept between pathfinding calls.
+ */
+static void cleanup_pathfind(void)
+{
+	assert(!pf_workspace.distances_lent);
+	mem_free(pf_workspace.distances.buffer);
+	mem_free(pf_workspace.distances.stamps);
+	if (pf_workspace.pending) {
+		q_free(pf_workspace.pending);
+	}
+	release_patched_distances(&pf_workspace.patched);
+	if (pf_workspace.ppending) {
+		qp_free(pf_workspace.ppending, NULL);
+	}
+	memset(&pf_workspace, 0, sizeof(pf_workspace));
+}
+
+struct init_module pathfind_module = {
+	.name = "pathfind",
+	.init = NULL,
+	.cleanup = cleanup_pathfind
+};
+
 /**
  * Compute the direction (in the angband 123456789 sense) from a point to a
  * point. We decide to use diagonals if dx and dy are within a factor of two of
@@ -23,6 +23,7 @@
 #include "z-type.h"
 
 struct pfdistances;
+struct path_graph;
 
 struct pfdistances *prepare_pfdistances(struct player *p, struct loc start,
 		bool only_known, bool forbid_traps);
@@ -37,6 +38,7 @@ int path_nearest_unknown(struct player *p, struct loc start,
 		struct loc *dest_grid, int16_t **step_dirs);
 int find_path(struct player *p, struct loc start, struct loc dest,
 		int16_t **step_dirs);
+void path_graph_free(struct path_graph *g);
 int pathfind_direction_to(struct loc from, struct loc to);
 void run_step(int dir);
 
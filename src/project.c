@@ -354,25 +354,13 @@ int project_path(struct chunk *c, struct loc *gp, int range, struct loc grid1,
 
 
 /**
- * Determine if a bolt spell cast from grid1 to grid2 will arrive
- * at the final destination, assuming that no monster gets in the way,
- * using the project_path() function to check the projection path.
- *
- * Note that no grid is ever projectable() from itself.
- *
- * This function is used to determine if the player can (easily) target
- * a given grid, and if a monster can target the player.
+ * Help projectable():  follow the projection path out to the given range.
  */
-bool projectable(struct chunk *c, struct loc grid1, struct loc grid2, int flg)
+static bool projectable_trace(struct chunk *c, struct loc grid1,
+		struct loc grid2, int flg, int max_range)
 {
 	struct loc grid_g[512];
 	int grid_n = 0;
-	int max_range = z_info->max_range;
-
-	/* Check for shortened projection range */
-	if ((flg & PROJECT_SHORT) && player->timed[TMD_COVERTRACKS]) {
-		max_range /= 4;
-	}
 
 	/* Check the projection path */
 	grid_n = project_path(c, grid_g, max_range, grid1, grid2, flg);
@@ -390,6 +378,54 @@ bool projectable(struct chunk *c, struct loc grid1, struct loc grid2, int flg)
 	return (true);
 }
 
+/**
+ * Determine if a bolt spell cast from grid1 to grid2 will arrive
+ * at the final destination, assuming that no monster gets in the way,
+ * using the project_path() function to check the projection path.
+ *
+ * Note that no grid is ever projectable() from itself.
+ *
+ * This function is used to determine if the player can (easily) target
+ * a given grid, and if a monster can target the player.
+ */
+bool projectable(struct chunk *c, struct loc grid1, struct loc grid2, int flg)
+{
+	int max_range = z_info->max_range;
+	int kind, known;
+	struct loc grid;
+	bool result;
+
+	/* Check for shortened projection range */
+	if ((flg & PROJECT_SHORT) && player->timed[TMD_COVERTRACKS]) {
+		max_range /= 4;
+	}
+
+	/*
+	 * Paths to or from the player which only depend on the terrain are
+	 * kept; anything stopping at monsters or using the player's memory
+	 * is worked out every time
+	 */
+	if ((flg & ~(PROJECT_SHORT)) || loc_eq(grid1, grid2)) {
+		return projectable_trace(c, grid1, grid2, flg, max_range);
+	} else if (loc_eq(grid1, player->grid)) {
+		kind = (max_range == z_info->max_range) ?
+			PLAYER_PATH_PROJECT_FROM : PLAYER_PATH_PROJECT_SHORT_FROM;
+		grid = grid2;
+	} else if (loc_eq(grid2, player->grid)) {
+		kind = (max_range == z_info->max_range) ?
+			PLAYER_PATH_PROJECT_TO : PLAYER_PATH_PROJECT_SHORT_TO;
+		grid = grid1;
+	} else {
+		return projectable_trace(c, grid1, grid2, flg, max_range);
+	}
+
+	known = player_path_lookup(c, grid, kind);
+	if (known >= 0) return known == 1;
+	result = projectable_trace(c, grid1, grid2, flg, max_range);
+	player_path_store(c, grid, kind, result);
+	return result;
+}
+
 
 
 
@@ -900,20 +936,26 @@ bool project(struct source origin, int rad, struct loc finish,
 		}
 	}
 
-	/* Establish which grids are visible - no blast visuals with PROJECT_HIDE */
-	for (i = 0; i < num_grids; i++) {
-		if (panel_contains(blast_grid[i].y, blast_grid[i].x) &&
-			square_isview(cave, blast_grid[i]) &&
-			!blind && !(flg & (PROJECT_HIDE))) {
-			player_sees_grid[i] = true;
-		} else {
-			player_sees_grid[i] = false;
+	if (event_has_handlers(EVENT_EXPLOSION)) {
+		/*
+		 * Establish which grids are visible - no blast visuals with
+		 * PROJECT_HIDE
+		 */
+		for (i = 0; i < num_grids; i++) {
+			if (panel_contains(blast_grid[i].y, blast_grid[i].x) &&
+				square_isview(cave, blast_grid[i]) &&
+				!blind && !(flg & (PROJECT_HIDE))) {
+				player_sees_grid[i] = true;
+			} else {
+				player_sees_grid[i] = false;
+			}
 		}
-	}
 
-	/* Tell the UI to display the blast */
-	event_signal_blast(EVENT_EXPLOSION, typ, num_grids, distance_to_grid,
-					   drawing, player_sees_grid, blast_grid, centre);
+		/* Tell the UI to display the blast */
+		event_signal_blast(EVENT_EXPLOSION, typ, num_grids,
+			distance_to_grid, drawing, player_sees_grid, blast_grid,
+			centre);
+	}
 
 	/* Affect objects on every relevant grid */
 	if (flg & (PROJECT_ITEM)) {
@@ -23,6 +23,7 @@
 #include "mon-group.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "monster.h"
 #include "object.h"
 #include "obj-desc.h"
@@ -285,13 +286,14 @@ static void wr_trap(struct trap *trap)
  */
 void wr_randomizer(void)
 {
+	struct rng_state *rs = rng_default();
 	int i;
 
 	/* current value for the simple RNG */
-	wr_u32b(Rand_value);
+	wr_u32b(rs->value);
 
 	/* state index */
-	wr_u32b(state_i);
+	wr_u32b(rs->index);
 
 	/* NULL padding for backwards compatibility with previous versions */
 	wr_u32b(0);
@@ -300,7 +302,7 @@ void wr_randomizer(void)
 
 	/* RNG state */
 	for (i = 0; i < RAND_DEG; i++)
-		wr_u32b(STATE[i]);
+		wr_u32b(rs->table[i]);
 
 	/* NULL padding */
 	for (i = 0; i < 59 - RAND_DEG; i++)
@@ -774,73 +776,31 @@ void wr_stores(void)
 static void wr_dungeon_aux(struct chunk *c)
 {
 	int y, x;
-	size_t i;
-
-	uint8_t tmp8u;
-
-	uint8_t count;
-	uint8_t prev_char;
+	size_t i, n = (size_t)c->height * c->width;
+	uint8_t *feat;
 
 	/* Dungeon specific info follows */
 	wr_string(c->name ? c->name : "Blank");
 	wr_u16b(c->height);
 	wr_u16b(c->width);
 
-	/* Run length encoding of c->squares[y][x].info */
+	/*
+	 * Run length encoding of c->squares[y][x].info, one flag byte at a
+	 * time; the info for all the squares is one block, in grid order
+	 */
 	for (i = 0; i < SQUARE_SIZE; i++) {
-		count = 0;
-		prev_char = 0;
-
-		/* Dump for each grid */
-		for (y = 0; y < c->height; y++) {
-			for (x = 0; x < c->width; x++) {
-				/* Extract the important c->squares[y][x].info flags */
-				tmp8u = square(c, loc(x, y))->info[i];
-
-				/* If the run is broken, or too full, flush it */
-				if ((tmp8u != prev_char) || (count == UCHAR_MAX)) {
-					wr_byte(count);
-					wr_byte(prev_char);
-					prev_char = tmp8u;
-					count = 1;
-				} else /* Continue the run */
-					count++;
-			}
-		}
-
-		/* Flush the data (if any) */
-		if (count) {
-			wr_byte(count);
-			wr_byte(prev_char);
-		}
+		wr_rle(c->squares[0][0].info + i, n, SQUARE_SIZE);
 	}
 
 	/* Now the terrain */
-	count = 0;
-	prev_char = 0;
-
-	/* Dump for each grid */
+	feat = mem_alloc(n);
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
-			/* Extract a byte */
-			tmp8u = square(c, loc(x, y))->feat;
-
-			/* If the run is broken, or too full, flush it */
-			if ((tmp8u != prev_char) || (count == UCHAR_MAX)) {
-				wr_byte(count);
-				wr_byte(prev_char);
-				prev_char = tmp8u;
-				count = 1;
-			} else /* Continue the run */
-				count++;
+			feat[y * c->width + x] = c->squares[y][x].feat;
 		}
 	}
-
-	/* Flush the data (if any) */
-	if (count) {
-		wr_byte(count);
-		wr_byte(prev_char);
-	}
+	wr_rle(feat, n, 1);
+	mem_free(feat);
 
 	/* Write feeling */
 	wr_byte(c->feeling);
@@ -985,6 +945,9 @@ void wr_objects(void)
 
 void wr_monsters(void)
 {
+	/* Write up to date energy */
+	sync_monster_energy(cave);
+
 	wr_monsters_aux(cave);
 	wr_monsters_aux(player->cave);
 }
@@ -21,8 +21,19 @@
 #include "init.h"
 #include "savefile.h"
 #include "save-charoutput.h"
+#include "z-compress.h"
 #include "z-file.h"
 
+/*
+ * Background saves move the file writing onto a thread of its own.  That
+ * isn't done in a setgid install since the privilege juggling around file
+ * access applies to the whole process.
+ */
+#if defined(HAVE_PTHREAD) && !defined(SETGID)
+# define SAVEFILE_BACKGROUND
+# include <pthread.h>
+#endif
+
 /**
  * The savefile code.
  *
@@ -38,6 +49,16 @@
  * ... data ...
  * padding so that block is a multiple of 4 bytes
  *
+ * With the compress_savefile option on, large blocks are compressed when that
+ * makes them smaller, which is marked by setting SAVEFILE_COMPRESSED in the
+ * version; older versions then don't recognise the block rather than
+ * misreading it.  The size is that of the
+ * compressed data, and the checksum is still that of the uncompressed data.
+ * Compressed data is a 4-byte uncompressed size followed by frames of up to
+ * SAVEFILE_FRAME_SIZE bytes of the block, each a 4-byte length and then the
+ * frame compressed by lz_compress(), or stored as it is if SAVEFILE_FRAME_RAW
+ * is set in the length.  The frames are read and expanded one at a time.
+ *
  * The savefile deosn't contain the version number of that game that saved it;
  * versioning is left at the individual block level.  The current code
  * keeps a list of savefile blocks to save in savers[] below, along with
@@ -88,6 +109,7 @@ struct blockheader {
 	char name[16];
 	uint32_t version;
 	uint32_t size;
+	bool compressed;
 };
 
 struct blockinfo {
@@ -166,6 +188,22 @@ static uint32_t buffer_check;
 
 #define SAVEFILE_HEAD_SIZE		28
 
+/* Block compression */
+#define SAVEFILE_COMPRESSED		0x80000000
+#define SAVEFILE_COMPRESS_MIN	1024
+#define SAVEFILE_FRAME_SIZE		32768
+#define SAVEFILE_FRAME_RAW		0x80000000
+
+/**
+ * A whole savefile, serialised into memory ready to be written out
+ */
+struct savefile_image {
+	uint8_t *data;
+	size_t len;
+	size_t size;
+	bool compress;	/* Compress large blocks as the image is written */
+};
+
 
 /**
  * ------------------------------------------------------------------------
@@ -185,33 +223,67 @@ void note(const char *message)
 /**
  * ------------------------------------------------------------------------
  * Base put/get
+ *
+ * Everything goes through sf_reserve()/sf_advance() on the way out and
+ * sf_take() on the way in, so multi-byte values and whole blocks are copied
+ * with one bounds check and summed into the checksum in one pass.
  * ------------------------------------------------------------------------ */
 
-static void sf_put(uint8_t v)
+/**
+ * Sum a run of bytes for the block checksum
+ */
+static uint32_t sf_sum(const uint8_t *p, uint32_t n)
+{
+	uint32_t sum = 0;
+	uint32_t i;
+
+	for (i = 0; i < n; i++)
+		sum += p[i];
+	return sum;
+}
+
+/**
+ * Make room for n more bytes in the save buffer, and return where they go
+ */
+static uint8_t *sf_reserve(uint32_t n)
 {
 	assert(buffer != NULL);
 	assert(buffer_size > 0);
 
-	if (buffer_size == buffer_pos)
-	{
-		buffer_size += BUFFER_BLOCK_INCREMENT;
+	if (buffer_size - buffer_pos < n) {
+		buffer_size = MAX(buffer_size + MAX(buffer_size,
+			BUFFER_BLOCK_INCREMENT), buffer_pos + n);
 		buffer = mem_realloc(buffer, buffer_size);
 	}
 
-	assert(buffer_pos < buffer_size);
+	return buffer + buffer_pos;
+}
 
-	buffer[buffer_pos++] = v;
-	buffer_check += v;
+/**
+ * Commit n bytes written at sf_reserve() to the save buffer
+ */
+static void sf_advance(uint32_t n)
+{
+	assert(buffer_pos + n <= buffer_size);
+	buffer_check += sf_sum(buffer + buffer_pos, n);
+	buffer_pos += n;
 }
 
-static uint8_t sf_get(void)
+/**
+ * Consume n bytes of the load buffer, and return where they were
+ */
+static const uint8_t *sf_take(uint32_t n)
 {
-	if ((buffer == NULL) || (buffer_size <= 0) || (buffer_pos >= buffer_size))
-		quit("Broken savefile - probably from a development version");
+	const uint8_t *p;
 
-	buffer_check += buffer[buffer_pos];
+	if ((buffer == NULL) || (buffer_size <= 0) || (buffer_pos > buffer_size)
+			|| (buffer_size - buffer_pos < n))
+		quit("Broken savefile - probably from a development version");
 
-	return buffer[buffer_pos++];
+	p = buffer + buffer_pos;
+	buffer_check += sf_sum(p, n);
+	buffer_pos += n;
+	return p;
 }
 
 
@@ -222,13 +294,17 @@ static uint8_t sf_get(void)
 
 void wr_byte(uint8_t v)
 {
-	sf_put(v);
+	*sf_reserve(1) = v;
+	sf_advance(1);
 }
 
 void wr_u16b(uint16_t v)
 {
-	sf_put((uint8_t)(v & 0xFF));
-	sf_put((uint8_t)((v >> 8) & 0xFF));
+	uint8_t *p = sf_reserve(2);
+
+	p[0] = (uint8_t)(v & 0xFF);
+	p[1] = (uint8_t)((v >> 8) & 0xFF);
+	sf_advance(2);
 }
 
 void wr_s16b(int16_t v)
@@ -238,10 +314,13 @@ void wr_s16b(int16_t v)
 
 void wr_u32b(uint32_t v)
 {
-	sf_put((uint8_t)(v & 0xFF));
-	sf_put((uint8_t)((v >> 8) & 0xFF));
-	sf_put((uint8_t)((v >> 16) & 0xFF));
-	sf_put((uint8_t)((v >> 24) & 0xFF));
+	uint8_t *p = sf_reserve(4);
+
+	p[0] = (uint8_t)(v & 0xFF);
+	p[1] = (uint8_t)((v >> 8) & 0xFF);
+	p[2] = (uint8_t)((v >> 16) & 0xFF);
+	p[3] = (uint8_t)((v >> 24) & 0xFF);
+	sf_advance(4);
 }
 
 void wr_s32b(int32_t v)
@@ -251,24 +330,66 @@ void wr_s32b(int32_t v)
 
 void wr_string(const char *str)
 {
-	while (*str)
-	{
-		wr_byte(*str);
-		str++;
+	wr_bytes((const uint8_t *)str, strlen(str) + 1);
+}
+
+/**
+ * Write n bytes as they are
+ */
+void wr_bytes(const uint8_t *src, uint32_t n)
+{
+	if (!n) return;
+	memcpy(sf_reserve(n), src, n);
+	sf_advance(n);
+}
+
+/**
+ * Run length encode n bytes, taken every stride bytes from src, as
+ * (count, value) byte pairs.  Runs are at most UCHAR_MAX long, and the
+ * encoding starts with a (0, 0) pair unless the first byte is zero, as the
+ * savefile format always has.
+ */
+void wr_rle(const uint8_t *src, size_t n, size_t stride)
+{
+	uint8_t *start, *out;
+	uint8_t count = 0, prev = 0;
+	size_t i;
+
+	if (!n) return;
+
+	/* At worst every byte starts a run, plus the leading pair */
+	start = out = sf_reserve((uint32_t)(2 * (n + 1)));
+	for (i = 0; i < n; i++) {
+		uint8_t b = src[i * stride];
+
+		if ((b != prev) || (count == UCHAR_MAX)) {
+			*out++ = count;
+			*out++ = prev;
+			prev = b;
+			count = 1;
+		} else {
+			count++;
+		}
+	}
+	if (count) {
+		*out++ = count;
+		*out++ = prev;
 	}
-	wr_byte(*str);
+	sf_advance((uint32_t)(out - start));
 }
 
 
 void rd_byte(uint8_t *ip)
 {
-	*ip = sf_get();
+	*ip = *sf_take(1);
 }
 
 void rd_u16b(uint16_t *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((uint16_t)(sf_get()) << 8);
+	const uint8_t *p = sf_take(2);
+
+	(*ip) = p[0];
+	(*ip) |= ((uint16_t)(p[1]) << 8);
 }
 
 void rd_s16b(int16_t *ip)
@@ -278,10 +399,12 @@ void rd_s16b(int16_t *ip)
 
 void rd_u32b(uint32_t *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((uint32_t)(sf_get()) << 8);
-	(*ip) |= ((uint32_t)(sf_get()) << 16);
-	(*ip) |= ((uint32_t)(sf_get()) << 24);
+	const uint8_t *p = sf_take(4);
+
+	(*ip) = p[0];
+	(*ip) |= ((uint32_t)(p[1]) << 8);
+	(*ip) |= ((uint32_t)(p[2]) << 16);
+	(*ip) |= ((uint32_t)(p[3]) << 24);
 }
 
 void rd_s32b(int32_t *ip)
@@ -291,28 +414,56 @@ void rd_s32b(int32_t *ip)
 
 void rd_string(char *str, int max)
 {
-	uint8_t tmp8u;
-	int i = 0;
+	const uint8_t *end;
+	uint32_t len;
 
-	do {
-		rd_byte(&tmp8u);
-
-		if (i < max) str[i] = tmp8u;
-		if (!tmp8u) break;
-	} while (++i);
+	/* The string runs up to and including its terminating zero */
+	end = (buffer && buffer_pos < buffer_size) ?
+		memchr(buffer + buffer_pos, 0, buffer_size - buffer_pos) : NULL;
+	if (!end)
+		quit("Broken savefile - probably from a development version");
+	len = (uint32_t)(end - (buffer + buffer_pos)) + 1;
 
+	memcpy(str, sf_take(len), MIN(len, (uint32_t)max));
 	str[max - 1] = '\0';
 }
 
+/**
+ * Read n bytes as they are
+ */
+void rd_bytes(uint8_t *dst, uint32_t n)
+{
+	if (!n) return;
+	memcpy(dst, sf_take(n), n);
+}
+
+/**
+ * Decode n bytes written by wr_rle(), storing them every stride bytes from
+ * dst.  A run which goes past the end is cut short, as it always has been.
+ */
+void rd_rle(uint8_t *dst, size_t n, size_t stride)
+{
+	size_t i = 0;
+
+	while (i < n) {
+		const uint8_t *pair = sf_take(2);
+		size_t end = MIN(n, i + pair[0]);
+
+		for (; i < end; i++)
+			dst[i * stride] = pair[1];
+	}
+}
+
 void strip_bytes(int n)
 {
-	uint8_t tmp8u;
-	while (n--) rd_byte(&tmp8u);
+	if (n > 0) sf_take(n);
 }
 
 void pad_bytes(int n)
 {
-	while (n--) wr_byte(0);
+	if (n <= 0) return;
+	memset(sf_reserve(n), 0, n);
+	sf_advance(n);
 }
 
 
@@ -322,11 +473,150 @@ void pad_bytes(int n)
  * ------------------------------------------------------------------------ */
 
 
-static bool try_save(ang_file *file)
+/**
+ * Make room for n more bytes at the end of a savefile image
+ */
+static uint8_t *image_reserve(struct savefile_image *image, size_t n)
+{
+	if (image->size - image->len < n) {
+		image->size = MAX(image->size * 2, image->len + n);
+		image->data = mem_realloc(image->data, image->size);
+	}
+	return image->data + image->len;
+}
+
+/**
+ * Append bytes to a savefile image, growing it as needed
+ */
+static void image_append(struct savefile_image *image, const void *src,
+		size_t n)
+{
+	memcpy(image_reserve(image, n), src, n);
+	image->len += n;
+}
+
+/**
+ * Put a little-endian 32-bit value
+ */
+static void put_u32b(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)(v & 0xFF);
+	p[1] = (uint8_t)((v >> 8) & 0xFF);
+	p[2] = (uint8_t)((v >> 16) & 0xFF);
+	p[3] = (uint8_t)((v >> 24) & 0xFF);
+}
+
+/**
+ * Get a little-endian 32-bit value
+ */
+static uint32_t get_u32b(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16)
+		| ((uint32_t)p[3] << 24);
+}
+
+/**
+ * Append the compressed form of a block to a savefile image.  Returns the
+ * compressed size, or 0 (leaving the image as it was) if compressing
+ * doesn't make the block any smaller.
+ */
+static uint32_t image_append_compressed(struct savefile_image *image,
+		const uint8_t *data, uint32_t n)
+{
+	uint32_t nframes = (n + SAVEFILE_FRAME_SIZE - 1) / SAVEFILE_FRAME_SIZE;
+	size_t start = image->len, pos = 0;
+	uint8_t *op = image_reserve(image,
+		4 + nframes * (4 + LZ_BOUND(SAVEFILE_FRAME_SIZE)));
+
+	put_u32b(op, n);
+	op += 4;
+	while (pos < n) {
+		uint32_t len = MIN(n - pos, SAVEFILE_FRAME_SIZE);
+		size_t clen = lz_compress(data + pos, len, op + 4,
+			LZ_BOUND(SAVEFILE_FRAME_SIZE));
+
+		if (clen == 0 || clen >= len) {
+			/* Store frames that don't compress */
+			put_u32b(op, len | SAVEFILE_FRAME_RAW);
+			memcpy(op + 4, data + pos, len);
+			clen = len;
+		} else {
+			put_u32b(op, (uint32_t)clen);
+		}
+		op += 4 + clen;
+		pos += len;
+	}
+
+	if ((size_t)(op - (image->data + start)) >= n) return 0;
+	image->len = op - image->data;
+	return (uint32_t)(image->len - start);
+}
+
+/**
+ * Make a copy of a savefile image with each large block compressed, where
+ * that makes the block smaller.
+ *
+ * This touches no game state, so it is safe to run off the main thread.
+ */
+static void compress_image(const struct savefile_image *image,
+		struct savefile_image *packed)
+{
+	size_t pos = 8;
+
+	packed->size = image->len;
+	packed->data = mem_alloc(packed->size);
+	packed->len = 0;
+	packed->compress = false;
+	image_append(packed, image->data, 8);
+
+	while (pos + SAVEFILE_HEAD_SIZE <= image->len) {
+		const uint8_t *head = image->data + pos;
+		const uint8_t *data = head + SAVEFILE_HEAD_SIZE;
+		uint32_t size = get_u32b(head + 20), packed_size = 0;
+		size_t head_pos = packed->len;
+
+		image_append(packed, head, SAVEFILE_HEAD_SIZE);
+		if (size >= SAVEFILE_COMPRESS_MIN) {
+			packed_size = image_append_compressed(packed, data, size);
+		}
+		if (packed_size) {
+			put_u32b(packed->data + head_pos + 16,
+				get_u32b(head + 16) | SAVEFILE_COMPRESSED);
+			put_u32b(packed->data + head_pos + 20, packed_size);
+		} else {
+			image_append(packed, data, size);
+			packed_size = size;
+		}
+
+		/* pad to 4 byte multiples */
+		if (packed_size % 4) {
+			image_append(packed, "xxx", 4 - (packed_size % 4));
+		}
+
+		pos += SAVEFILE_HEAD_SIZE + size;
+		if (size % 4) pos += 4 - (size % 4);
+	}
+}
+
+/**
+ * Serialise the whole game into memory, laid out exactly as it will be on
+ * disk without compression: the magic and variant bytes followed by every
+ * block with its header and padding.  Compressing the blocks, if the player
+ * wants that, is left to write_image(), so background saves do it on the
+ * writer thread.
+ */
+static void build_image(struct savefile_image *image)
 {
 	uint8_t savefile_head[SAVEFILE_HEAD_SIZE];
-	size_t i, pos;
-	bool success = true;
+	size_t i, pos, head_pos;
+	uint32_t version, size;
+
+	image->size = BUFFER_INITIAL_SIZE * 64;
+	image->data = mem_alloc(image->size);
+	image->len = 0;
+	image->compress = OPT(player, compress_savefile);
+	image_append(image, savefile_magic, 4);
+	image_append(image, savefile_name, 4);
 
 	/* Start off the buffer */
 	buffer = mem_alloc(BUFFER_INITIAL_SIZE);
@@ -338,6 +628,19 @@ static bool try_save(ang_file *file)
 
 		savers[i].save();
 
+		/* Leave room for the header, which needs the stored size */
+		head_pos = image->len;
+		image_append(image, savefile_head, SAVEFILE_HEAD_SIZE);
+
+		version = savers[i].version;
+		size = buffer_pos;
+		image_append(image, buffer, buffer_pos);
+
+		/* pad to 4 byte multiples */
+		if (size % 4) {
+			image_append(image, "xxx", 4 - (size % 4));
+		}
+
 		/* 16-byte block name */
 		pos = my_strcpy((char *)savefile_head,
 				savers[i].name,
@@ -345,66 +648,53 @@ static bool try_save(ang_file *file)
 		while (pos < 16)
 			savefile_head[pos++] = 0;
 
-#define SAVE_U32B(v)	\
-		savefile_head[pos++] = (v & 0xFF); \
-		savefile_head[pos++] = ((v >> 8) & 0xFF); \
-		savefile_head[pos++] = ((v >> 16) & 0xFF); \
-		savefile_head[pos++] = ((v >> 24) & 0xFF);
-
-		SAVE_U32B(savers[i].version);
-		SAVE_U32B(buffer_pos);
-		SAVE_U32B(buffer_check);
-
-		assert(pos == SAVEFILE_HEAD_SIZE);
-
-		if (! file_write(file, (char *)savefile_head,
-				SAVEFILE_HEAD_SIZE)) {
-			success = false;
-		}
-		if (! file_write(file, (char *)buffer, buffer_pos)) {
-			success = false;
-		}
-
-		/* pad to 4 byte multiples */
-		if (buffer_pos % 4) {
-			if (! file_write(file, "xxx", 4 - (buffer_pos % 4))) {
-				success = false;
-			}
-		}
+		put_u32b(savefile_head + 16, version);
+		put_u32b(savefile_head + 20, size);
+		put_u32b(savefile_head + 24, buffer_check);
+		memcpy(image->data + head_pos, savefile_head, SAVEFILE_HEAD_SIZE);
 	}
 
 	mem_free(buffer);
-
-	return success;
+	buffer = NULL;
 }
 
 /**
- * Attempt to save the player in a savefile
+ * Write a savefile image to "<path>.new", sync it to the disk and then move it
+ * over the old savefile, keeping the previous one as "<path>.old" until the
+ * move is done.
+ *
+ * This touches no game state, so it is safe to run off the main thread.
  */
-bool savefile_save(const char *path)
+static bool write_image(const char *path, const struct savefile_image *image)
 {
 	ang_file *file;
 	char new_savefile[1024];
 	char old_savefile[1024];
+	struct savefile_image packed = { NULL, 0, 0, false };
 	bool ok = false;
 
-	/* Generate a CharOutput.txt, mainly for angband.live, when saving. */
-	(void) save_charoutput();
+	/* Compress here rather than in build_image(), off the main thread */
+	if (image->compress) {
+		compress_image(image, &packed);
+		image = &packed;
+	}
 
 	/* New savefile */
 	safe_setuid_grab();
 	file_get_savefile(old_savefile, sizeof(old_savefile), path, "old");
 
 	/* Open the savefile */
-        file_get_savefile(new_savefile, sizeof(new_savefile), path, "new");
+	file_get_savefile(new_savefile, sizeof(new_savefile), path, "new");
 
 	file = file_open(new_savefile, MODE_WRITE, FTYPE_SAVE);
 	safe_setuid_drop();
 
 	if (file) {
-		if (file_write(file, (char*)&savefile_magic, 4)
-				&& file_write(file, (char*)&savefile_name, 4)) {
-			ok = try_save(file);
+		ok = file_write(file, (const char *)image->data, image->len);
+
+		/* Be sure the new file is on disk before it replaces the old */
+		if (ok && !file_sync(file)) {
+			ok = false;
 		}
 		if (!file_close(file)) {
 			ok = false;
@@ -412,12 +702,6 @@ bool savefile_save(const char *path)
 	}
 
 	if (ok) {
-		/*
-		 * Moving the files about, if interrupted, could leave no save
-		 * file in place.
-		 */
-		character_saved = false;
-
 		safe_setuid_grab();
 
 		if (file_exists(path) && !file_move(path, old_savefile)) {
@@ -430,21 +714,168 @@ bool savefile_save(const char *path)
 		} 
 
 		safe_setuid_drop();
-
-		character_saved = ok;
-
-		return ok;
-	}
-
-	/* Delete temp file if the save failed */
-	if (file) {
+	} else if (file) {
+		/* Delete temp file if the save failed */
 		/* File is no longer valid, but it still points to a non zero
 		 * value if the file was created above */
 		safe_setuid_grab();
 		file_delete(new_savefile);
 		safe_setuid_drop();
 	}
+
+	mem_free(packed.data);
+	return ok;
+}
+
+#ifdef SAVEFILE_BACKGROUND
+
+/**
+ * The one background save that may be in flight.  Only the main thread
+ * touches these, apart from the job itself, which belongs to the writer
+ * thread between pthread_create() and pthread_join().
+ */
+static struct {
+	char *path;
+	struct savefile_image image;
+	bool ok;
+} save_job;
+static pthread_t save_thread;
+static bool save_pending;
+static bool save_failed;
+
+/**
+ * Set by the writer thread once it is done, so the main thread can tell
+ * without blocking
+ */
+static pthread_mutex_t save_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool save_written;
+
+static void *save_thread_main(void *unused)
+{
+	(void) unused;
+	save_job.ok = write_image(save_job.path, &save_job.image);
+	pthread_mutex_lock(&save_lock);
+	save_written = true;
+	pthread_mutex_unlock(&save_lock);
+	return NULL;
+}
+
+#endif /* SAVEFILE_BACKGROUND */
+
+/**
+ * Check whether a background save is still being written; once it isn't,
+ * savefile_wait() collects its result without blocking.
+ */
+bool savefile_busy(void)
+{
+#ifdef SAVEFILE_BACKGROUND
+	bool written;
+
+	if (!save_pending) return false;
+	pthread_mutex_lock(&save_lock);
+	written = save_written;
+	pthread_mutex_unlock(&save_lock);
+	return !written;
+#else
 	return false;
+#endif
+}
+
+/**
+ * Wait for any background save to reach the disk.
+ *
+ * Returns false if a background save has failed since the last call.
+ */
+bool savefile_wait(void)
+{
+#ifdef SAVEFILE_BACKGROUND
+	bool ok = !save_failed;
+
+	if (save_pending) {
+		pthread_join(save_thread, NULL);
+		save_pending = false;
+		save_written = false;
+		if (!save_job.ok) ok = false;
+		mem_free(save_job.image.data);
+		string_free(save_job.path);
+		memset(&save_job, 0, sizeof(save_job));
+	}
+	save_failed = false;
+	return ok;
+#else
+	return true;
+#endif
+}
+
+/**
+ * Attempt to save the player in a savefile
+ */
+bool savefile_save(const char *path)
+{
+	struct savefile_image image;
+	bool ok;
+
+	/* Don't let an earlier background save land on top of this one */
+	(void) savefile_wait();
+
+	/* Generate a CharOutput.txt, mainly for angband.live, when saving. */
+	(void) save_charoutput();
+
+	build_image(&image);
+
+	/*
+	 * Moving the files about, if interrupted, could leave no save
+	 * file in place.
+	 */
+	character_saved = false;
+	ok = write_image(path, &image);
+	character_saved = ok;
+
+	mem_free(image.data);
+	return ok;
+}
+
+/**
+ * Save the player in the background: the game is serialised into memory
+ * here, and the file is written and moved into place by a separate thread
+ * so play can carry on in the meantime.  savefile_wait() collects the
+ * result.  Where threads aren't available this is the same as
+ * savefile_save().
+ *
+ * Any save still in flight is waited for first; call savefile_wait() before
+ * this to find out how that went.  Returns false if the save was done in the
+ * foreground and failed.
+ */
+bool savefile_save_background(const char *path)
+{
+#ifdef SAVEFILE_BACKGROUND
+	bool ok;
+
+	(void) savefile_wait();
+	(void) save_charoutput();
+
+	build_image(&save_job.image);
+	save_job.path = string_make(path);
+	save_job.ok = false;
+
+	/* Nothing is on disk yet, so a panic save is still worth doing */
+	character_saved = false;
+
+	if (pthread_create(&save_thread, NULL, save_thread_main, NULL) == 0) {
+		save_pending = true;
+		return true;
+	}
+
+	/* No thread, so write it here */
+	ok = write_image(save_job.path, &save_job.image);
+	character_saved = ok;
+	mem_free(save_job.image.data);
+	string_free(save_job.path);
+	memset(&save_job, 0, sizeof(save_job));
+	return ok;
+#else
+	return savefile_save(path);
+#endif
 }
 
 
@@ -492,6 +923,8 @@ static errr next_blockheader(ang_file *f, struct blockheader *b) {
 	my_strcpy(b->name, (char *)&savefile_head, sizeof b->name);
 	b->version = RECONSTRUCT_U32B(16);
 	b->size = RECONSTRUCT_U32B(20);
+	b->compressed = (b->version & SAVEFILE_COMPRESSED) != 0;
+	b->version &= ~SAVEFILE_COMPRESSED;
 
 	/* Pad to 4 bytes */
 	if (b->size % 4)
@@ -519,25 +952,79 @@ static loader_t find_loader(struct blockheader *b,
 	return NULL;
 }
 
+/**
+ * Read a compressed block into the buffer, a frame at a time
+ */
+static bool read_compressed_block(ang_file *f, struct blockheader *b)
+{
+	uint8_t head[4];
+	uint8_t *frame;
+	uint32_t left = b->size, pos = 0;
+
+	if (left < 4 || file_read(f, (char *)head, 4) != 4) return false;
+	left -= 4;
+
+	/* Nothing compresses by more than 255 to 1 */
+	buffer_size = get_u32b(head);
+	if (buffer_size / 255 > b->size) return false;
+	buffer = mem_alloc(buffer_size);
+
+	frame = mem_alloc(LZ_BOUND(SAVEFILE_FRAME_SIZE));
+	while (pos < buffer_size) {
+		uint32_t len = MIN(buffer_size - pos, SAVEFILE_FRAME_SIZE);
+		uint32_t clen;
+
+		if (left < 4 || file_read(f, (char *)head, 4) != 4) break;
+		left -= 4;
+		clen = get_u32b(head) & ~SAVEFILE_FRAME_RAW;
+		if (clen > left) break;
+		left -= clen;
+
+		if (get_u32b(head) & SAVEFILE_FRAME_RAW) {
+			if (clen != len || file_read(f, (char *)buffer + pos, len)
+					!= (int)len)
+				break;
+		} else {
+			if (clen > LZ_BOUND(SAVEFILE_FRAME_SIZE)
+					|| file_read(f, (char *)frame, clen) != (int)clen
+					|| !lz_decompress(frame, clen, buffer + pos, len))
+				break;
+		}
+		pos += len;
+	}
+	mem_free(frame);
+
+	/* Only the padding should be left */
+	if (pos != buffer_size || left >= 4) return false;
+	return left == 0 || file_skip(f, left);
+}
+
 /**
  * Load a given block with the given loader
  */
 static bool load_block(ang_file *f, struct blockheader *b, loader_t loader)
 {
-	/* Allocate space for the buffer */
-	buffer = mem_alloc(b->size);
+	bool ok;
+
+	if (b->compressed) {
+		buffer = NULL;
+		ok = read_compressed_block(f, b);
+	} else {
+		/* Allocate space for the buffer */
+		buffer = mem_alloc(b->size);
+		buffer_size = file_read(f, (char *) buffer, b->size);
+		ok = (buffer_size == b->size);
+	}
 	buffer_pos = 0;
 	buffer_check = 0;
 
-	buffer_size = file_read(f, (char *) buffer, b->size);
-	if (buffer_size != b->size ||
-			loader() != 0) {
-		mem_free(buffer);
-		return false;
+	if (ok && loader() != 0) {
+		ok = false;
 	}
 
 	mem_free(buffer);
-	return true;
+	buffer = NULL;
+	return ok;
 }
 
 /**
@@ -633,6 +1120,9 @@ bool savefile_load(const char *path, bool cheat_death)
 	bool ok;
 	ang_file *f;
 
+	/* Don't read a savefile that is still being written */
+	(void) savefile_wait();
+
 	safe_setuid_grab();
 	f = file_open(path, MODE_READ, FTYPE_TEXT);
 	safe_setuid_drop();
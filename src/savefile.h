@@ -37,6 +37,23 @@ extern bool character_saved;
  */
 bool savefile_save(const char *path);
 
+/**
+ * Save to the given location, writing the file out in the background where
+ * possible.  Returns false if a save done in the foreground failed.
+ */
+bool savefile_save_background(const char *path);
+
+/**
+ * Wait for a background save to finish.  Returns false if one has failed
+ * since the last call.
+ */
+bool savefile_wait(void);
+
+/**
+ * Check, without waiting, whether a background save is still being written.
+ */
+bool savefile_busy(void);
+
 /**
  * Load the savefile given.  Returns true on succcess, false otherwise.
  */
@@ -69,6 +86,8 @@ void wr_s16b(int16_t v);
 void wr_u32b(uint32_t v);
 void wr_s32b(int32_t v);
 void wr_string(const char *str);
+void wr_bytes(const uint8_t *src, uint32_t n);
+void wr_rle(const uint8_t *src, size_t n, size_t stride);
 void pad_bytes(int n);
 
 /* Reading bits */
@@ -78,6 +97,8 @@ void rd_s16b(int16_t *ip);
 void rd_u32b(uint32_t *ip);
 void rd_s32b(int32_t *ip);
 void rd_string(char *str, int max);
+void rd_bytes(uint8_t *dst, uint32_t n);
+void rd_rle(uint8_t *dst, size_t n, size_t stride);
 void strip_bytes(int n);
 
 
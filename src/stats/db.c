@@ -32,6 +32,31 @@
 static sqlite3 *db;
 static char *ANGBAND_DIR_STATS;
 static char *db_filename;
+static int db_flags;
+
+/**
+ * Most rows a bulk writer puts in one INSERT statement; also limited so the
+ * statement stays within SQLite's default limit of 999 parameters
+ */
+#define STATS_DB_MAX_ROWS 64
+#define STATS_DB_MAX_PARAMS 999
+
+/**
+ * A bulk writer for one table of integers.  Rows are buffered and written
+ * STATS_DB_MAX_ROWS (or fewer) at a time with a multi-row INSERT, or as lines
+ * of a CSV file when the database was opened with STATS_DB_CSV.
+ */
+struct stats_db_writer {
+	char *table;		/**< name of the table */
+	char *columns;		/**< comma-separated column names */
+	int num_cols;		/**< number of columns */
+	int max_rows;		/**< rows in a full multi-row INSERT */
+	int num_rows;		/**< rows buffered so far */
+	int *rows;		/**< buffered values, row by row */
+	sqlite3_stmt *full;	/**< INSERT for max_rows rows */
+	sqlite3_stmt *single;	/**< INSERT for one row */
+	ang_file *csv;		/**< CSV output, if any */
+};
 
 /**
  * Utility functions
@@ -57,7 +82,7 @@ static bool stats_make_output_dir(void) {
  * Call stats_db_open first to create the database file and set up a 
  * database connection. Returns true on success, false on failure.
  */
-bool stats_db_open(void) {
+bool stats_db_open(int flags) {
 	size_t size;
 	char filename_buf[20];
 	int result;
@@ -84,7 +109,22 @@ bool stats_db_open(void) {
 		sqlite3_close(db);
 		return false;
 	}
-	
+
+	/* Trade safety against crashes for speed */
+	if (flags & STATS_DB_FAST) {
+		result = sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL,
+			NULL);
+		if (!result) {
+			result = sqlite3_exec(db, "PRAGMA synchronous=OFF;", NULL,
+				NULL, NULL);
+		}
+		if (result) {
+			sqlite3_close(db);
+			return false;
+		}
+	}
+	db_flags = flags;
+
 	return true;	
 }
 
@@ -172,6 +212,196 @@ int stats_db_bind_rv(sqlite3_stmt *sql_stmt, int col, random_value rv) {
 		SQLITE_STATIC);
 }
 
+/**
+ * Prepare an INSERT of num_rows rows into a writer's table.
+ */
+static int stats_db_writer_prep(struct stats_db_writer *w, int num_rows,
+		sqlite3_stmt **stmt)
+{
+	size_t size = strlen(w->table) + 32
+		+ (size_t)num_rows * (2 * w->num_cols + 3);
+	char *sql = mem_alloc(size);
+	size_t len;
+	int err, i, j;
+
+	len = strnfmt(sql, size, "INSERT INTO %s VALUES", w->table);
+	for (i = 0; i < num_rows; i++) {
+		sql[len++] = i ? ',' : ' ';
+		sql[len++] = '(';
+		for (j = 0; j < w->num_cols; j++) {
+			if (j) sql[len++] = ',';
+			sql[len++] = '?';
+		}
+		sql[len++] = ')';
+	}
+	sql[len++] = ';';
+	sql[len] = '\0';
+
+	err = stats_db_stmt_prep(stmt, sql);
+	mem_free(sql);
+	return err;
+}
+
+/**
+ * Write out the first num_rows buffered rows with the statement stmt.
+ */
+static int stats_db_writer_step(struct stats_db_writer *w, sqlite3_stmt *stmt,
+		int first, int num_rows)
+{
+	const int *v = w->rows + (size_t)first * w->num_cols;
+	int n = num_rows * w->num_cols;
+	int err, i;
+
+	for (i = 0; i < n; i++) {
+		err = sqlite3_bind_int(stmt, i + 1, v[i]);
+		if (err) return err;
+	}
+	STATS_DB_STEP_RESET(stmt)
+	return SQLITE_OK;
+}
+
+/**
+ * Write out the buffered rows of a writer.
+ */
+static int stats_db_writer_flush(struct stats_db_writer *w)
+{
+	int err, i;
+
+	if (w->csv) {
+		const int *v = w->rows;
+		char line[256];
+
+		for (i = 0; i < w->num_rows; i++) {
+			size_t len = 0;
+			int j;
+
+			for (j = 0; j < w->num_cols; j++, v++) {
+				len += strnfmt(line + len, sizeof(line) - len,
+					j ? ",%d" : "%d", *v);
+			}
+			file_putf(w->csv, "%s\n", line);
+		}
+	} else if (w->num_rows == w->max_rows) {
+		err = stats_db_writer_step(w, w->full, 0, w->num_rows);
+		if (err) return err;
+	} else {
+		for (i = 0; i < w->num_rows; i++) {
+			err = stats_db_writer_step(w, w->single, i, 1);
+			if (err) return err;
+		}
+	}
+	w->num_rows = 0;
+
+	return SQLITE_OK;
+}
+
+/**
+ * Create a bulk writer for the table, which has the columns listed, by name
+ * and separated by commas, in columns; all the columns must be integers.
+ * The statements are prepared once, here, and reused for every dump.
+ * Returns NULL on failure.
+ */
+struct stats_db_writer *stats_db_writer_new(const char *table,
+		const char *columns)
+{
+	struct stats_db_writer *w = mem_zalloc(sizeof(*w));
+	const char *c;
+
+	w->table = string_make(table);
+	w->columns = string_make(columns);
+	w->num_cols = 1;
+	for (c = columns; *c; c++) {
+		if (*c == ',') w->num_cols++;
+	}
+	w->max_rows = MIN(STATS_DB_MAX_ROWS, STATS_DB_MAX_PARAMS / w->num_cols);
+	w->rows = mem_alloc((size_t)w->max_rows * w->num_cols
+		* sizeof(*w->rows));
+	if (!(db_flags & STATS_DB_CSV)
+			&& (stats_db_writer_prep(w, w->max_rows, &w->full)
+			|| stats_db_writer_prep(w, 1, &w->single))) {
+		stats_db_writer_free(w);
+		return NULL;
+	}
+	return w;
+}
+
+/**
+ * Start a fresh dump of a writer's table, discarding what an earlier dump
+ * wrote, so the table can be refilled with plain inserts.  Call within a
+ * transaction.
+ */
+int stats_db_writer_begin(struct stats_db_writer *w)
+{
+	char buf[1024];
+
+	w->num_rows = 0;
+	if (db_flags & STATS_DB_CSV) {
+		size_t len = strlen(db_filename);
+
+		/* Replace the database's ".db" with "-table.csv" */
+		if (len > 3) len -= 3;
+		strnfmt(buf, sizeof(buf), "%.*s-%s.csv", (int)len, db_filename,
+			w->table);
+		if (w->csv) file_close(w->csv);
+		w->csv = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+		if (!w->csv) return SQLITE_CANTOPEN;
+		file_putf(w->csv, "%s\n", w->columns);
+		return SQLITE_OK;
+	}
+
+	strnfmt(buf, sizeof(buf), "DELETE FROM %s;", w->table);
+	return stats_db_exec(buf);
+}
+
+/**
+ * Add a row to a writer's table.  The arguments after w are the values for
+ * the row's columns, as ints, in order.
+ */
+int stats_db_writer_add(struct stats_db_writer *w, ...)
+{
+	int *v = w->rows + (size_t)w->num_rows * w->num_cols;
+	va_list vp;
+	int i;
+
+	va_start(vp, w);
+	for (i = 0; i < w->num_cols; i++) {
+		v[i] = va_arg(vp, int);
+	}
+	va_end(vp);
+
+	if (++w->num_rows == w->max_rows) return stats_db_writer_flush(w);
+	return SQLITE_OK;
+}
+
+/**
+ * Finish a dump of a writer's table, writing out any rows still buffered.
+ */
+int stats_db_writer_end(struct stats_db_writer *w)
+{
+	int err = stats_db_writer_flush(w);
+
+	if (w->csv) {
+		if (!file_close(w->csv) && !err) err = SQLITE_IOERR;
+		w->csv = NULL;
+	}
+	return err;
+}
+
+/**
+ * Free a writer and its statements; do so before stats_db_close().
+ */
+void stats_db_writer_free(struct stats_db_writer *w)
+{
+	if (!w) return;
+	if (w->csv) file_close(w->csv);
+	sqlite3_finalize(w->full);
+	sqlite3_finalize(w->single);
+	mem_free(w->rows);
+	string_free(w->columns);
+	string_free(w->table);
+	mem_free(w);
+}
+
 /**
  * I have chosen not to wrap the other sqlite3 core interfaces, since
  * they do not require access to the database connection object db.
@@ -41,7 +41,18 @@
 	err = sqlite3_finalize(s);\
 	if (err) return err;
 
-extern bool stats_db_open(void);
+/**
+ * Options for stats_db_open():  STATS_DB_FAST uses a write-ahead log and
+ * no syncs, which is quicker but risks the database if the machine crashes;
+ * STATS_DB_CSV has the bulk writers put their tables in CSV files next to
+ * the database rather than in the database itself.
+ */
+#define STATS_DB_FAST	0x01
+#define STATS_DB_CSV	0x02
+
+struct stats_db_writer;
+
+extern bool stats_db_open(int flags);
 extern bool stats_db_close(void);
 extern int stats_db_exec(const char *sql_str);
 extern int stats_db_stmt_prep(sqlite3_stmt **sql_stmt, const char *sql_str);
@@ -49,5 +60,11 @@ extern int stats_db_bind_ints(sqlite3_stmt *sql_stmt, int num_cols,
 							  int offset, ...);
 extern int stats_db_bind_rv(sqlite3_stmt *sql_stmt, int col,
 							random_value rv);
+extern struct stats_db_writer *stats_db_writer_new(const char *table,
+		const char *columns);
+extern int stats_db_writer_begin(struct stats_db_writer *w);
+extern int stats_db_writer_add(struct stats_db_writer *w, ...);
+extern int stats_db_writer_end(struct stats_db_writer *w);
+extern void stats_db_writer_free(struct stats_db_writer *w);
 
 #endif /* STATS_DB_H */
@@ -0,0 +1,292 @@
+/* cave/generate */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "game-event.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "monster.h"
+#include "obj-util.h"
+#include "player-birth.h"
+#include "player-util.h"
+
+/**
+ * What the generation events said about the levels built
+ */
+struct gen_record {
+	int starts;
+	int restarts;
+	int successes;
+	int phases_in_attempt;
+	int attempts_without_phases;
+	int bad_phases;
+	int phase_count[GEN_PHASE_MAX];
+};
+
+static void record_start(game_event_type type, game_event_data *data,
+		void *user) {
+	struct gen_record *r = user;
+
+	r->starts++;
+	r->phases_in_attempt = 0;
+}
+
+static void record_end(game_event_type type, game_event_data *data,
+		void *user) {
+	struct gen_record *r = user;
+
+	if (data->flag) r->successes++;
+	if (!r->phases_in_attempt) r->attempts_without_phases++;
+}
+
+static void record_restart(game_event_type type, game_event_data *data,
+		void *user) {
+	struct gen_record *r = user;
+
+	if (data->string && data->string[0]) r->restarts++;
+}
+
+static void record_phase(game_event_type type, game_event_data *data,
+		void *user) {
+	struct gen_record *r = user;
+
+	if (data->phase.phase < 0 || data->phase.phase >= GEN_PHASE_MAX) {
+		r->bad_phases++;
+	} else {
+		r->phase_count[data->phase.phase]++;
+	}
+	r->phases_in_attempt++;
+}
+
+/**
+ * Add up the terrain, objects and monsters of a level and where the player
+ * is on it
+ */
+static uint32_t level_checksum(struct chunk *c, struct player *p)
+{
+	uint32_t sum = 0;
+	int x, y, i;
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			struct loc grid = loc(x, y);
+			struct object *obj;
+
+			sum = sum * 31 + square(c, grid)->feat;
+			for (obj = square_object(c, grid); obj; obj = obj->next) {
+				sum = sum * 31 + obj->kind->kidx;
+			}
+		}
+	}
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+
+		if (mon->race) sum = sum * 31 + mon->race->ridx + mon->hp;
+	}
+	return sum * 31 + p->grid.x * 257 + p->grid.y;
+}
+
+/**
+ * Add up the monster race counts
+ */
+static int race_count(void)
+{
+	int i, n = 0;
+
+	for (i = 0; i < z_info->r_max; i++) {
+		n += r_info[i].cur_num;
+	}
+	return n;
+}
+
+/**
+ * Move the player onto a down staircase of the current level
+ */
+static bool stand_on_down_stairs(struct player *p)
+{
+	int x, y;
+
+	for (y = 0; y < cave->height; y++) {
+		for (x = 0; x < cave->width; x++) {
+			struct loc grid = loc(x, y);
+
+			if (!square_isdownstairs(cave, grid)) continue;
+			if (square_monster(cave, grid)) continue;
+			square_set_mon(cave, p->grid, 0);
+			player_place(cave, p, grid);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Take the stairs down as do_cmd_go_down() does
+ */
+static void go_down(struct player *p)
+{
+	p->upkeep->create_up_stair = true;
+	p->upkeep->create_down_stair = false;
+	dungeon_change_level(p, p->depth + 1);
+	prepare_next_level(p);
+}
+
+int setup_tests(void **state) {
+	set_file_paths();
+	init_angband();
+#ifdef UNIX
+	/* Necessary for creating the randart file. */
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+static int test_phases(void *state) {
+	struct gen_record r;
+	int depth, i;
+
+	memset(&r, 0, sizeof(r));
+	event_add_handler(EVENT_GEN_LEVEL_START, record_start, &r);
+	event_add_handler(EVENT_GEN_LEVEL_END, record_end, &r);
+	event_add_handler(EVENT_GEN_LEVEL_RESTART, record_restart, &r);
+	event_add_handler(EVENT_GEN_PHASE_END, record_phase, &r);
+	for (depth = 1; depth <= 40; depth++) {
+		player->depth = depth;
+		prepare_next_level(player);
+	}
+	event_remove_handler(EVENT_GEN_PHASE_END, record_phase, &r);
+	event_remove_handler(EVENT_GEN_LEVEL_RESTART, record_restart, &r);
+	event_remove_handler(EVENT_GEN_LEVEL_END, record_end, &r);
+	event_remove_handler(EVENT_GEN_LEVEL_START, record_start, &r);
+
+	/* Every attempt either succeeded or said why it was abandoned */
+	eq(r.successes, 40);
+	eq(r.starts, r.successes + r.restarts);
+
+	/* Every attempt was timed, and every phase was seen */
+	eq(r.attempts_without_phases, 0);
+	eq(r.bad_phases, 0);
+	for (i = 0; i < GEN_PHASE_MAX; i++) {
+		require(r.phase_count[i] > 0);
+		notnull(gen_phase_name(i));
+	}
+	null(gen_phase_name(GEN_PHASE_MAX));
+	ok;
+}
+
+static int test_overflow(void *state) {
+	struct chunk *c = cave_new(10, 10);
+
+	eq(monsters_overflowed(c), false);
+	c->mon_max = z_info->level_monster_max - 1;
+	eq(monsters_overflowed(c), false);
+	c->mon_max = z_info->level_monster_max;
+	eq(monsters_overflowed(c), true);
+	c->mon_max = 1;
+	cave_free(c);
+	ok;
+}
+
+static int test_pregenerate(void *state) {
+	struct gen_record r;
+	struct rng_state rng;
+	struct chunk *old_cave;
+	struct loc grid;
+	uint32_t with, without, built, used, built_now, used_now;
+	int32_t old_turn;
+	int count;
+
+	player->opts.opt[OPT_pregenerate_levels] = true;
+	memset(&r, 0, sizeof(r));
+
+	/* Build the level below ahead of time, changing nothing */
+	player->depth = 5;
+	prepare_next_level(player);
+	require(stand_on_down_stairs(player));
+	grid = player->grid;
+	old_cave = cave;
+	rng = *rng_default();
+	count = race_count();
+	pregenerate_counts(&built, &used);
+	event_add_handler(EVENT_GEN_LEVEL_START, record_start, &r);
+	event_add_handler(EVENT_GEN_LEVEL_END, record_end, &r);
+	pregenerate_level(player);
+	eq(r.starts, 0);
+	eq(r.successes, 0);
+	ptreq(cave, old_cave);
+	require(loc_eq(player->grid, grid));
+	eq(player->depth, 5);
+	eq(race_count(), count);
+	require(!memcmp(&rng, rng_default(), sizeof(rng)));
+
+	/* Waiting on the stairs doesn't build it again */
+	old_turn = turn;
+	turn += 100;
+	pregenerate_level(player);
+	turn = old_turn;
+	pregenerate_counts(&built_now, &used_now);
+	eq(built_now, built + 1);
+	eq(used_now, used);
+
+	/* Taking the stairs uses it, and reports it as built then */
+	go_down(player);
+	event_remove_handler(EVENT_GEN_LEVEL_END, record_end, &r);
+	event_remove_handler(EVENT_GEN_LEVEL_START, record_start, &r);
+	require(r.starts > 0);
+	eq(r.successes, 1);
+	eq(player->depth, 6);
+	pregenerate_counts(&built_now, &used_now);
+	eq(used_now, used + 1);
+	with = level_checksum(cave, player);
+
+	/* Building the level on arrival instead gives the same level */
+	r.starts = 0;
+	player->depth = 5;
+	prepare_next_level(player);
+	require(stand_on_down_stairs(player));
+	require(loc_eq(player->grid, grid));
+	event_add_handler(EVENT_GEN_LEVEL_START, record_start, &r);
+	go_down(player);
+	event_remove_handler(EVENT_GEN_LEVEL_START, record_start, &r);
+	require(r.starts > 0);
+	without = level_checksum(cave, player);
+	eq(with, without);
+
+	/* Arriving some other way means it is not used */
+	player->depth = 5;
+	prepare_next_level(player);
+	require(stand_on_down_stairs(player));
+	pregenerate_level(player);
+	r.starts = 0;
+	event_add_handler(EVENT_GEN_LEVEL_START, record_start, &r);
+	player->upkeep->create_up_stair = false;
+	player->upkeep->create_down_stair = false;
+	dungeon_change_level(player, 6);
+	prepare_next_level(player);
+	event_remove_handler(EVENT_GEN_LEVEL_START, record_start, &r);
+	require(r.starts > 0);
+
+	player->opts.opt[OPT_pregenerate_levels] = false;
+	ok;
+}
+
+const char *suite_name = "cave/generate";
+struct test tests[] = {
+	{ "phases", test_phases },
+	{ "overflow", test_overflow },
+	{ "pregenerate", test_pregenerate },
+	{ NULL, NULL }
+};
@@ -0,0 +1,138 @@
+/* cave/paths */
+/*
+ * Check that the los() and projectable() results kept for paths to and from
+ * the player match those worked out afresh.  Run with -v to see how often
+ * the kept results were used.
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-util.h"
+#include "player-birth.h"
+#include "player-timed.h"
+#include "player-util.h"
+#include "project.h"
+
+int setup_tests(void **state) {
+	set_file_paths();
+	init_angband();
+#ifdef UNIX
+	/* Necessary for creating the randart file. */
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/**
+ * Compare every path between the player and the grids of the level with
+ * the same path on a copy of the terrain, which keeps no results
+ */
+static bool paths_match(struct chunk *copy)
+{
+	struct loc pgrid = player->grid, grid;
+
+	for (grid.y = 0; grid.y < cave->height; grid.y++) {
+		for (grid.x = 0; grid.x < cave->width; grid.x++) {
+			if (los(cave, pgrid, grid) != los(copy, pgrid, grid))
+				return false;
+			if (los(cave, grid, pgrid) != los(copy, grid, pgrid))
+				return false;
+			if (projectable(cave, pgrid, grid, PROJECT_NONE) !=
+					projectable(copy, pgrid, grid, PROJECT_NONE))
+				return false;
+			if (projectable(cave, grid, pgrid, PROJECT_SHORT) !=
+					projectable(copy, grid, pgrid, PROJECT_SHORT))
+				return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Find an open grid some way from the player
+ */
+static struct loc open_grid(int dist)
+{
+	struct loc grid;
+
+	for (grid.y = 1; grid.y < cave->height - 1; grid.y++) {
+		for (grid.x = 1; grid.x < cave->width - 1; grid.x++) {
+			if (distance(grid, player->grid) == dist &&
+					square_isempty(cave, grid)) {
+				return grid;
+			}
+		}
+	}
+	return player->grid;
+}
+
+static int test_player_paths(void *state) {
+	struct chunk *copy;
+	struct loc grid;
+	uint32_t hits, misses, old_hits, old_misses;
+
+	player->depth = 10;
+	prepare_next_level(player);
+	copy = chunk_write(cave);
+	player_path_counts(&old_hits, &old_misses);
+
+	/* Results are worked out, then used */
+	require(paths_match(copy));
+	player_path_counts(&hits, &misses);
+	require(misses > old_misses);
+	old_hits = hits;
+	old_misses = misses;
+	require(paths_match(copy));
+	player_path_counts(&hits, &misses);
+	require(hits > old_hits);
+	eq(misses, old_misses);
+
+	/* Shortened range has its own results */
+	player->timed[TMD_COVERTRACKS] = 1;
+	require(paths_match(copy));
+	player->timed[TMD_COVERTRACKS] = 0;
+
+	/* Changing the terrain throws them away */
+	grid = open_grid(3);
+	require(!loc_eq(grid, player->grid));
+	square_set_feat(cave, grid, FEAT_GRANITE);
+	square_set_feat(copy, grid, FEAT_GRANITE);
+	require(paths_match(copy));
+
+	/* So does the player moving */
+	grid = open_grid(5);
+	require(!loc_eq(grid, player->grid));
+	monster_swap(player->grid, grid);
+	require(paths_match(copy));
+
+	if (verbose) {
+		player_path_counts(&hits, &misses);
+		printf("\n    %u of %u path lookups answered (%.1f%%)",
+			hits, hits + misses, 100.0 * hits / (hits + misses));
+		printf("\n  %-16s  ", "");
+	}
+
+	cave_free(copy);
+	ok;
+}
+
+const char *suite_name = "cave/paths";
+struct test tests[] = {
+	{ "player_paths", test_player_paths },
+	{ NULL, NULL }
+};
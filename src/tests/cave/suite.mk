@@ -1,3 +1,5 @@
 TESTPROGS += \
 	cave/find \
+	cave/generate \
+	cave/paths \
 	cave/scatter
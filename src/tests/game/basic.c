@@ -80,6 +80,8 @@ int setup_tests(void **state) {
 
 int teardown_tests(void *state) {
 	file_delete("Test1");
+	file_delete("Test2");
+	file_delete("Test3");
 	wipe_mon_list(cave, player);
 	cleanup_angband();
 	return 0;
@@ -120,6 +122,59 @@ static int test_loadgame(void *state) {
 	ok;
 }
 
+static int test_backgroundsave(void *state) {
+	/* Save in the background and wait for it to land */
+	eq(savefile_save_background("Test2"), true);
+	while (savefile_busy()) {
+		/* The writer thread lets us know when it is done */
+	}
+	eq(file_exists("Test2"), true);
+	eq(savefile_wait(), true);
+	eq(savefile_busy(), false);
+
+	/* It should load just like a foreground save */
+	reset_before_load();
+	eq(savefile_load("Test2", false), true);
+	eq(player->is_dead, false);
+	notnull(cave);
+	eq(player->chp, player->mhp);
+
+	ok;
+}
+
+/**
+ * Get the size of a file, or -1 if it can't be read
+ */
+static long size_of_file(const char *path) {
+	FILE *f = fopen(path, "rb");
+	long size = -1;
+
+	if (f) {
+		if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+		fclose(f);
+	}
+	return size;
+}
+
+static int test_uncompressedsave(void *state) {
+	/* Save without compression; it is bigger, but loads the same */
+	player->opts.opt[OPT_compress_savefile] = false;
+	eq(savefile_save("Test3"), true);
+	player->opts.opt[OPT_compress_savefile] = true;
+	eq(savefile_save("Test2"), true);
+	require(size_of_file("Test3") > size_of_file("Test2"));
+
+	reset_before_load();
+	eq(savefile_load("Test3", false), true);
+	eq(player->is_dead, false);
+	notnull(cave);
+	eq(player->chp, player->mhp);
+	eq(OPT(player, compress_savefile), false);
+	player->opts.opt[OPT_compress_savefile] = true;
+
+	ok;
+}
+
 static int test_stairs1(void *state) {
 	reset_before_load();
 
@@ -254,6 +309,8 @@ const char *suite_name = "game/basic";
 struct test tests[] = {
 	{ "newgame", test_newgame },
 	{ "loadgame", test_loadgame },
+	{ "backgroundsave", test_backgroundsave },
+	{ "uncompressedsave", test_uncompressedsave },
 	{ "stairs1", test_stairs1 },
 	{ "stairs2", test_stairs2 },
 	{ "droppickup", test_drop_pickup },
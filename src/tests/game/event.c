@@ -0,0 +1,163 @@
+/* game/event */
+
+#include "unit-test.h"
+#include "game-event.h"
+#include "z-virt.h"
+
+struct event_record {
+	int points;
+	int regions;
+	int refreshes;
+	char strings[32];
+};
+
+static void record_point(game_event_type type, game_event_data *data,
+		void *user) {
+	struct event_record *r = user;
+
+	r->points++;
+}
+
+static void record_region(game_event_type type, game_event_data *data,
+		void *user) {
+	struct event_record *r = user;
+
+	/* The region arrives before the refresh it belongs to */
+	if (r->refreshes == r->regions) {
+		r->regions++;
+	}
+}
+
+static void record_refresh(game_event_type type, game_event_data *data,
+		void *user) {
+	struct event_record *r = user;
+
+	r->refreshes++;
+}
+
+static void record_string(game_event_type type, game_event_data *data,
+		void *user) {
+	struct event_record *r = user;
+
+	my_strcat(r->strings, data->string, sizeof(r->strings));
+}
+
+int setup_tests(void **state) {
+	struct event_record *r = mem_zalloc(sizeof(*r));
+
+	*state = r;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	event_remove_all_handlers();
+	mem_free(state);
+	return 0;
+}
+
+static int test_has_handlers(void *state) {
+	struct event_record *r = state;
+
+	require(!event_has_handlers(EVENT_MAP));
+	require(!event_has_handlers(EVENT_END));
+	event_add_handler(EVENT_MAP, record_point, r);
+	event_add_handler(EVENT_END, record_point, r);
+	require(event_has_handlers(EVENT_MAP));
+	require(event_has_handlers(EVENT_END));
+	require(!event_has_handlers(EVENT_MAP_REGION));
+	event_signal_point(EVENT_MAP, 3, 4);
+	eq(r->points, 1);
+
+	event_remove_handler(EVENT_MAP, record_point, r);
+	require(!event_has_handlers(EVENT_MAP));
+	event_signal_point(EVENT_MAP, 3, 4);
+	eq(r->points, 1);
+	event_remove_handler_type(EVENT_END);
+	require(!event_has_handlers(EVENT_END));
+	r->points = 0;
+	ok;
+}
+
+static int test_regions(void *state) {
+	struct event_record *r = state;
+
+	event_add_handler(EVENT_MAP, record_point, r);
+	event_add_handler(EVENT_MAP_REGION, record_region, r);
+	event_add_handler(EVENT_REFRESH, record_refresh, r);
+
+	/* Nothing changed, so no region */
+	event_signal(EVENT_REFRESH);
+	eq(r->refreshes, 1);
+	eq(r->regions, 0);
+
+	/* Points are still sent, and gathered into one signal */
+	r->refreshes = 0;
+	event_signal_point(EVENT_MAP, 10, 5);
+	event_signal_point(EVENT_MAP, 3, 8);
+	event_signal_point(EVENT_MAP, 6, 2);
+	eq(r->points, 3);
+	eq(r->regions, 0);
+	event_signal(EVENT_REFRESH);
+	eq(r->regions, 1);
+	eq(r->refreshes, 1);
+
+	/* Flushing early sends it once, ahead of the refresh */
+	event_signal_point(EVENT_MAP, 7, 7);
+	event_signal_point(EVENT_MAP, -1, -1);
+	event_flush_regions();
+	eq(r->regions, 2);
+	event_signal(EVENT_REFRESH);
+	eq(r->regions, 2);
+
+	/* Nothing is gathered without a region handler */
+	event_remove_handler(EVENT_MAP_REGION, record_region, r);
+	event_signal_point(EVENT_MAP, 7, 7);
+	event_add_handler(EVENT_MAP_REGION, record_region, r);
+	event_signal(EVENT_REFRESH);
+	eq(r->regions, 2);
+	ok;
+}
+
+static int test_hold(void *state) {
+	struct event_record *r = state;
+	struct held_event *held;
+	char buf[8];
+
+	event_add_handler(EVENT_GEN_ROOM_START, record_string, r);
+	event_add_handler(EVENT_GEN_LEVEL_START, record_string, r);
+
+	/* Held events wait, with their own copies of strings */
+	event_hold(EVENT_GEN_ROOM_START, true);
+	my_strcpy(buf, "a", sizeof(buf));
+	event_signal_string(EVENT_GEN_ROOM_START, buf);
+	event_signal_string(EVENT_GEN_LEVEL_START, "b");
+	my_strcpy(buf, "c", sizeof(buf));
+	event_signal_string(EVENT_GEN_ROOM_START, buf);
+	my_strcpy(buf, "x", sizeof(buf));
+	event_hold(EVENT_GEN_ROOM_START, false);
+	require(streq(r->strings, "b"));
+
+	/* They are sent in order when asked */
+	held = event_take_held();
+	require(held);
+	event_signal_string(EVENT_GEN_ROOM_START, "d");
+	event_send_held(held);
+	require(streq(r->strings, "bdac"));
+
+	/* Or dropped */
+	r->strings[0] = '\0';
+	event_hold(EVENT_GEN_ROOM_START, true);
+	event_signal_string(EVENT_GEN_ROOM_START, "e");
+	event_hold(EVENT_GEN_ROOM_START, false);
+	event_free_held(event_take_held());
+	require(streq(r->strings, ""));
+	ok;
+}
+
+const char *suite_name = "game/event";
+struct test tests[] = {
+	{ "has_handlers", test_has_handlers },
+	{ "regions", test_regions },
+	{ "hold", test_hold },
+	{ NULL, NULL }
+};
@@ -0,0 +1,269 @@
+/* monster/alloc
+ *
+ * Tests for get_mon_num(), checked against the linear walk of the monster
+ * allocation table which the running totals and binary search replaced
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "init.h"
+#include "mon-make.h"
+#include "monster.h"
+#include "z-rand.h"
+
+/**
+ * The races in the order of the allocation table, with the probabilities
+ * the old code would have worked out for them
+ */
+struct alloc_ref {
+	int count;
+	int *race;
+	uint32_t *prob;
+	bool (*hook)(struct monster_race *race);
+};
+
+int setup_tests(void **state) {
+	struct alloc_ref *ref;
+	int lev, i;
+
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+
+	ref = mem_zalloc(sizeof(*ref));
+	ref->race = mem_zalloc(z_info->r_max * sizeof(int));
+	ref->prob = mem_zalloc(z_info->r_max * sizeof(uint32_t));
+	for (lev = 0; lev < z_info->max_depth; lev++) {
+		for (i = 1; i < z_info->r_max - 1; i++) {
+			if (r_info[i].rarity && r_info[i].level == lev) {
+				ref->race[ref->count++] = i;
+			}
+		}
+	}
+	*state = ref;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	struct alloc_ref *ref = state;
+
+	get_mon_num_prep(NULL);
+	mem_free(ref->prob);
+	mem_free(ref->race);
+	mem_free(ref);
+	cleanup_angband();
+	return 0;
+}
+
+/**
+ * Work out each race's chance of being picked, as the old get_mon_num()
+ * did on every call, and return the total
+ */
+static uint32_t ref_total(struct alloc_ref *ref, int generated_level,
+		int current_level)
+{
+	time_t cur_time = time(NULL);
+	struct tm *date = localtime(&cur_time);
+	bool christmas = date->tm_mon == 11 && date->tm_mday >= 24
+		&& date->tm_mday <= 26;
+	uint32_t total = 0;
+	int i;
+
+	for (i = 0; i < ref->count; i++) {
+		struct monster_race *race = &r_info[ref->race[i]];
+
+		ref->prob[i] = 0;
+		if (race->level > generated_level) continue;
+		if (generated_level > 0 && race->level <= 0) continue;
+		if (ref->hook && !ref->hook(race)) continue;
+		if (rf_has(race->flags, RF_SEASONAL) && !christmas) continue;
+		if (rf_has(race->flags, RF_FORCE_DEPTH)
+				&& race->level > current_level) {
+			continue;
+		}
+		if (rf_has(race->flags, RF_UNIQUE)
+				&& race->cur_num >= race->max_num) {
+			continue;
+		}
+		ref->prob[i] = (100 / race->rarity) * (1 + race->level / 10);
+		total += ref->prob[i];
+	}
+	return total;
+}
+
+/**
+ * Pick a race by walking the table, using up the same random draw as
+ * get_mon_race_aux()
+ */
+static struct monster_race *ref_pick(struct alloc_ref *ref, uint32_t total)
+{
+	uint32_t value = randint0(total);
+	int i;
+
+	for (i = 0; i < ref->count; i++) {
+		if (value < ref->prob[i]) break;
+		value -= ref->prob[i];
+	}
+	return &r_info[ref->race[i]];
+}
+
+/**
+ * What get_mon_num() returned before, using up the same random draws
+ */
+static struct monster_race *ref_get_mon_num(struct alloc_ref *ref,
+		int generated_level, int current_level)
+{
+	struct monster_race *race;
+	uint32_t total;
+	int p;
+
+	if (generated_level > 0 && one_in_(z_info->ood_monster_chance))
+		generated_level += MIN(generated_level / 4 + 2,
+			z_info->ood_monster_amount);
+
+	total = ref_total(ref, generated_level, current_level);
+	if (!total) return NULL;
+	race = ref_pick(ref, total);
+	p = randint0(100);
+	if (p < 60) {
+		struct monster_race *old = race;
+
+		race = ref_pick(ref, total);
+		if (race->level < old->level) race = old;
+	}
+	if (p < 10) {
+		struct monster_race *old = race;
+
+		race = ref_pick(ref, total);
+		if (race->level < old->level) race = old;
+	}
+	return race;
+}
+
+static bool only_animals(struct monster_race *race)
+{
+	return rf_has(race->flags, RF_ANIMAL);
+}
+
+static bool only_uniques(struct monster_race *race)
+{
+	return rf_has(race->flags, RF_UNIQUE);
+}
+
+/**
+ * Return how many of a run of picks differ from the old ones
+ */
+static int count_differences(struct alloc_ref *ref)
+{
+	static const int levels[][2] = {
+		{ 0, 0 }, { 1, 1 }, { 5, 5 }, { 20, 10 }, { 40, 40 },
+		{ 80, 60 }, { 127, 127 }
+	};
+	int differences = 0;
+	size_t i;
+	int n;
+
+	for (i = 0; i < N_ELEMENTS(levels); i++) {
+		for (n = 0; n < 300; n++) {
+			struct rng_state rng = *rng_default();
+			struct monster_race *race =
+				get_mon_num(levels[i][0], levels[i][1]);
+
+			*rng_default() = rng;
+			if (race != ref_get_mon_num(ref, levels[i][0],
+					levels[i][1])) {
+				differences++;
+			}
+		}
+	}
+	return differences;
+}
+
+static int test_unrestricted(void *state) {
+	struct alloc_ref *ref = state;
+
+	ref->hook = NULL;
+	get_mon_num_prep(NULL);
+	eq(count_differences(ref), 0);
+	ok;
+}
+
+static int test_restricted(void *state) {
+	struct alloc_ref *ref = state;
+
+	/* Each change of restriction rebuilds the totals */
+	ref->hook = only_animals;
+	get_mon_num_prep(only_animals);
+	eq(count_differences(ref), 0);
+	ref->hook = only_uniques;
+	get_mon_num_prep(only_uniques);
+	eq(count_differences(ref), 0);
+	ref->hook = NULL;
+	get_mon_num_prep(NULL);
+	eq(count_differences(ref), 0);
+	ok;
+}
+
+static int test_uniques(void *state) {
+	struct alloc_ref *ref = state;
+	int uniques[20];
+	uint8_t max_num[20];
+	int i, n = 0;
+
+	ref->hook = NULL;
+	get_mon_num_prep(NULL);
+	for (i = 1; i < z_info->r_max - 1 && n < 20; i++) {
+		struct monster_race *race = &r_info[i];
+
+		if (rf_has(race->flags, RF_UNIQUE) && race->rarity
+				&& race->level <= 30) {
+			uniques[n++] = i;
+		}
+	}
+	require(n == 20);
+
+	/* No player has been made, so they start off dead */
+	for (i = 0; i < 20; i++) {
+		max_num[i] = r_info[uniques[i]].max_num;
+		r_info[uniques[i]].max_num = 1;
+	}
+	eq(count_differences(ref), 0);
+
+	/* Uniques coming and going between picks at the same level */
+	for (i = 0; i < 400; i++) {
+		struct monster_race *race = &r_info[uniques[i % 20]];
+		struct rng_state rng;
+		struct monster_race *picked;
+
+		race->cur_num = race->cur_num ? 0 : race->max_num;
+		rng = *rng_default();
+		picked = get_mon_num(30, 30);
+		*rng_default() = rng;
+		ptreq(picked, ref_get_mon_num(ref, 30, 30));
+	}
+	eq(count_differences(ref), 0);
+
+	/* And with only uniques allowed */
+	ref->hook = only_uniques;
+	get_mon_num_prep(only_uniques);
+	eq(count_differences(ref), 0);
+	for (i = 0; i < 20; i++) {
+		r_info[uniques[i]].cur_num = 0;
+	}
+	eq(count_differences(ref), 0);
+	for (i = 0; i < 20; i++) {
+		r_info[uniques[i]].max_num = max_num[i];
+	}
+	ref->hook = NULL;
+	get_mon_num_prep(NULL);
+	ok;
+}
+
+const char *suite_name = "monster/alloc";
+struct test tests[] = {
+	{ "unrestricted", test_unrestricted },
+	{ "restricted", test_restricted },
+	{ "uniques", test_uniques },
+	{ NULL, NULL }
+};
@@ -6,9 +6,15 @@
  *             26 Apr 2011
  */
 
+#include "cave.h"
+#include "game-world.h"
 #include "mon-make.h"
+#include "mon-predicate.h"
 #include "mon-util.h"
 #include "player-birth.h"
+#include "player-calcs.h"
+#include "player-timed.h"
+#include "player-util.h"
 #include "test-utils.h"
 #include "unit-test.h"
 #include "unit-test-data.h"
@@ -128,9 +134,177 @@ static int test_nearby_kin(void *state) {
 	ok;
 }
 
+static int test_update_monsters(void *state) {
+	struct chunk *c = t_build_arena(30, 70);
+	struct monster *near, *far;
+	int x, y;
+
+	player_make_simple(NULL, NULL, "Tester");
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			sqinfo_on(square(c, loc(x, y))->info, SQUARE_GLOW);
+		}
+	}
+	cave = c;
+	player->cave = cave_new(c->height, c->width);
+	character_dungeon = true;
+	player_place(c, player, loc(5, 5));
+	near = t_add_monster(c, loc(10, 5), "wolf");
+	far = t_add_monster(c, loc(60, 5), "wolf");
+
+	update_view(c, player);
+	update_monsters(true);
+	require(monster_is_visible(near));
+	require(monster_is_in_view(near));
+	require(!monster_is_visible(far));
+
+	/* Monsters on grids leaving or entering the view are updated */
+	square_set_feat(c, loc(8, 5), FEAT_PERM);
+	update_view(c, player);
+	update_monsters(false);
+	require(!monster_is_visible(near));
+	require(!monster_is_in_view(near));
+	square_set_feat(c, loc(8, 5), FEAT_FLOOR);
+	update_view(c, player);
+	update_monsters(false);
+	require(monster_is_visible(near));
+
+	/* So are all of them when the player's sight changes */
+	player->timed[TMD_BLIND] = 1;
+	update_monsters(false);
+	require(!monster_is_visible(near));
+	player->timed[TMD_BLIND] = 0;
+	update_monsters(false);
+	require(monster_is_visible(near));
+
+	/* Monsters can be marked for the next update */
+	mflag_on(far->mflag, MFLAG_MARK);
+	monster_needs_update(c, far->midx);
+	update_monsters(false);
+	require(monster_is_visible(far));
+	mflag_off(far->mflag, MFLAG_MARK);
+	monsters_need_update(c);
+	update_monsters(false);
+	require(!monster_is_visible(far));
+
+	/* Distances follow the player */
+	square_set_mon(c, player->grid, 0);
+	player_place(c, player, loc(55, 5));
+	update_view(c, player);
+	update_monsters(true);
+	eq(far->cdis, 5);
+	require(monster_is_visible(far));
+	require(!monster_is_visible(near));
+
+	wipe_mon_list(c, player);
+	cave_free(player->cave);
+	player->cave = NULL;
+	cave_free(c);
+	cave = NULL;
+	character_dungeon = false;
+	ok;
+}
+
+/**
+ * Check the monsters found by cave_monsters_in() or cave_monsters_near()
+ * against a look through the whole monster list
+ */
+static bool index_matches(struct chunk *c, struct loc tl, struct loc br,
+		int radius, const int *midx, int n)
+{
+	int i, found = 0;
+
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+
+		if (!mon->race) continue;
+		if (radius >= 0) {
+			struct loc centre = loc((tl.x + br.x) / 2, (tl.y + br.y) / 2);
+
+			if (distance(centre, mon->grid) > radius) continue;
+		} else if (mon->grid.x < tl.x || mon->grid.x > br.x
+				|| mon->grid.y < tl.y || mon->grid.y > br.y) {
+			continue;
+		}
+		if (found == n || midx[found] != i) return false;
+		found++;
+	}
+	return found == n;
+}
+
+static int test_monster_index(void *state) {
+	struct chunk *c = t_build_arena(40, 100);
+	int *midx, *inner;
+	int i, n;
+
+	player_make_simple(NULL, NULL, "Tester");
+	cave = c;
+	player->cave = cave_new(c->height, c->width);
+	player_place(c, player, loc(1, 1));
+	for (i = 0; i < 300; i++) {
+		struct loc grid = loc(2 + randint0(97), 2 + randint0(37));
+
+		if (!square_monster(c, grid)) t_add_monster(c, grid, "wolf");
+	}
+
+	/* Move monsters about, kill some and close up the gaps */
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+
+		if (!mon->race) continue;
+		if (i % 5 == 0) {
+			delete_monster_idx(c, i);
+		} else {
+			monster_swap(mon->grid,
+				loc(2 + randint0(97), 2 + randint0(37)));
+		}
+	}
+	compact_monsters(c, 0);
+
+	midx = cave_monster_list(c);
+	for (i = 0; i < 100; i++) {
+		struct loc tl = loc(randint0(110) - 5, randint0(50) - 5);
+		struct loc br = loc(tl.x + randint0(40), tl.y + randint0(20));
+		int radius = randint0(20);
+		struct loc centre = loc(tl.x + radius, tl.y + radius);
+
+		n = cave_monsters_in(c, tl, br, midx);
+		require(index_matches(c, tl, br, -1, midx, n));
+		n = cave_monsters_near(c, centre, radius, midx);
+		require(index_matches(c, tl, loc(centre.x + radius,
+			centre.y + radius), radius, midx, n));
+	}
+
+	/* Everything is found when looking everywhere */
+	n = cave_monsters_in(c, loc(0, 0), loc(c->width - 1, c->height - 1),
+		midx);
+	eq(n, cave_monster_count(c));
+
+	/* Lists lent out together are separate, and are lent out again */
+	inner = cave_monster_list(c);
+	require(inner != midx);
+	cave_monsters_in(c, loc(0, 0), loc(c->width / 2, c->height - 1), inner);
+	require(index_matches(c, loc(0, 0), loc(c->width - 1, c->height - 1), -1,
+		midx, n));
+	cave_monster_list_done(c, inner);
+	ptreq(cave_monster_list(c), inner);
+	cave_monster_list_done(c, inner);
+	cave_monster_list_done(c, midx);
+	ptreq(cave_monster_list(c), midx);
+	cave_monster_list_done(c, midx);
+	wipe_mon_list(c, player);
+	cave_free(player->cave);
+	player->cave = NULL;
+	cave_free(c);
+	cave = NULL;
+	ok;
+}
+
 const char *suite_name = "monster/monster";
 struct test tests[] = {
 	{ "match_monster_bases", test_match_monster_bases },
 	{ "nearby_kin", test_nearby_kin },
+	{ "update_monsters", test_update_monsters },
+	{ "monster_index", test_monster_index },
 	{ NULL, NULL }
 };
@@ -0,0 +1,480 @@
+/* monster/schedule
+ *
+ * Tests for the monster schedule in mon-move.c, checked against what the
+ * backward scan of the whole monster list which it replaced would do
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "game-input.h"
+#include "game-world.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-move.h"
+#include "mon-timed.h"
+#include "mon-util.h"
+#include "monster.h"
+#include "player-birth.h"
+#include "player-util.h"
+
+#define MODEL_MAX 16
+
+/**
+ * The energy of each monster as the old process_monsters() and
+ * reset_monsters() would have left it, given the same monsters
+ */
+struct model {
+	bool live[MODEL_MAX];
+	bool handled[MODEL_MAX];
+	int energy[MODEL_MAX];
+	int gain[MODEL_MAX];
+	int moves;
+};
+
+/**
+ * Something for a monster to do on its first move in a last monster pass
+ * from a given turn on, as it might cast a spell: speed up or slow down
+ * another monster, or bring in a new one
+ */
+static struct {
+	int32_t from;
+	int actor;
+	int target;
+	int effect;
+	struct loc summon;
+	int32_t done;
+	int placed;
+	int placed_energy;
+} action;
+
+int setup_tests(void **state) {
+	set_file_paths();
+	if (!init_angband()) {
+		return 1;
+	}
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	check_break_hook = NULL;
+	cleanup_angband();
+	return 0;
+}
+
+/**
+ * The energy the old code gave a monster each turn
+ */
+static int old_gain(const struct monster *mon)
+{
+	int mspeed = mon->mspeed;
+
+	if (mon->m_timed[MON_TMD_FAST])
+		mspeed += 10;
+	if (mon->m_timed[MON_TMD_SLOW])
+		mspeed -= 2 * monster_effect_level(mon, MON_TMD_SLOW);
+	return turn_energy(mspeed);
+}
+
+static bool act_mid_turn(bool user_event, int messaging)
+{
+	struct monster *actor;
+
+	if (action.done || turn < action.from || cave->mon_pass_turn != turn
+			|| cave->mon_pass_pos != action.actor) {
+		return false;
+	}
+	action.done = turn;
+	if (action.target) {
+		mon_inc_timed(cave_monster(cave, action.target), action.effect,
+			10, MON_TMD_FLG_NOFAIL | MON_TMD_FLG_NOMESSAGE);
+	}
+	if (!loc_is_zero(action.summon)) {
+		struct monster *mon = t_add_monster(cave, action.summon, "wolf");
+
+		action.placed = mon->midx;
+		action.placed_energy = mon->energy;
+	}
+
+	/* Calm down again */
+	actor = cave_monster(cave, action.actor);
+	actor->hp = actor->maxhp;
+	return false;
+}
+
+/**
+ * Set up a level with the player far from the monsters, so that only a
+ * hurt monster is active; a full level recycles the indices of dead monsters
+ */
+static void new_level(bool full)
+{
+	cave = t_build_arena(20, 80);
+	cave->depth = 10;
+	if (full) cave->mon_max = z_info->level_monster_max;
+	player->depth = cave->depth;
+	player->cave = cave_new(cave->height, cave->width);
+	player_place(cave, player, loc(1, 10));
+	turn = 1;
+	memset(&action, 0, sizeof(action));
+	check_break_hook = act_mid_turn;
+}
+
+static void free_level(void)
+{
+	check_break_hook = NULL;
+	cave_free(player->cave);
+	player->cave = NULL;
+	cave_free(cave);
+	cave = NULL;
+}
+
+static struct monster *add_monster(struct loc grid, int mspeed)
+{
+	struct monster *mon = t_add_monster(cave, grid, "wolf");
+
+	mon->mspeed = mspeed;
+	return mon;
+}
+
+static void model_start(struct model *m)
+{
+	int i;
+
+	memset(m, 0, sizeof(*m));
+	for (i = 1; i < cave_monster_max(cave) && i < MODEL_MAX; i++) {
+		struct monster *mon = cave_monster(cave, i);
+
+		if (!mon->race) continue;
+		m->live[i] = true;
+		m->energy[i] = mon->energy;
+		m->gain[i] = old_gain(mon);
+	}
+}
+
+/**
+ * One pass of the old process_monsters(), after the real one
+ */
+static void model_pass(struct model *m, int minimum_energy)
+{
+	int i;
+
+	for (i = MODEL_MAX - 1; i >= 1; i--) {
+		bool moving;
+
+		if (!m->live[i] || m->handled[i]) continue;
+		if (m->energy[i] < minimum_energy) continue;
+		moving = m->energy[i] >= z_info->move_energy;
+		m->handled[i] = true;
+		m->energy[i] += m->gain[i];
+		if (!moving) continue;
+		m->energy[i] -= z_info->move_energy;
+		m->moves++;
+
+		/* Do what the real monster did */
+		if (!minimum_energy && action.done == turn && i == action.actor) {
+			if (action.target) {
+				m->gain[action.target] =
+					old_gain(cave_monster(cave, action.target));
+			}
+			if (action.placed) {
+				m->live[action.placed] = true;
+				m->energy[action.placed] = action.placed_energy;
+				m->gain[action.placed] =
+					old_gain(cave_monster(cave, action.placed));
+			}
+		}
+	}
+}
+
+static void model_reset(struct model *m)
+{
+	memset(m->handled, 0, sizeof(m->handled));
+}
+
+/**
+ * Return the first monster whose energy, once brought up to date, isn't
+ * what the old code would have, or 0 if there is none
+ */
+static int first_difference(struct model *m)
+{
+	int i;
+
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *mon = cave_monster(cave, i);
+
+		if (i >= MODEL_MAX) {
+			if (mon->race) return i;
+			continue;
+		}
+		if (!mon->race != !m->live[i]) return i;
+		if (!mon->race) continue;
+		monster_energy_sync(cave, mon);
+		if (mon->energy != m->energy[i]) return i;
+		if (mon->energy >= z_info->move_energy + m->gain[i]) return i;
+	}
+	return 0;
+}
+
+/**
+ * Check that the monsters due to move are in the order the old scan took
+ */
+static bool due_in_order(void)
+{
+	int n;
+
+	for (n = 1; n < cave->mon_due_count; n++) {
+		if (cave->mon_due[n] >= cave->mon_due[n - 1]) return false;
+	}
+	return true;
+}
+
+/**
+ * Play out the monsters' part of a game turn as run_game_loop() does, with
+ * the monsters which have more energy than the player going first
+ */
+static void monster_turn_passes(struct model *m, int minimum_energy)
+{
+	if (minimum_energy) {
+		process_monsters(minimum_energy);
+		model_pass(m, minimum_energy);
+	}
+	process_monsters(0);
+	model_pass(m, 0);
+}
+
+static void end_turn(struct model *m)
+{
+	reset_monsters();
+	model_reset(m);
+	turn++;
+}
+
+/**
+ * The energy the player might have at the start of a turn
+ */
+static int player_energy(void)
+{
+	return (turn % 3) ? z_info->move_energy + 1 + turn % 40 : 0;
+}
+
+static int test_order(void *state) {
+	struct model m;
+	int speeds[] = { 100, 105, 110, 113, 120, 130, 140, 110 };
+	int i;
+
+	new_level(false);
+	for (i = 0; i < (int) N_ELEMENTS(speeds); i++) {
+		add_monster(loc(60 + 2 * i, 5 + i), speeds[i]);
+	}
+	model_start(&m);
+
+	/* Cover a few turns on which monsters regenerate */
+	while (turn <= 400) {
+		monster_turn_passes(&m, player_energy());
+		require(due_in_order());
+		end_turn(&m);
+		eq(first_difference(&m), 0);
+	}
+	require(m.moves > 400);
+	free_level();
+	ok;
+}
+
+static int test_speed(void *state) {
+	struct model m;
+	struct monster *below, *actor, *above;
+	int effects[] = { MON_TMD_FAST, MON_TMD_SLOW };
+	int i, j;
+
+	new_level(false);
+	below = add_monster(loc(60, 5), 110);
+	actor = add_monster(loc(70, 10), 120);
+	above = add_monster(loc(60, 15), 110);
+	add_monster(loc(65, 15), 130);
+	actor->hp = 1;
+	model_start(&m);
+
+	/* Monsters both done and not done with this pass change speed */
+	for (i = 0; i < (int) N_ELEMENTS(effects); i++) {
+		for (j = 0; j < 2; j++) {
+			action.from = turn + 7;
+			action.actor = actor->midx;
+			action.target = j ? below->midx : above->midx;
+			action.effect = effects[i];
+			action.done = 0;
+			while (!action.done || turn < action.done + 20) {
+				monster_turn_passes(&m, player_energy());
+				end_turn(&m);
+				eq(first_difference(&m), 0);
+				require(turn < 1000);
+			}
+			actor->hp = 1;
+		}
+	}
+
+	/* And between the passes, as for the player's spells */
+	for (i = 0; i < 40; i++) {
+		struct monster *mon = (i % 2) ? below : above;
+
+		if (player_energy()) {
+			process_monsters(player_energy());
+			model_pass(&m, player_energy());
+		}
+		mon_inc_timed(mon, (i % 4) < 2 ? MON_TMD_SLOW : MON_TMD_FAST, 5,
+			MON_TMD_FLG_NOFAIL | MON_TMD_FLG_NOMESSAGE);
+		m.gain[mon->midx] = old_gain(mon);
+		process_monsters(0);
+		model_pass(&m, 0);
+		end_turn(&m);
+		eq(first_difference(&m), 0);
+	}
+	free_level();
+	ok;
+}
+
+static int test_summon(void *state) {
+	struct model m;
+	struct monster *actor;
+	int i;
+
+	/* A new monster above the one acting misses this turn */
+	new_level(false);
+	add_monster(loc(60, 5), 110);
+	actor = add_monster(loc(70, 10), 110);
+	add_monster(loc(60, 15), 120);
+	actor->hp = 1;
+	model_start(&m);
+	action.from = 5;
+	action.actor = actor->midx;
+	action.summon = loc(75, 10);
+	while (!action.done || turn < action.done + 50) {
+		monster_turn_passes(&m, player_energy());
+		end_turn(&m);
+		eq(first_difference(&m), 0);
+		require(turn < 1000);
+	}
+	require(action.placed > action.actor);
+	free_level();
+
+	/* On a full level, one recycled from below gets this turn's energy */
+	new_level(true);
+	add_monster(loc(50, 5), 110);
+	add_monster(loc(60, 5), 110);
+	actor = add_monster(loc(70, 10), 110);
+	add_monster(loc(60, 15), 120);
+	actor->hp = 1;
+	delete_monster_idx(cave, 1);
+	model_start(&m);
+	action.from = 5;
+	action.actor = actor->midx;
+	action.summon = loc(75, 10);
+	while (!action.done || turn < action.done + 50) {
+		monster_turn_passes(&m, player_energy());
+		end_turn(&m);
+		eq(first_difference(&m), 0);
+		require(turn < 1000);
+	}
+	eq(action.placed, 1);
+	for (i = 5; i < cave_monster_max(cave); i++) {
+		null(cave_monster(cave, i)->race);
+	}
+	free_level();
+	ok;
+}
+
+static int test_save_mid_turn(void *state) {
+	struct model m;
+	int speeds[] = { 115, 130, 140, 150, 120 };
+	int i, handled = 0;
+
+	new_level(false);
+	for (i = 0; i < (int) N_ELEMENTS(speeds); i++) {
+		add_monster(loc(60 + 2 * i, 5 + i), speeds[i]);
+	}
+	model_start(&m);
+
+	/* Save once some monsters have moved ahead of the player */
+	while (turn < 1000 && handled < 3) {
+		bool any = false;
+
+		process_monsters(z_info->move_energy + 1);
+		model_pass(&m, z_info->move_energy + 1);
+		for (i = 1; i < MODEL_MAX; i++) {
+			if (m.handled[i]) any = true;
+		}
+		if (any) {
+			sync_monster_energy(cave);
+			for (i = 1; i < cave_monster_max(cave); i++) {
+				struct monster *mon = cave_monster(cave, i);
+
+				eq(mflag_has(mon->mflag, MFLAG_HANDLED) ? 1 : 0,
+					m.handled[i] ? 1 : 0);
+			}
+
+			/* Loading knows nothing but the flags and energy */
+			unschedule_monsters(cave);
+			for (i = 1; i < cave_monster_max(cave); i++) {
+				cave_monster(cave, i)->energy_turn = 0;
+				cave_monster(cave, i)->act_turn = 0;
+			}
+			handled++;
+		}
+		process_monsters(0);
+		model_pass(&m, 0);
+		for (i = 1; i < cave_monster_max(cave); i++) {
+			require(!mflag_has(cave_monster(cave, i)->mflag,
+				MFLAG_HANDLED));
+		}
+		end_turn(&m);
+		eq(first_difference(&m), 0);
+	}
+	eq(handled, 3);
+	free_level();
+	ok;
+}
+
+static int test_long_skip(void *state) {
+	struct model m;
+	int speeds[] = { 70, 199, 110, 90 };
+	int i;
+
+	new_level(false);
+	for (i = 0; i < (int) N_ELEMENTS(speeds); i++) {
+		add_monster(loc(60 + 2 * i, 5 + i), speeds[i]);
+	}
+	model_start(&m);
+	while (turn <= 300) {
+		monster_turn_passes(&m, player_energy());
+		end_turn(&m);
+		eq(first_difference(&m), 0);
+	}
+
+	/* Monsters on a level the player has left don't gain energy */
+	unschedule_monsters(cave);
+	turn += 20000;
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		monster_energy_sync(cave, cave_monster(cave, i));
+	}
+	eq(first_difference(&m), 0);
+	while (turn <= 20600) {
+		monster_turn_passes(&m, player_energy());
+		end_turn(&m);
+		eq(first_difference(&m), 0);
+	}
+	free_level();
+	ok;
+}
+
+const char *suite_name = "monster/schedule";
+struct test tests[] = {
+	{ "order", test_order },
+	{ "speed", test_speed },
+	{ "summon", test_summon },
+	{ "save_mid_turn", test_save_mid_turn },
+	{ "long_skip", test_long_skip },
+	{ NULL, NULL }
+};
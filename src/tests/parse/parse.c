@@ -443,6 +443,29 @@ static int test_opt0(void *state) {
 	ok;
 }
 
+static int test_opt1(void *state) {
+	errr r = parser_reg(state, "test-opt1a sym s0 ?int i0", ignored);
+	eq(r, 0);
+	r = parser_reg(state, "test-opt1b int i0 ?sym s1", ignored);
+	eq(r, 0);
+	r = parser_parse(state, "test-opt1b:7");
+	eq(r, 0);
+	require(parser_hasval(state, "i0"));
+	eq(parser_getint(state, "i0"), 7);
+	require(!parser_hasval(state, "s0"));
+	require(!parser_hasval(state, "s1"));
+	r = parser_parse(state, "test-opt1a:foo:3");
+	eq(r, 0);
+	require(parser_hasval(state, "s0"));
+	eq(parser_getint(state, "i0"), 3);
+	require(!parser_hasval(state, "s1"));
+	r = parser_parse(state, "# test-opt1a:foo:3");
+	eq(r, 0);
+	require(!parser_hasval(state, "s0"));
+	require(!parser_hasval(state, "i0"));
+	ok;
+}
+
 static enum parser_error helper_uint0(struct parser *p) {
 	unsigned int a = parser_getuint(p, "u0");
 	int *wasok = parser_priv(p);
@@ -596,6 +619,7 @@ struct test tests[] = {
 	{ "rand_bad0", test_rand_bad0 },
 
 	{ "opt0", test_opt0 },
+	{ "opt1", test_opt1 },
 
 	{ "uint0", test_uint0 },
 	{ "uint1", test_uint1 },
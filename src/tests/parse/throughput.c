@@ -0,0 +1,206 @@
+/* parse/throughput */
+/*
+ * Time the parser over every shipped gamedata file.  Each directive seen in
+ * a file gets a generic hook, so this measures the line splitting, directive
+ * dispatch and value lookup in parser_parse() rather than the game's hooks.
+ * Run with -v to see the throughput.
+ */
+
+#include "unit-test.h"
+#include "test-utils.h"
+
+#include "init.h"
+#include "parser.h"
+#include "z-file.h"
+#include "z-virt.h"
+#include <time.h>
+
+/* How many times to parse the whole set of files */
+#define THROUGHPUT_PASSES 3
+
+struct gamedata_file {
+	char **lines;
+	int n_lines;
+	struct gamedata_file *next;
+};
+
+struct throughput_state {
+	struct gamedata_file *files;
+	int n_files;
+	long n_bytes;
+	long n_lines;
+};
+
+static const char *field_names[] = { "f0", "f1", "f2", "f3", "rest" };
+
+static enum parser_error fetch_all(struct parser *p) {
+	long *sum = parser_priv(p);
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(field_names); i++) {
+		if (parser_hasval(p, field_names[i])) {
+			const char *s = (i < N_ELEMENTS(field_names) - 1) ?
+				parser_getsym(p, field_names[i]) :
+				parser_getstr(p, field_names[i]);
+			*sum += (unsigned char)s[0];
+		}
+	}
+	return PARSE_ERROR_NONE;
+}
+
+/**
+ * Register a generic hook for the directive of a line if it doesn't have
+ * one yet: four optional symbols and then the rest of the line.
+ */
+static void add_directive(struct parser *p, const char *line) {
+	char buf[1024];
+	char *dir;
+
+	while (*line && isspace((unsigned char)*line))
+		line++;
+	if (!*line || *line == '#')
+		return;
+	my_strcpy(buf, line, sizeof(buf));
+	dir = strtok(buf, ":");
+	if (dir && parser_parse(p, dir) ==
+			PARSE_ERROR_UNDEFINED_DIRECTIVE) {
+		parser_reg(p, format("%s ?sym f0 ?sym f1 ?sym f2 ?sym f3 ?str rest",
+			dir), fetch_all);
+	}
+}
+
+static struct gamedata_file *load_file(const char *path,
+		struct throughput_state *ts) {
+	ang_file *fh = file_open(path, MODE_READ, FTYPE_TEXT);
+	struct gamedata_file *gf;
+	char buf[1024];
+	int alloc = 256;
+
+	if (!fh)
+		return NULL;
+	gf = mem_zalloc(sizeof(*gf));
+	gf->lines = mem_alloc(alloc * sizeof(*gf->lines));
+	while (file_getl(fh, buf, sizeof(buf))) {
+		if (gf->n_lines == alloc) {
+			alloc *= 2;
+			gf->lines = mem_realloc(gf->lines,
+				alloc * sizeof(*gf->lines));
+		}
+		gf->lines[gf->n_lines++] = string_make(buf);
+		ts->n_bytes += strlen(buf) + 1;
+	}
+	file_close(fh);
+	ts->n_lines += gf->n_lines;
+	return gf;
+}
+
+int setup_tests(void **state) {
+	struct throughput_state *ts = mem_zalloc(sizeof(*ts));
+	ang_dir *dir;
+	char name[1024];
+
+	set_file_paths();
+	dir = my_dopen(ANGBAND_DIR_GAMEDATA);
+	if (!dir) {
+		mem_free(ts);
+		return 1;
+	}
+	while (my_dread(dir, name, sizeof(name))) {
+		char path[1024];
+		size_t len = strlen(name);
+		struct gamedata_file *gf;
+
+		if (len < 4 || !streq(name + len - 4, ".txt"))
+			continue;
+		path_build(path, sizeof(path), ANGBAND_DIR_GAMEDATA, name);
+		gf = load_file(path, ts);
+		if (gf) {
+			gf->next = ts->files;
+			ts->files = gf;
+			ts->n_files++;
+		}
+	}
+	my_dclose(dir);
+
+	*state = ts;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	struct throughput_state *ts = state;
+
+	while (ts->files) {
+		struct gamedata_file *next = ts->files->next;
+		int i;
+
+		for (i = 0; i < ts->files->n_lines; i++)
+			string_free(ts->files->lines[i]);
+		mem_free(ts->files->lines);
+		mem_free(ts->files);
+		ts->files = next;
+	}
+	mem_free(ts);
+	return 0;
+}
+
+static int test_gamedata(void *state) {
+	struct throughput_state *ts = state;
+	struct gamedata_file *gf;
+	struct parser **parsers;
+	long sum = 0;
+	clock_t start, elapsed;
+	int i, pass;
+
+	require(ts->n_files > 0);
+
+	/* Set up a parser for each file outside of the timed section */
+	parsers = mem_zalloc(ts->n_files * sizeof(*parsers));
+	for (gf = ts->files, i = 0; gf; gf = gf->next, i++) {
+		int j;
+
+		parsers[i] = parser_new();
+		parser_setpriv(parsers[i], &sum);
+		for (j = 0; j < gf->n_lines; j++)
+			add_directive(parsers[i], gf->lines[j]);
+	}
+
+	start = clock();
+	for (pass = 0; pass < THROUGHPUT_PASSES; pass++) {
+		for (gf = ts->files, i = 0; gf; gf = gf->next, i++) {
+			int j;
+
+			for (j = 0; j < gf->n_lines; j++) {
+				enum parser_error r = parser_parse(parsers[i],
+					gf->lines[j]);
+
+				eq(r, PARSE_ERROR_NONE);
+			}
+		}
+	}
+	elapsed = clock() - start;
+
+	if (verbose) {
+		double secs = (double)elapsed / CLOCKS_PER_SEC;
+
+		printf("\n    %d files, %ld lines, %ld bytes x %d: %.1f ms",
+			ts->n_files, ts->n_lines, ts->n_bytes, THROUGHPUT_PASSES,
+			1e3 * secs);
+		if (secs > 0) {
+			printf(", %.1f MB/s",
+				THROUGHPUT_PASSES * ts->n_bytes / secs / 1e6);
+		}
+		printf("\n  %-16s  ", "");
+	}
+
+	for (i = 0; i < ts->n_files; i++)
+		parser_destroy(parsers[i]);
+	mem_free(parsers);
+	require(sum > 0);
+	ok;
+}
+
+const char *suite_name = "parse/throughput";
+struct test tests[] = {
+	{ "gamedata", test_gamedata },
+	{ NULL, NULL }
+};
@@ -1,11 +1,45 @@
 /* player/pathfind */
 
 #include "unit-test.h"
+#include "test-utils.h"
 #include "cave.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "player-birth.h"
 #include "player-path.h"
+#include "trap.h"
 
-NOSETUP
-NOTEARDOWN
+int setup_tests(void **state) {
+	set_file_paths();
+	init_angband();
+#ifdef UNIX
+	/* Necessary for creating the randart file. */
+	create_needed_dirs();
+#endif
+	if (!player_make_simple(NULL, NULL, "Tester")) {
+		cleanup_angband();
+		return 1;
+	}
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	wipe_mon_list(cave, player);
+	cleanup_angband();
+	return 0;
+}
+
+/**
+ * Go to a level at the given depth with all of it known to the player.
+ */
+static void go_to_known_level(int depth) {
+	player->depth = depth;
+	prepare_next_level(player);
+	on_new_level();
+	wiz_light(cave, player, true);
+}
 
 static int test_dir_to(void *state) {
 	eq(pathfind_direction_to(loc(0,0), loc(0,1)), DIR_S);
@@ -24,8 +58,205 @@ static int test_dir_to(void *state) {
 	ok;
 }
 
+static int test_distances_reuse(void *state) {
+	struct pfdistances *a, *b, *c;
+	int *turns;
+	struct loc grid;
+	int n = 0;
+
+	go_to_known_level(5);
+	turns = mem_alloc(cave->height * cave->width * sizeof(*turns));
+
+	/* Two sets of distances can be in use at once. */
+	a = prepare_pfdistances(player, player->grid, true, false);
+	notnull(a);
+	b = prepare_pfdistances(player, player->grid, true, false);
+	notnull(b);
+	require(a != b);
+	for (grid.y = 0; grid.y < cave->height; ++grid.y) {
+		for (grid.x = 0; grid.x < cave->width; ++grid.x) {
+			int i = grid_to_i(grid, cave->width);
+
+			turns[i] = pfdistances_to_turncount(a, grid);
+			eq(pfdistances_to_turncount(b, grid), turns[i]);
+			if (turns[i] > 0) ++n;
+		}
+	}
+	require(n > 0);
+	release_pfdistances(b);
+	release_pfdistances(a);
+
+	/* Reusing the storage doesn't leave anything from the last search. */
+	c = prepare_pfdistances(player, player->grid, true, false);
+	notnull(c);
+	for (grid.y = 0; grid.y < cave->height; ++grid.y) {
+		for (grid.x = 0; grid.x < cave->width; ++grid.x) {
+			eq(pfdistances_to_turncount(c, grid),
+				turns[grid_to_i(grid, cave->width)]);
+		}
+	}
+	release_pfdistances(c);
+	mem_free(turns);
+	ok;
+}
+
+static int test_find_path_reuse(void *state) {
+	int depth;
+
+	/* Change levels, and so the size of the cave, between searches. */
+	for (depth = 0; depth < 3; ++depth) {
+		struct loc dest = loc(-1, -1), grid;
+		struct pfdistances *a;
+		int16_t *first, *second;
+		int len1, len2, i;
+
+		go_to_known_level(depth * 5);
+
+		/* Pick the reachable grid furthest from the player. */
+		a = prepare_pfdistances(player, player->grid, true, false);
+		notnull(a);
+		for (grid.y = 0; grid.y < cave->height; ++grid.y) {
+			for (grid.x = 0; grid.x < cave->width; ++grid.x) {
+				if (pfdistances_to_turncount(a, grid)
+						> pfdistances_to_turncount(a, dest)) {
+					dest = grid;
+				}
+			}
+		}
+		release_pfdistances(a);
+		require(square_in_bounds(cave, dest));
+
+		/* The same search twice gives the same path. */
+		len1 = find_path(player, player->grid, dest, &first);
+		require(len1 > 0);
+		len2 = find_path(player, player->grid, dest, &second);
+		eq(len2, len1);
+		for (i = 0; i < len1; ++i) {
+			eq(second[i], first[i]);
+		}
+		mem_free(first);
+		mem_free(second);
+
+		/* Going nowhere needs no path. */
+		eq(find_path(player, player->grid, player->grid, &first), 0);
+		null(first);
+	}
+	ok;
+}
+
+/**
+ * Remember every grid of the level, as if the player had explored it all.
+ */
+static void remember_level(void) {
+	struct loc grid;
+
+	for (grid.y = 0; grid.y < cave->height; ++grid.y) {
+		for (grid.x = 0; grid.x < cave->width; ++grid.x) {
+			square_memorize(cave, grid);
+			square_memorize_traps(cave, grid);
+		}
+	}
+}
+
+/**
+ * Pick the grid furthest, by remembered paths, from the player.
+ */
+static struct loc furthest_known(void) {
+	struct loc dest = loc(-1, -1), grid;
+	struct pfdistances *a = prepare_pfdistances(player, player->grid,
+		true, true);
+
+	for (grid.y = 0; grid.y < cave->height; ++grid.y) {
+		for (grid.x = 0; grid.x < cave->width; ++grid.x) {
+			if (pfdistances_to_turncount(a, grid)
+					> pfdistances_to_turncount(a, dest)) {
+				dest = grid;
+			}
+		}
+	}
+	release_pfdistances(a);
+	return dest;
+}
+
+/**
+ * Check that a path from the player leads to dest; if known is true, it must
+ * stick to remembered grids that can be traversed.
+ */
+static bool path_leads_to(const int16_t *steps, int len, struct loc dest,
+		bool known) {
+	struct loc grid = player->grid;
+	int i;
+
+	for (i = len - 1; i >= 0; --i) {
+		grid = loc_sum(grid, ddgrid[steps[i]]);
+		if (!square_in_bounds(cave, grid)) return false;
+		if (known && (!square_isknown(cave, grid)
+				|| square_isvisibletrap(player->cave, grid)
+				|| !(square_ispassable(player->cave, grid)
+				|| square_iscloseddoor(player->cave, grid)
+				|| square_isrubble(player->cave, grid)))) {
+			return false;
+		}
+	}
+	return loc_eq(grid, dest);
+}
+
+static int test_find_path_long(void *state) {
+	int depth, tried = 0;
+
+	for (depth = 1; depth < 7; ++depth) {
+		struct loc dest, grid;
+		struct pfdistances *a;
+		int16_t *steps;
+		int len, i;
+		bool reachable;
+
+		go_to_known_level(depth * 5);
+		remember_level();
+		dest = furthest_known();
+		require(square_in_bounds(cave, dest));
+		if (MAX(ABS(dest.y - player->grid.y),
+				ABS(dest.x - player->grid.x)) < 32) {
+			continue;
+		}
+		++tried;
+
+		/* A long trip over remembered grids stays on them. */
+		len = find_path(player, player->grid, dest, &steps);
+		require(len > 0);
+		require(path_leads_to(steps, len, dest, true));
+
+		/* Forget a grid half way along, and the next path avoids it. */
+		grid = player->grid;
+		for (i = len - 1; i >= len / 2; --i) {
+			grid = loc_sum(grid, ddgrid[steps[i]]);
+		}
+		mem_free(steps);
+		square_forget(cave, grid);
+		a = prepare_pfdistances(player, player->grid, true, true);
+		reachable = pfdistances_to_turncount(a, dest) >= 0;
+		release_pfdistances(a);
+		len = find_path(player, player->grid, dest, &steps);
+		require(len > 0);
+		require(path_leads_to(steps, len, dest, reachable));
+		mem_free(steps);
+
+		/* Remember it again, and the plan uses it once more. */
+		square_memorize(cave, grid);
+		len = find_path(player, player->grid, dest, &steps);
+		require(len > 0);
+		require(path_leads_to(steps, len, dest, true));
+		mem_free(steps);
+	}
+	require(tried > 0);
+	ok;
+}
+
 const char *suite_name = "player/pathfind";
 struct test tests[] = {
 	{ "dir-to", test_dir_to },
+	{ "distances-reuse", test_distances_reuse },
+	{ "find-path-reuse", test_find_path_reuse },
+	{ "find-path-long", test_find_path_long },
 	{ NULL, NULL },
 };
@@ -0,0 +1,135 @@
+/* z-compress/compress.c */
+
+#include "unit-test.h"
+#include "z-compress.h"
+#include "z-rand.h"
+#include "z-virt.h"
+
+#define TEST_SIZE	LZ_MAX_INPUT
+
+struct compress_state {
+	uint8_t src[TEST_SIZE];
+	uint8_t packed[LZ_BOUND(TEST_SIZE)];
+	uint8_t out[TEST_SIZE];
+};
+
+int setup_tests(void **state) {
+	*state = mem_zalloc(sizeof(struct compress_state));
+	Rand_state_init(1234);
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	mem_free(state);
+	return 0;
+}
+
+/**
+ * Compress and decompress n bytes of src, returning the compressed size
+ */
+static size_t round_trip(struct compress_state *cs, size_t n) {
+	size_t len = lz_compress(cs->src, n, cs->packed, sizeof(cs->packed));
+
+	if (!len) return 0;
+	memset(cs->out, 0xAA, sizeof(cs->out));
+	if (!lz_decompress(cs->packed, len, cs->out, n)) return 0;
+	if (memcmp(cs->src, cs->out, n) != 0) return 0;
+	return len;
+}
+
+static int test_empty(void *state) {
+	struct compress_state *cs = state;
+
+	require(round_trip(cs, 0) > 0);
+	ok;
+}
+
+static int test_zeroes(void *state) {
+	struct compress_state *cs = state;
+	size_t len;
+
+	memset(cs->src, 0, TEST_SIZE);
+	len = round_trip(cs, TEST_SIZE);
+	require(len > 0);
+	require(len < TEST_SIZE / 100);
+	ok;
+}
+
+static int test_records(void *state) {
+	struct compress_state *cs = state;
+	size_t i, len;
+
+	/* Repeated records with a few fields changing, like a savefile */
+	for (i = 0; i < TEST_SIZE; i++) {
+		switch (i % 16) {
+			case 0: cs->src[i] = (uint8_t)(i / 16); break;
+			case 5: cs->src[i] = (uint8_t)randint0(4); break;
+			default: cs->src[i] = (uint8_t)(i % 16); break;
+		}
+	}
+	len = round_trip(cs, TEST_SIZE);
+	require(len > 0);
+	require(len < TEST_SIZE / 2);
+	ok;
+}
+
+static int test_random(void *state) {
+	struct compress_state *cs = state;
+	size_t i, len;
+
+	/* Incompressible data still fits in the bound */
+	for (i = 0; i < TEST_SIZE; i++)
+		cs->src[i] = (uint8_t)randint0(256);
+	len = round_trip(cs, TEST_SIZE);
+	require(len > 0);
+	require(len <= LZ_BOUND(TEST_SIZE));
+
+	/* But not in less room than that */
+	eq(lz_compress(cs->src, TEST_SIZE, cs->packed, TEST_SIZE), 0);
+	ok;
+}
+
+static int test_short(void *state) {
+	struct compress_state *cs = state;
+	size_t n;
+
+	for (n = 1; n < 64; n++) {
+		memset(cs->src, 'x', n);
+		require(round_trip(cs, n) > 0);
+	}
+	ok;
+}
+
+static int test_corrupt(void *state) {
+	struct compress_state *cs = state;
+	size_t len;
+
+	memset(cs->src, 0, TEST_SIZE);
+	memcpy(cs->src, "savefile", 8);
+	len = lz_compress(cs->src, 4096, cs->packed, sizeof(cs->packed));
+	require(len > 2);
+
+	/* Wrong sizes */
+	eq(lz_decompress(cs->packed, len, cs->out, 4095), false);
+	eq(lz_decompress(cs->packed, len, cs->out, 4097), false);
+	eq(lz_decompress(cs->packed, len - 1, cs->out, 4096), false);
+
+	/* A back reference to before the start */
+	cs->packed[0] = 0x10;
+	cs->packed[1] = 's';
+	cs->packed[2] = 2;
+	cs->packed[3] = 0;
+	eq(lz_decompress(cs->packed, 4, cs->out, 5), false);
+	ok;
+}
+
+const char *suite_name = "z-compress/compress";
+struct test tests[] = {
+	{ "empty", test_empty },
+	{ "zeroes", test_zeroes },
+	{ "records", test_records },
+	{ "random", test_random },
+	{ "short", test_short },
+	{ "corrupt", test_corrupt },
+	{ NULL, NULL }
+};
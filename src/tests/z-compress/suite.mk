@@ -0,0 +1 @@
+TESTPROGS += z-compress/compress
@@ -1,6 +1,7 @@
 /* z-quark/quark.c */
 
 #include "unit-test.h"
+#include "z-form.h"
 #include "z-quark.h"
 
 int setup_tests(void **state) {
@@ -46,9 +47,34 @@ static int test_dedup(void *state) {
 	ok;
 }
 
+static int test_many(void *state) {
+	quark_t q[1000];
+	const char *str[1000];
+	char buf[32];
+	int i;
+
+	/* Enough to grow the table and the arena several times over */
+	for (i = 0; i < 1000; i++) {
+		strnfmt(buf, sizeof(buf), "2-quark-%d", i);
+		q[i] = quark_add(buf);
+		str[i] = quark_str(q[i]);
+		require(str[i]);
+		require(streq(str[i], buf));
+	}
+	for (i = 0; i < 1000; i++) {
+		strnfmt(buf, sizeof(buf), "2-quark-%d", i);
+		require(quark_add(buf) == q[i]);
+		require(quark_str(q[i]) == str[i]);
+		if (i) require(q[i] != q[i - 1]);
+	}
+
+	ok;
+}
+
 const char *suite_name = "z-quark/quark";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "dedup", test_dedup },
+	{ "many", test_many },
 	{ NULL, NULL }
 };
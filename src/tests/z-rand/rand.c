@@ -0,0 +1,105 @@
+/* z-rand/rand */
+/* Exercise the random number streams declared in z-rand.h. */
+
+#include "unit-test.h"
+#include "z-rand.h"
+
+NOSETUP
+NOTEARDOWN
+
+static int test_default_matches_stream(void *state)
+{
+	struct rng_state rs;
+	uint32_t expect[64];
+	int i;
+
+	/* A fresh default stream seeded like a fresh explicit one */
+	rng_default()->index = 0;
+	rng_default()->quick = false;
+	Rand_state_init(4321);
+	for (i = 0; i < 64; i++) {
+		expect[i] = Rand_div(1000);
+	}
+
+	rng_state_init(&rs, 4321);
+	for (i = 0; i < 64; i++) {
+		eq(rng_div(&rs, 1000), expect[i]);
+	}
+	ok;
+}
+
+static int test_streams_independent(void *state)
+{
+	struct rng_state a, b, c;
+	int32_t expect[100];
+	int i;
+
+	rng_state_init(&a, 17);
+	for (i = 0; i < 100; i++) {
+		expect[i] = rng_randint0(&a, 100000);
+	}
+
+	/* Interleaving draws from other streams must not disturb a stream */
+	rng_state_init(&b, 17);
+	rng_state_init(&c, 99);
+	for (i = 0; i < 100; i++) {
+		(void) rng_damroll(&c, 3, 6);
+		(void) randint0(50);
+		eq(rng_randint0(&b, 100000), expect[i]);
+	}
+
+	/* Reseeding gives the same stream whatever happened before */
+	(void) rng_normal(&b, 0, 10);
+	rng_state_init(&b, 17);
+	for (i = 0; i < 100; i++) {
+		eq(rng_randint0(&b, 100000), expect[i]);
+	}
+	ok;
+}
+
+static int test_quick(void *state)
+{
+	struct rng_state rs;
+	struct rng_state *def = rng_default();
+	struct rng_state saved = *def;
+	int i;
+
+	rng_state_init_quick(&rs, 12345);
+	rng_state_init_quick(def, 12345);
+	for (i = 0; i < 50; i++) {
+		eq(rng_range(&rs, 5, 500), rand_range(5, 500));
+	}
+	eq(rs.value, def->value);
+	*def = saved;
+	ok;
+}
+
+static int test_ranges(void *state)
+{
+	struct rng_state rs;
+	random_value v = { 2, 3, 4, 5 };
+	int i;
+
+	rng_state_init(&rs, 2024);
+	for (i = 0; i < 1000; i++) {
+		int r = rng_range(&rs, -3, 3);
+		int d = rng_damroll(&rs, 2, 6);
+		int m = rng_m_bonus(&rs, 10, 50);
+		int c = rng_randcalc(&rs, v, 40, RANDOMISE);
+
+		require(r >= -3 && r <= 3);
+		require(d >= 2 && d <= 12);
+		require(m >= 0 && m <= 10);
+		require(randcalc_valid(v, c));
+	}
+	ok;
+}
+
+const char *suite_name = "z-rand/rand";
+struct test tests[] = {
+	{ "default-matches-stream", test_default_matches_stream },
+	{ "streams-independent", test_streams_independent },
+	{ "quick", test_quick },
+	{ "ranges", test_ranges },
+	{ NULL, NULL }
+};
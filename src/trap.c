@@ -460,7 +460,9 @@ void square_memorize_traps(struct chunk *c, struct loc grid)
 {
 	struct trap *trap = square(c, grid)->trap;
 	struct trap *current = NULL;
+	bool was_visible;
 	if (c != cave) return;
+	was_visible = square_isvisibletrap(player->cave, grid);
 
 	/* Clear current knowledge */
 	square_remove_all_traps(player->cave, grid);
@@ -486,6 +488,11 @@ void square_memorize_traps(struct chunk *c, struct loc grid)
 	if (square(player->cave, grid)->trap) {
 		sqinfo_on(square(player->cave, grid)->info, SQUARE_TRAP);
 	}
+
+	/* Known paths may now avoid or cross this grid */
+	if (square_isvisibletrap(player->cave, grid) != was_visible) {
+		player->cave->terrain_stamp++;
+	}
 }
 
 /**
@@ -1342,69 +1342,135 @@ static void trace_map_updates(game_event_type type, game_event_data *data,
 #endif
 
 /**
- * Update either a single map grid or a whole map
+ * Map grids changed since the maps were last drawn, kept for each term which
+ * shows the map.  The game signals changes as they happen; they are drawn
+ * together when the game asks for a refresh or the front end is about to
+ * show the screen, so a grid that changes several times is drawn once and the
+ * term is flushed once rather than after every grid.
  */
-static void update_maps(game_event_type type, game_event_data *data, void *user)
+static struct map_dirty {
+	uint8_t *marked;	/* One entry per grid of the level */
+	struct loc *grids;	/* The marked grids, in the order they were marked */
+	int count;
+	int height, width;
+	bool all;		/* The whole map needs redrawing */
+} map_dirty[ANGBAND_TERM_MAX];
+
+/**
+ * Forget the changed grids for every term
+ */
+static void map_dirty_free(void)
 {
-	term *t = user;
+	int j;
 
-	/* This signals a whole-map redraw. */
-	if (data->point.x == -1 && data->point.y == -1)
-		prt_map();
+	for (j = 0; j < ANGBAND_TERM_MAX; j++) {
+		mem_free(map_dirty[j].marked);
+		mem_free(map_dirty[j].grids);
+		memset(&map_dirty[j], 0, sizeof(map_dirty[j]));
+	}
+}
+
+/**
+ * Note that a map grid, or the whole map for (-1, -1), needs redrawing in
+ * a term
+ */
+static void map_dirty_mark(term *t, struct loc grid)
+{
+	struct map_dirty *d = NULL;
+	int j, idx;
+
+	for (j = 0; j < ANGBAND_TERM_MAX; j++) {
+		if (angband_term[j] == t) {
+			d = &map_dirty[j];
+			break;
+		}
+	}
+	if (!d || d->all) return;
 
-	/* Single point to be redrawn */
-	else {
-		struct grid_data g;
-		int a, ta;
-		wchar_t c, tc;
+	if (grid.x == -1 && grid.y == -1) {
+		d->all = true;
+		return;
+	}
+	if (!cave || !square_in_bounds(cave, grid)) return;
+
+	/* Size the marks to the level */
+	if (d->height != cave->height || d->width != cave->width) {
+		mem_free(d->marked);
+		mem_free(d->grids);
+		d->height = cave->height;
+		d->width = cave->width;
+		d->marked = mem_zalloc(d->height * d->width * sizeof(*d->marked));
+		d->grids = mem_zalloc(d->height * d->width * sizeof(*d->grids));
+		d->count = 0;
+	}
 
-		int ky, kx;
-		int vy, vx;
-		int clipy;
+	idx = grid.y * d->width + grid.x;
+	if (d->marked[idx]) return;
+	d->marked[idx] = 1;
+	d->grids[d->count++] = grid;
+}
 
-		/* Location relative to panel */
-		ky = data->point.y - t->offset_y;
-		kx = data->point.x - t->offset_x;
+/**
+ * Redraw a single map grid in a term
+ */
+static void draw_map_grid(term *t, struct loc grid)
+{
+	struct grid_data g;
+	int a, ta;
+	wchar_t c, tc;
 
-		if (t == angband_term[0]) {
-			/* Verify location */
-			if ((ky < 0) || (ky >= SCREEN_HGT)) return;
-			if ((kx < 0) || (kx >= SCREEN_WID)) return;
+	int ky, kx;
+	int vy, vx;
+	int clipy;
 
-			/* Location in window */
-			vy = tile_height * ky + ROW_MAP;
-			vx = tile_width * kx + COL_MAP;
+	/* Location relative to panel */
+	ky = grid.y - t->offset_y;
+	kx = grid.x - t->offset_x;
 
-			/* Protect the status line against modification. */
-			clipy = ROW_MAP + SCREEN_ROWS;
-		} else {
-			/* Verify location */
-			if ((ky < 0) || (ky >= t->hgt / tile_height)) return;
-			if ((kx < 0) || (kx >= t->wid / tile_width)) return;
+	if (t == angband_term[0]) {
+		/* Verify location */
+		if ((ky < 0) || (ky >= SCREEN_HGT)) return;
+		if ((kx < 0) || (kx >= SCREEN_WID)) return;
 
-			/* Location in window */
-			vy = tile_height * ky;
-			vx = tile_width * kx;
+		/* Location in window */
+		vy = tile_height * ky + ROW_MAP;
+		vx = tile_width * kx + COL_MAP;
 
-			/* All the rows may be used for the map. */
-			clipy = t->hgt;
-		}
+		/* Protect the status line against modification. */
+		clipy = ROW_MAP + SCREEN_ROWS;
+	} else {
+		/* Verify location */
+		if ((ky < 0) || (ky >= t->hgt / tile_height)) return;
+		if ((kx < 0) || (kx >= t->wid / tile_width)) return;
+
+		/* Location in window */
+		vy = tile_height * ky;
+		vx = tile_width * kx;
+
+		/* All the rows may be used for the map. */
+		clipy = t->hgt;
+	}
 
 
-		/* Redraw the grid spot */
-		map_info(data->point, &g);
-		grid_data_as_text(&g, &a, &c, &ta, &tc);
-		Term_queue_char(t, vx, vy, a, c, ta, tc);
+	/* Redraw the grid spot */
+	map_info(grid, &g);
+	grid_data_as_text(&g, &a, &c, &ta, &tc);
+	Term_queue_char(t, vx, vy, a, c, ta, tc);
 #ifdef MAP_DEBUG
-		/* Plot 'spot' updates in light green to make them visible */
-		Term_queue_char(t, vx, vy, COLOUR_L_GREEN, c, ta, tc);
+	/* Plot 'spot' updates in light green to make them visible */
+	Term_queue_char(t, vx, vy, COLOUR_L_GREEN, c, ta, tc);
 #endif
 
-		if ((tile_width > 1) || (tile_height > 1))
-			Term_big_queue_char(t, vx, vy, clipy, a, c, COLOUR_WHITE, L' ');
-	}
+	if ((tile_width > 1) || (tile_height > 1))
+		Term_big_queue_char(t, vx, vy, clipy, a, c, COLOUR_WHITE, L' ');
+}
 
-	/* Refresh the main screen unless the map needs to center */
+/**
+ * Check whether the map in a term is about to be moved to center on the
+ * player, so there is no point showing it yet
+ */
+static bool map_needs_centering(term *t)
+{
 	if (player->upkeep->update & (PU_PANEL) && OPT(player, center_player)) {
 		int hgt = (t == angband_term[0]) ? SCREEN_HGT / 2 :
 			t->hgt / (tile_height * 2);
@@ -1412,10 +1478,62 @@ static void update_maps(game_event_type type, game_event_data *data, void *user)
 			t->wid / (tile_width * 2);
 
 		if (panel_should_modify(t, player->grid.y - hgt, player->grid.x - wid))
-			return;
+			return true;
 	}
+	return false;
+}
 
-	Term_fresh();
+/**
+ * Note either a single map grid or a whole map as needing to be redrawn
+ */
+static void update_maps(game_event_type type, game_event_data *data, void *user)
+{
+	map_dirty_mark(user, loc(data->point.x, data->point.y));
+}
+
+/**
+ * Draw the map grids changed since the last refresh, and flush the terms
+ * showing them
+ */
+static void flush_maps(game_event_type type, game_event_data *data, void *user)
+{
+	term *old = Term;
+	bool whole = false;
+	int i, j;
+
+	for (j = 0; j < ANGBAND_TERM_MAX; j++) {
+		if (map_dirty[j].all) whole = true;
+	}
+
+	/* One whole-map redraw covers every term showing the map */
+	if (whole && cave) prt_map();
+
+	for (j = 0; j < ANGBAND_TERM_MAX; j++) {
+		struct map_dirty *d = &map_dirty[j];
+		term *t = angband_term[j];
+		bool shows_map = t && (j == 0 || (window_flag[j] & PW_OVERHEAD));
+		bool drawn = d->all || (whole && d->count);
+
+		for (i = 0; i < d->count; i++) {
+			struct loc grid = d->grids[i];
+
+			d->marked[grid.y * d->width + grid.x] = 0;
+			if (whole || !shows_map || !cave) continue;
+			if (d->height != cave->height || d->width != cave->width)
+				continue;
+			draw_map_grid(t, grid);
+			drawn = true;
+		}
+		d->count = 0;
+		d->all = false;
+
+		/* Refresh the term unless the map needs to center */
+		if (!drawn || !shows_map || map_needs_centering(t)) continue;
+		Term_activate(t);
+		Term_fresh();
+	}
+
+	Term_activate(old);
 }
 
 /**
@@ -1464,7 +1582,8 @@ static void do_animation(void)
 			continue;
 
 		mon->attr = attr;
-		player->upkeep->redraw |= (PR_MAP | PR_MONLIST);
+		event_signal_point(EVENT_MAP, mon->grid.x, mon->grid.y);
+		player->upkeep->redraw |= (PR_MONLIST);
 	}
 
 	flicker++;
@@ -1509,6 +1628,7 @@ void idle_update(void)
 	/* Animate and redraw if necessary */
 	do_animation();
 	redraw_stuff(player);
+	event_flush_regions();
 
 	/* Refresh the main screen */
 	Term_fresh();
@@ -1628,6 +1748,7 @@ static void display_explosion(game_event_type type, game_event_data *data,
 			if (player_sees_grid[i])
 				event_signal_point(EVENT_MAP, x, y);
 		}
+		event_flush_regions();
 
 		/* Center the cursor */
 		move_cursor_relative(centre.y, centre.x);
@@ -1671,6 +1792,7 @@ static void display_bolt(game_event_type type, game_event_data *data,
 			redraw_stuff(player);
 		Term_xtra(TERM_XTRA_DELAY, msec);
 		event_signal_point(EVENT_MAP, x, y);
+		event_flush_regions();
 		Term_fresh();
 		if (player->upkeep->redraw)
 			redraw_stuff(player);
@@ -1712,6 +1834,7 @@ static void display_missile(game_event_type type, game_event_data *data,
 
 		Term_xtra(TERM_XTRA_DELAY, msec);
 		event_signal_point(EVENT_MAP, x, y);
+		event_flush_regions();
 
 		Term_fresh();
 		if (player->upkeep->redraw) redraw_stuff(player);
@@ -2257,10 +2380,6 @@ static void subwindow_flag_changed(int win_idx, uint32_t flag, bool new_state)
 		{
 			minimap_data[win_idx].win_idx = win_idx;
 
-			register_or_deregister(EVENT_MAP,
-					       update_minimap_subwindow,
-					       &minimap_data[win_idx]);
-
 			register_or_deregister(EVENT_DUNGEONLEVEL, update_minimap_subwindow,
 								   &minimap_data[win_idx]);
 
@@ -2542,7 +2661,7 @@ static void new_level_display_update(game_event_type type,
 
 	/* If autosave is pending, do it now. */
 	if (player->upkeep->autosave) {
-		save_game();
+		autosave_game();
 		player->upkeep->autosave = false;
 	}
 
@@ -2740,6 +2859,7 @@ static void ui_enter_world(game_event_type type, game_event_data *data,
 
 	/* Simplest way to keep the map up to date - will do for now */
 	event_add_handler(EVENT_MAP, update_maps, angband_term[0]);
+	event_add_handler(EVENT_MAP_REGION, flush_maps, NULL);
 #ifdef MAP_DEBUG
 	event_add_handler(EVENT_MAP, trace_map_updates, angband_term[0]);
 #endif
@@ -2805,6 +2925,8 @@ static void ui_leave_world(game_event_type type, game_event_data *data,
 
 	/* Simplest way to keep the map up to date - will do for now */
 	event_remove_handler(EVENT_MAP, update_maps, angband_term[0]);
+	event_remove_handler(EVENT_MAP_REGION, flush_maps, NULL);
+	map_dirty_free();
 #ifdef MAP_DEBUG
 	event_remove_handler(EVENT_MAP, trace_map_updates, angband_term[0]);
 #endif
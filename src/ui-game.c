@@ -1039,11 +1039,15 @@ void save_game(void)
 }
 
 /**
- * Save the game.
- *
- * \return whether the save was successful.
+ * Whether an autosave has been started whose result hasn't been shown yet
  */
-bool save_game_checked(void)
+static bool autosave_unreported;
+
+/**
+ * Save the game, optionally leaving the savefile to be written out in the
+ * background.
+ */
+static bool save_game_aux(bool background)
 {
 	char path[1024];
 	bool result;
@@ -1066,8 +1070,24 @@ bool save_game_checked(void)
 	/* The player is not dead */
 	my_strcpy(player->died_from, "(saved)", sizeof(player->died_from));
 
+	/* Report on the last background save before starting another */
+	autosave_unreported = false;
+	if (!savefile_wait()) {
+		msg("Autosave failed!");
+		event_signal(EVENT_MESSAGE_FLUSH);
+	}
+
 	/* Save the player */
-	if (savefile_save(savefile)) {
+	if (background) {
+		result = savefile_save_background(savefile);
+
+		/* Nothing may be on disk yet; check_autosave() reports it */
+		if (result) {
+			autosave_unreported = true;
+		} else {
+			prt("Saving game... failed!", 0, 0);
+		}
+	} else if (savefile_save(savefile)) {
 		prt("Saving game... done.", 0, 0);
 		result = true;
 	} else {
@@ -1101,6 +1121,41 @@ bool save_game_checked(void)
 	return result;
 }
 
+/**
+ * Save the game.
+ *
+ * \return whether the save was successful.
+ */
+bool save_game_checked(void)
+{
+	return save_game_aux(false);
+}
+
+/**
+ * Autosave the game.  The savefile is written out in the background, and
+ * check_autosave() reports how that went.
+ */
+void autosave_game(void)
+{
+	signals_protect(true);
+	(void)save_game_aux(true);
+	signals_protect(false);
+}
+
+/**
+ * Report the result of an autosave once it has been written out.
+ */
+void check_autosave(void)
+{
+	if (!autosave_unreported || savefile_busy()) return;
+	autosave_unreported = false;
+	if (savefile_wait()) {
+		prt("Saving game... done.", 0, 0);
+	} else {
+		msg("Autosave failed!");
+	}
+}
+
 
 /**
  * Close up the current game (player may or may not be dead).
@@ -1140,6 +1195,13 @@ void close_game(bool prompt_failed_save)
 		deactivate_randart_file();
 	}
 
+	/* Let any autosave reach the disk before the final save */
+	autosave_unreported = false;
+	if (!savefile_wait()) {
+		msg("Autosave failed!");
+		event_signal(EVENT_MESSAGE_FLUSH);
+	}
+
 	/* Handle death or life */
 	if (player->is_dead) {
 		death_knowledge(player);
@@ -74,6 +74,8 @@ bool savefile_name_already_used(const char *fname, bool make_safe,
 	bool strip_suffix);
 void save_game(void);
 bool save_game_checked(void);
+void autosave_game(void);
+void check_autosave(void);
 void close_game(bool prompt_failed_save);
 
 bool got_savefile(savefile_getter *pg);
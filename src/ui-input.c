@@ -21,6 +21,7 @@
 #include "game-event.h"
 #include "game-input.h"
 #include "game-world.h"
+#include "generate.h"
 #include "init.h"
 #include "obj-gear.h"
 #include "obj-util.h"
@@ -33,6 +34,7 @@
 #include "ui-context.h"
 #include "ui-curse.h"
 #include "ui-display.h"
+#include "ui-game.h"
 #include "ui-effect.h"
 #include "ui-help.h"
 #include "ui-keymap.h"
@@ -261,6 +263,9 @@ ui_event inkey_ex(void)
 
 		/* Flush output once when no key ready */
 		if (!done && (0 != Term_inkey(&kk, false, false))) {
+			/* Draw any map changes still waiting */
+			event_flush_regions();
+
 			/* Activate proper term */
 			Term_activate(old);
 
@@ -1901,6 +1906,15 @@ ui_event textui_get_command(int *count)
 			move_cursor_relative(player->grid.y, player->grid.x);
 		}
 
+		/* Show how the last autosave went, once it is on disk */
+		check_autosave();
+
+		/* Use the wait for a command to build the next level */
+		if ((!inkey_next || !inkey_next->code)
+				&& Term_inkey(&ke, false, false) != 0) {
+			pregenerate_level(player);
+		}
+
 		/* Get a command */
 		ke = inkey_ex();
 
@@ -17,6 +17,7 @@
  */
 #include "angband.h"
 #include "cave.h"
+#include "game-event.h"
 #include "player-calcs.h"
 #include "ui-input.h"
 #include "ui-output.h"
@@ -427,6 +428,7 @@ void screen_save(void)
 {
 	player->upkeep->redraw |= PR_MAP;
 	redraw_stuff(player);
+	event_flush_regions();
 	event_signal(EVENT_MESSAGE_FLUSH);
 	Term_save();
 	screen_save_depth++;
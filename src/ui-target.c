@@ -18,6 +18,7 @@
 
 #include "angband.h"
 #include "cave.h"
+#include "game-event.h"
 #include "game-input.h"
 #include "init.h"
 #include "mon-desc.h"
@@ -1079,6 +1080,9 @@ static int draw_path(uint16_t path_n, struct loc *path_g, wchar_t *c, int *a,
 	/* No path, so do nothing. */
 	if (path_n < 1) return 0;
 
+	/* Make sure the map under the path is up to date before saving it */
+	event_flush_regions();
+
 	/* The starting square is never drawn, but notice if it is being
      * displayed. In theory, it could be the last such square.
      */
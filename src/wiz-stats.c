@@ -3130,6 +3130,28 @@ struct cgen_stats {
 	 * player is disconnected from all down staircases.
 	 */
 	uint32_t *disdstair_counts;
+	/*
+	 * This is effectively a z_info->profile_max x GEN_PHASE_MAX array
+	 * where phase_secs[i][j] is the total time, successful or not, spent
+	 * in the jth phase of building levels of the ith type.
+	 */
+	double **phase_secs;
+	/*
+	 * This is effectively a z_info->profile_max x GEN_PHASE_MAX array
+	 * where restart_phases[i][j] is the number of levels of the ith type
+	 * that were abandoned while in, or just after, the jth phase.
+	 */
+	uint32_t **restart_phases;
+	/*
+	 * Are the distinct reasons given for abandoning a level, in the order
+	 * first seen, and for each a z_info->profile_max element array of
+	 * the number of times it was given for each level type.
+	 */
+	const char **restart_reasons;
+	uint32_t **restart_counts;
+	int n_restart_reasons, alloc_restart_reasons;
+	/* Is the last phase finished for the current level or -1 */
+	int last_phase;
 	/* Is the number of successfully generated levels. */
 	int nsuccess;
 	/* Is the number of failed levels. */
@@ -3163,6 +3185,61 @@ static void cgenstat_handle_new_level(game_event_type et, game_event_data *ed,
 		gs->curr_room_counts[1][i] = 0;
 	}
 	gs->n_curr_tunn = 0;
+	gs->last_phase = -1;
+}
+
+static void cgenstat_handle_restart(game_event_type et, game_event_data *ed,
+		void *ud)
+{
+	struct cgen_stats *gs;
+	int i;
+
+	assert(et == EVENT_GEN_LEVEL_RESTART && ud);
+	gs = (struct cgen_stats*) ud;
+	assert(gs->level_type >= 0 && gs->level_type < z_info->profile_max);
+
+	if (gs->last_phase >= 0) {
+		++gs->restart_phases[gs->level_type][gs->last_phase];
+	}
+
+	/* Find the reason, adding it if it hasn't been seen before. */
+	for (i = 0; i < gs->n_restart_reasons; ++i) {
+		if (streq(gs->restart_reasons[i], ed->string)) break;
+	}
+	if (i == gs->n_restart_reasons) {
+		if (gs->n_restart_reasons == gs->alloc_restart_reasons) {
+			gs->alloc_restart_reasons = (gs->alloc_restart_reasons) ?
+				gs->alloc_restart_reasons +
+				gs->alloc_restart_reasons : 8;
+			gs->restart_reasons = mem_realloc(gs->restart_reasons,
+				gs->alloc_restart_reasons *
+				sizeof(*gs->restart_reasons));
+			gs->restart_counts = mem_realloc(gs->restart_counts,
+				gs->alloc_restart_reasons *
+				sizeof(*gs->restart_counts));
+		}
+		gs->restart_reasons[i] = ed->string;
+		gs->restart_counts[i] = mem_zalloc(z_info->profile_max *
+			sizeof(*gs->restart_counts[i]));
+		++gs->n_restart_reasons;
+	}
+	++gs->restart_counts[i][gs->level_type];
+}
+
+static void cgenstat_handle_phase(game_event_type et, game_event_data *ed,
+		void *ud)
+{
+	struct cgen_stats *gs;
+
+	assert(et == EVENT_GEN_PHASE_END && ud);
+	gs = (struct cgen_stats*) ud;
+	assert(ed->phase.phase >= 0 && ed->phase.phase < GEN_PHASE_MAX);
+
+	/* The arena has no profile; ignore it. */
+	if (gs->level_type < 0) return;
+	gs->phase_secs[gs->level_type][ed->phase.phase] +=
+		ed->phase.usec / 1000000.0;
+	gs->last_phase = ed->phase.phase;
 }
 
 static void cgenstat_handle_level_end(game_event_type et, game_event_data *ed,
@@ -3324,11 +3401,29 @@ static void initialize_generation_stats(struct cgen_stats *gs)
 	gs->disdstair_counts = mem_zalloc(z_info->profile_max *
 		sizeof(*gs->disdstair_counts));
 
+	gs->phase_secs = mem_alloc(z_info->profile_max *
+		sizeof(*gs->phase_secs));
+	gs->restart_phases = mem_alloc(z_info->profile_max *
+		sizeof(*gs->restart_phases));
+	for (i = 0; i < z_info->profile_max; ++i) {
+		gs->phase_secs[i] = mem_zalloc(GEN_PHASE_MAX *
+			sizeof(*gs->phase_secs[i]));
+		gs->restart_phases[i] = mem_zalloc(GEN_PHASE_MAX *
+			sizeof(*gs->restart_phases[i]));
+	}
+	gs->restart_reasons = NULL;
+	gs->restart_counts = NULL;
+	gs->n_restart_reasons = 0;
+	gs->alloc_restart_reasons = 0;
+	gs->last_phase = -1;
+
 	event_add_handler(EVENT_GEN_LEVEL_START, cgenstat_handle_new_level, gs);
 	event_add_handler(EVENT_GEN_LEVEL_END, cgenstat_handle_level_end, gs);
 	event_add_handler(EVENT_GEN_ROOM_START, cgenstat_handle_new_room, gs);
 	event_add_handler(EVENT_GEN_ROOM_END, cgenstat_handle_room_end, gs);
 	event_add_handler(EVENT_GEN_TUNNEL_FINISHED, cgenstat_handle_tunnel, gs);
+	event_add_handler(EVENT_GEN_LEVEL_RESTART, cgenstat_handle_restart, gs);
+	event_add_handler(EVENT_GEN_PHASE_END, cgenstat_handle_phase, gs);
 }
 
 static void cleanup_generation_stats(struct cgen_stats *gs)
@@ -3345,6 +3440,23 @@ static void cleanup_generation_stats(struct cgen_stats *gs)
 		cgenstat_handle_room_end, gs);
 	event_remove_handler(EVENT_GEN_TUNNEL_FINISHED,
 		cgenstat_handle_tunnel, gs);
+	event_remove_handler(EVENT_GEN_LEVEL_RESTART,
+		cgenstat_handle_restart, gs);
+	event_remove_handler(EVENT_GEN_PHASE_END,
+		cgenstat_handle_phase, gs);
+
+	for (i = 0; i < gs->n_restart_reasons; ++i) {
+		mem_free(gs->restart_counts[i]);
+	}
+	mem_free(gs->restart_counts);
+	mem_free(gs->restart_reasons);
+
+	for (i = 0; i < z_info->profile_max; ++i) {
+		mem_free(gs->restart_phases[i]);
+		mem_free(gs->phase_secs[i]);
+	}
+	mem_free(gs->restart_phases);
+	mem_free(gs->phase_secs);
 
 	mem_free(gs->disdstair_counts);
 	mem_free(gs->disarea_counts);
@@ -3395,6 +3507,51 @@ static void dump_generation_stats(ang_file *fo, const struct cgen_stats *gs)
 	}
 	file_put(fo, "\n");
 
+	file_put(fo, "Level Builder Time in Seconds Per Successful Level by Phase (");
+	for (i = 0; i < GEN_PHASE_MAX; ++i) {
+		file_putf(fo, "%s%s", (i > 0) ? ", " : "", gen_phase_name(i));
+	}
+	file_put(fo, ")::\n");
+	for (i = 0; i < z_info->profile_max; ++i) {
+		int j;
+
+		file_putf(fo, "\"%s\"", get_level_profile_name_from_index(i));
+		for (j = 0; j < GEN_PHASE_MAX; ++j) {
+			file_putf(fo, "\t%.6f", (gs->level_counts[0][i] > 0) ?
+				gs->phase_secs[i][j] / gs->level_counts[0][i] :
+				0.0);
+		}
+		file_put(fo, "\n");
+	}
+	file_put(fo, "\n");
+
+	file_put(fo, "Level Builder Failure Count by Last Phase Reached::\n");
+	for (i = 0; i < z_info->profile_max; ++i) {
+		int j;
+
+		file_putf(fo, "\"%s\"", get_level_profile_name_from_index(i));
+		for (j = 0; j < GEN_PHASE_MAX; ++j) {
+			file_putf(fo, "\t%lu",
+				(unsigned long) gs->restart_phases[i][j]);
+		}
+		file_put(fo, "\n");
+	}
+	file_put(fo, "\n");
+
+	file_put(fo, "Level Builder Failure Count by Reason::\n");
+	for (i = 0; i < gs->n_restart_reasons; ++i) {
+		int j;
+
+		for (j = 0; j < z_info->profile_max; ++j) {
+			if (!gs->restart_counts[i][j]) continue;
+			file_putf(fo, "\"%s\"\t\"%s\"\t%lu\n",
+				get_level_profile_name_from_index(j),
+				gs->restart_reasons[i],
+				(unsigned long) gs->restart_counts[i][j]);
+		}
+	}
+	file_put(fo, "\n");
+
 	file_put(fo, "Average and Std. Deviation of Room Counts by Level Type::\n");
 	for (i = 0; i < z_info->profile_max; ++i) {
 		file_putf(fo, "\"%s\"\t%.4f\t%.4f\n",
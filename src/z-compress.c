@@ -0,0 +1,176 @@
+/**
+ * \file z-compress.c
+ * \brief Fast LZ77 compression of byte buffers
+ *
+ * Copyright (c) 2026 Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "z-compress.h"
+
+/**
+ * The compressed data is a run of sequences, each of which is some literal
+ * bytes followed by a back reference into the output:
+ * - a token byte, the top four bits of which are the literal count and the
+ *   bottom four the match length less LZ_MIN_MATCH
+ * - if either of those is 15, the rest of the count follows the token (for
+ *   the literals) or the offset (for the match) as bytes of 255 ending with
+ *   a byte less than 255
+ * - the literal bytes
+ * - the 2-byte little-endian offset back from the current position
+ * The last sequence stops after its literals, which is how the decoder
+ * knows it has reached the end.  This is the same layout LZ4 uses, without
+ * its framing.
+ *
+ * Matches are found greedily through a hash table of the positions of
+ * recently seen 4-byte strings, which is fast and does well on the long
+ * runs of zeroes and repeated records that savefiles are made of.
+ */
+
+#define LZ_MIN_MATCH	4
+#define LZ_HASH_BITS	12
+#define LZ_HASH(v)	(((v) * 2654435761U) >> (32 - LZ_HASH_BITS))
+
+#define LZ_READ32(p) \
+	((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | \
+	((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+
+/**
+ * Write the extra bytes of a count that didn't fit in the token
+ */
+static uint8_t *lz_put_count(uint8_t *op, size_t count)
+{
+	if (count < 15) return op;
+	count -= 15;
+	while (count >= 255) {
+		*op++ = 255;
+		count -= 255;
+	}
+	*op++ = (uint8_t)count;
+	return op;
+}
+
+/**
+ * Write one sequence; offset is 0 for the final, literal-only one.
+ * Returns NULL if it won't fit before end.
+ */
+static uint8_t *lz_put_sequence(uint8_t *op, const uint8_t *end,
+		const uint8_t *lit, size_t nlit, size_t offset, size_t mlen)
+{
+	size_t mcode = offset ? mlen - LZ_MIN_MATCH : 0;
+
+	/* Token, counts, offset and the literals themselves */
+	if ((size_t)(end - op) < 1 + nlit / 255 + 1 + nlit + 2 + mcode / 255 + 1)
+		return NULL;
+
+	*op++ = (uint8_t)((MIN(nlit, 15) << 4) | MIN(mcode, 15));
+	op = lz_put_count(op, nlit);
+	memcpy(op, lit, nlit);
+	op += nlit;
+	if (offset) {
+		*op++ = (uint8_t)(offset & 0xFF);
+		*op++ = (uint8_t)(offset >> 8);
+		op = lz_put_count(op, mcode);
+	}
+	return op;
+}
+
+size_t lz_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap)
+{
+	uint32_t table[1 << LZ_HASH_BITS];
+	const uint8_t *end = dst + cap;
+	uint8_t *op = dst;
+	size_t ip = 0, anchor = 0;
+
+	if (n > LZ_MAX_INPUT) return 0;
+	memset(table, 0, sizeof(table));
+
+	while (ip + LZ_MIN_MATCH <= n) {
+		uint32_t v = LZ_READ32(src + ip);
+		uint32_t h = LZ_HASH(v);
+		size_t ref = table[h];
+
+		table[h] = (uint32_t)ip;
+		if (ref < ip && LZ_READ32(src + ref) == v) {
+			size_t len = LZ_MIN_MATCH;
+
+			while (ip + len < n && src[ref + len] == src[ip + len])
+				len++;
+			op = lz_put_sequence(op, end, src + anchor, ip - anchor,
+				ip - ref, len);
+			if (!op) return 0;
+			ip += len;
+			anchor = ip;
+		} else {
+			ip++;
+		}
+	}
+
+	op = lz_put_sequence(op, end, src + anchor, n - anchor, 0, 0);
+	return op ? (size_t)(op - dst) : 0;
+}
+
+/**
+ * Read the extra bytes of a count that didn't fit in the token
+ */
+static bool lz_get_count(const uint8_t **ip, const uint8_t *end,
+		size_t *count)
+{
+	uint8_t b;
+
+	if (*count < 15) return true;
+	do {
+		if (*ip >= end) return false;
+		b = *(*ip)++;
+		*count += b;
+	} while (b == 255);
+	return true;
+}
+
+bool lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t len)
+{
+	const uint8_t *ip = src, *iend = src + n;
+	uint8_t *op = dst, *oend = dst + len;
+
+	while (ip < iend) {
+		uint8_t token = *ip++;
+		size_t nlit = token >> 4, mlen = token & 0x0F, offset;
+		const uint8_t *ref;
+
+		/* Literals */
+		if (!lz_get_count(&ip, iend, &nlit)) return false;
+		if ((size_t)(iend - ip) < nlit || (size_t)(oend - op) < nlit)
+			return false;
+		memcpy(op, ip, nlit);
+		ip += nlit;
+		op += nlit;
+
+		/* The last sequence has no match */
+		if (ip == iend) return op == oend;
+
+		/* Match, which may overlap what it's copying */
+		if (iend - ip < 2) return false;
+		offset = ip[0] | ((size_t)ip[1] << 8);
+		ip += 2;
+		if (!lz_get_count(&ip, iend, &mlen)) return false;
+		mlen += LZ_MIN_MATCH;
+		if (offset == 0 || offset > (size_t)(op - dst) ||
+				(size_t)(oend - op) < mlen)
+			return false;
+		ref = op - offset;
+		while (mlen--)
+			*op++ = *ref++;
+	}
+
+	/* Ran out of input with a match last */
+	return false;
+}
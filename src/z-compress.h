@@ -0,0 +1,49 @@
+/**
+ * \file z-compress.h
+ * \brief Fast LZ77 compression of byte buffers
+ *
+ * Copyright (c) 2026 Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_Z_COMPRESS_H
+#define INCLUDED_Z_COMPRESS_H
+
+#include "h-basic.h"
+
+/**
+ * The largest input lz_compress() will take; back references are limited
+ * to this distance.
+ */
+#define LZ_MAX_INPUT	65535
+
+/**
+ * Room needed to compress n bytes of even incompressible input
+ */
+#define LZ_BOUND(n)	((n) + (n) / 255 + 16)
+
+/**
+ * Compress n bytes from src into dst, which has room for cap bytes.
+ * Returns the compressed size, or 0 if it doesn't fit in cap or n is more
+ * than LZ_MAX_INPUT.
+ */
+size_t lz_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap);
+
+/**
+ * Decompress n bytes from src, which must expand to exactly len bytes at
+ * dst.  Returns false if the data is malformed.
+ */
+bool lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t len);
+
+
+#endif /* !INCLUDED_Z_COMPRESS_H */
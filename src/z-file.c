@@ -1044,6 +1044,23 @@ bool file_close(ang_file *f)
 	return true;
 }
 
+/**
+ * Push everything written to file handle 'f' out to the disk.
+ */
+bool file_sync(ang_file *f)
+{
+	if (fflush(f->fh) != 0)
+		return false;
+
+#if defined(WINDOWS) && !defined(CYGWIN)
+	return _commit(_fileno(f->fh)) == 0;
+#elif defined(UNIX)
+	return fsync(fileno(f->fh)) == 0;
+#else
+	return true;
+#endif
+}
+
 
 
 /** Locking functions **/
@@ -206,6 +206,13 @@ extern void (*file_open_hook)(const char *path, file_type ftype);
  */
 bool file_close(ang_file *f);
 
+/**
+ * Make sure everything written to the file handle `f` has reached the disk.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool file_sync(ang_file *f);
+
 
 /** File locking **/
 
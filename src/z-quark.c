@@ -22,28 +22,110 @@
 #include "z-quark.h"
 #include "init.h"
 
+/**
+ * Quarks are numbered from 1; quarks[0] is unused.  The strings themselves
+ * are packed into a list of arena chunks, which never move, so quark_str()
+ * stays valid for as long as the quarks do.  Lookup is through an
+ * open-addressed hash table of quark numbers, kept at most half full.
+ */
+struct quark_chunk {
+	struct quark_chunk *next;
+	size_t used;
+	size_t size;
+};
+
 static char **quarks;
+static uint32_t *quark_hashes;
 static size_t nr_quarks = 1;
 static size_t alloc_quarks = 0;
 
+static quark_t *quark_table;
+static size_t quark_table_size;
+
+static struct quark_chunk *quark_arena;
+
 #define QUARKS_INIT	16
+#define QUARK_CHUNK_SIZE	4096
+
+/**
+ * Copy a string into the arena
+ */
+static char *quark_arena_copy(const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *dst;
+
+	if (!quark_arena || quark_arena->used + len > quark_arena->size) {
+		size_t size = MAX(QUARK_CHUNK_SIZE, len);
+		struct quark_chunk *c = mem_alloc(sizeof(*c) + size);
+
+		c->next = quark_arena;
+		c->used = 0;
+		c->size = size;
+		quark_arena = c;
+	}
+	dst = (char *)(quark_arena + 1) + quark_arena->used;
+	memcpy(dst, str, len);
+	quark_arena->used += len;
+	return dst;
+}
+
+/**
+ * Put quark q in the first free hash table slot for its hash
+ */
+static void quark_table_insert(quark_t q)
+{
+	size_t mask = quark_table_size - 1;
+	size_t i = quark_hashes[q] & mask;
+
+	while (quark_table[i])
+		i = (i + 1) & mask;
+	quark_table[i] = q;
+}
+
+/**
+ * Double the size of the hash table and rehash every quark
+ */
+static void quark_table_grow(void)
+{
+	quark_t q;
+
+	mem_free(quark_table);
+	quark_table_size *= 2;
+	quark_table = mem_zalloc(quark_table_size * sizeof(*quark_table));
+	for (q = 1; q < nr_quarks; q++)
+		quark_table_insert(q);
+}
 
 quark_t quark_add(const char *str)
 {
+	uint32_t hash = djb2_hash(str);
+	size_t mask = quark_table_size - 1;
+	size_t i;
 	quark_t q;
 
-	for (q = 1; q < nr_quarks; q++) {
-		if (streq(quarks[q], str))
+	for (i = hash & mask; quark_table[i]; i = (i + 1) & mask) {
+		q = quark_table[i];
+		if (quark_hashes[q] == hash && streq(quarks[q], str))
 			return q;
 	}
 
 	if (nr_quarks == alloc_quarks) {
 		alloc_quarks *= 2;
 		quarks = mem_realloc(quarks, alloc_quarks * sizeof(char *));
+		quark_hashes = mem_realloc(quark_hashes,
+			alloc_quarks * sizeof(*quark_hashes));
 	}
 
 	q = nr_quarks++;
-	quarks[q] = string_make(str);
+	quarks[q] = quark_arena_copy(str);
+	quark_hashes[q] = hash;
+
+	if (2 * nr_quarks > quark_table_size) {
+		quark_table_grow();
+	} else {
+		quark_table[i] = q;
+	}
 
 	return q;
 }
@@ -58,17 +140,30 @@ void quarks_init(void)
 	nr_quarks = 1;
 	alloc_quarks = QUARKS_INIT;
 	quarks = mem_zalloc(alloc_quarks * sizeof(char*));
+	quark_hashes = mem_zalloc(alloc_quarks * sizeof(*quark_hashes));
+	quark_table_size = 2 * QUARKS_INIT;
+	quark_table = mem_zalloc(quark_table_size * sizeof(*quark_table));
+	quark_arena = NULL;
 }
 
 void quarks_free(void)
 {
-	size_t i;
+	while (quark_arena) {
+		struct quark_chunk *next = quark_arena->next;
 
-	/* quarks[0] is special */
-	for (i = 1; i < nr_quarks; i++)
-		string_free(quarks[i]);
+		mem_free(quark_arena);
+		quark_arena = next;
+	}
 
+	mem_free(quark_table);
+	quark_table = NULL;
+	quark_table_size = 0;
+	mem_free(quark_hashes);
+	quark_hashes = NULL;
 	mem_free(quarks);
+	quarks = NULL;
+	nr_quarks = 1;
+	alloc_quarks = 0;
 }
 
 struct init_module z_quark_module = {
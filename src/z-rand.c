@@ -32,10 +32,17 @@
  * algorithm, used with permission. See below for copyright information
  * about the WELL implementation.
  *
- * To use of the "simple" RNG, activate it via "Rand_quick = true" and
- * "Rand_value = seed". After that it will be automatically used instead of
- * the "complex" RNG. When you are done, you can de-activate it via
- * "Rand_quick = false". You can also choose a new seed.
+ * Both generators live in a struct rng_state, which is a complete stream.
+ * The functions prefixed with rng_ take the stream to draw from; the older
+ * Rand_div(), randint0(), damroll() and so on draw from the calling thread's
+ * default stream, returned by rng_default().  Code which needs a stream of
+ * its own, such as a job run on a worker thread, can either keep a struct
+ * rng_state and use the rng_ functions, or seed the thread's default stream.
+ *
+ * To use the "simple" RNG, set "quick" to true and "value" to the seed in the
+ * stream (rng_state_init_quick() does both). After that it will be
+ * automatically used instead of the "complex" RNG. When you are done, you can
+ * de-activate it by setting "quick" to false. You can also choose a new seed.
  */
 
 /* begin WELL RNG
@@ -53,29 +60,23 @@
 #define MAT0NEG(t, v) (v ^ (v << (-(t))))
 #define Identity(v) (v)
 
-uint32_t state_i = 0;
-uint32_t STATE[RAND_DEG] = {0, 0, 0, 0, 0, 0, 0, 0,
-						0, 0, 0, 0, 0, 0, 0, 0,
-						0, 0, 0, 0, 0, 0, 0, 0,
-						0, 0, 0, 0, 0, 0, 0, 0};
-
-#define V0    STATE[state_i]
-#define VM1   STATE[(state_i + M1) & 0x0000001fU]
-#define VM2   STATE[(state_i + M2) & 0x0000001fU]
-#define VM3   STATE[(state_i + M3) & 0x0000001fU]
-#define VRm1  STATE[(state_i + 31) & 0x0000001fU]
-#define newV0 STATE[(state_i + 31) & 0x0000001fU]
-#define newV1 STATE[state_i]
-
-static uint32_t WELLRNG1024a (void){
+#define V0    rs->table[rs->index]
+#define VM1   rs->table[(rs->index + M1) & 0x0000001fU]
+#define VM2   rs->table[(rs->index + M2) & 0x0000001fU]
+#define VM3   rs->table[(rs->index + M3) & 0x0000001fU]
+#define VRm1  rs->table[(rs->index + 31) & 0x0000001fU]
+#define newV0 rs->table[(rs->index + 31) & 0x0000001fU]
+#define newV1 rs->table[rs->index]
+
+static uint32_t WELLRNG1024a (struct rng_state *rs){
 	uint32_t z0 = VRm1;
 	uint32_t z1 = Identity(V0) ^ MAT0POS (8, VM1);
 	uint32_t z2 = MAT0NEG (-19, VM2) ^ MAT0NEG(-14,VM3);
 
 	newV1   = z1 ^ z2; 
 	newV0   = MAT0NEG (-11,z0) ^ MAT0NEG(-7,z1) ^ MAT0NEG(-13,z2);
-	state_i = (state_i + 31) & 0x0000001fU;
-	return STATE[state_i];
+	rs->index = (rs->index + 31) & 0x0000001fU;
+	return rs->table[rs->index];
 }
 /* end WELL RNG */
 
@@ -86,52 +87,87 @@ static uint32_t WELLRNG1024a (void){
 
 
 /**
- * Whether to use the simple RNG or not.
+ * The default stream of each thread; it starts out using the simple RNG.
  */
-bool Rand_quick = true;
+static RAND_THREAD_LOCAL struct rng_state rand_default_state = { true, 0, 0, { 0 } };
 
 /**
- * The current "seed" of the simple RNG.
+ * Fixed output for testing; see rand_fix().
  */
-uint32_t Rand_value;
-
 static bool rand_fixed = false;
 static uint32_t rand_fixval = 0;
 
 /**
- * Initialize the complex RNG using a new seed.
+ * Return the calling thread's default stream.
  */
-void Rand_state_init(uint32_t seed)
+struct rng_state *rng_default(void)
+{
+	return &rand_default_state;
+}
+
+/**
+ * Fill the complex RNG's table from a seed, starting at the current index.
+ */
+static void rng_seed_table(struct rng_state *rs, uint32_t seed)
 {
-	int i, j;
+	int i;
+	uint32_t j;
 
 	/* Seed the table */
-	STATE[0] = seed;
+	rs->table[0] = seed;
 
 	/* Propagate the seed */
 	for (i = 1; i < RAND_DEG; i++)
-		STATE[i] = LCRNG(STATE[i - 1]);
+		rs->table[i] = LCRNG(rs->table[i - 1]);
 
 	/* Cycle the table ten times per degree */
 	for (i = 0; i < RAND_DEG * 10; i++) {
 		/* Acquire the next index */
-		j = (state_i + 1) % RAND_DEG;
+		j = (rs->index + 1) % RAND_DEG;
 
 		/* Update the table, extract an entry */
-		STATE[j] += STATE[state_i];
+		rs->table[j] += rs->table[rs->index];
 
 		/* Advance the index */
-		state_i = j;
+		rs->index = j;
 	}
 }
 
+/**
+ * Seed a stream to use the complex RNG.
+ */
+void rng_state_init(struct rng_state *rs, uint32_t seed)
+{
+	rs->quick = false;
+	rs->value = seed;
+	rs->index = 0;
+	rng_seed_table(rs, seed);
+}
+
+/**
+ * Seed a stream to use the simple RNG.
+ */
+void rng_state_init_quick(struct rng_state *rs, uint32_t seed)
+{
+	rs->quick = true;
+	rs->value = seed;
+}
+
+/**
+ * Initialize the complex RNG of the default stream using a new seed.
+ */
+void Rand_state_init(uint32_t seed)
+{
+	rng_seed_table(&rand_default_state, seed);
+}
+
 /**
  * Initialise the RNG
  */
 void Rand_init(void)
 {
 	/* Init RNG */
-	if (Rand_quick) {
+	if (rand_default_state.quick) {
 		uint32_t seed;
 
 		/* Basic seed */
@@ -146,7 +182,7 @@ void Rand_init(void)
 #endif
 
 		/* Use the complex RNG */
-		Rand_quick = false;
+		rand_default_state.quick = false;
 
 		/* Seed the "complex" RNG */
 		Rand_state_init(seed);
@@ -165,7 +201,7 @@ void Rand_init(void)
  * This method has no bias, and is much less affected by patterns in the "low"
  * bits of the underlying RNG's. However, it is potentially non-terminating.
  */
-uint32_t Rand_div(uint32_t m)
+uint32_t rng_div(struct rng_state *rs, uint32_t m)
 {
 	uint32_t n, r = 0;
 
@@ -181,12 +217,12 @@ uint32_t Rand_div(uint32_t m)
 	/* Partition size */
 	n = (0x10000000 / m);
 
-	if (Rand_quick) {
+	if (rs->quick) {
 		/* Use a simple RNG */
 		/* Wait for it */
 		while (1) {
 			/* Cycle the generator */
-			r = (Rand_value = LCRNG(Rand_value));
+			r = (rs->value = LCRNG(rs->value));
 
 			/* Mutate a 28-bit "random" number */
 			r = ((r >> 4) & 0x0FFFFFFF) / n;
@@ -198,7 +234,7 @@ uint32_t Rand_div(uint32_t m)
 		/* Use a complex RNG */
 		while (1) {
 			/* Get the next pseudorandom number */
-			r = WELLRNG1024a();
+			r = WELLRNG1024a(rs);
 
 			/* Mutate a 28-bit "random" number */
 			r = ((r >> 4) & 0x0FFFFFFF) / n;
@@ -212,6 +248,11 @@ uint32_t Rand_div(uint32_t m)
 	return (r);
 }
 
+uint32_t Rand_div(uint32_t m)
+{
+	return rng_div(&rand_default_state, m);
+}
+
 
 /**
  * The number of entries in the "Rand_normal_table"
@@ -284,7 +325,7 @@ static int16_t Rand_normal_table[RANDNOR_NUM] = {
  *
  * Note that the binary search takes up to 16 quick iterations.
  */
-int16_t Rand_normal(int mean, int stand)
+int16_t rng_normal(struct rng_state *rs, int mean, int stand)
 {
 	int16_t tmp, offset;
 
@@ -295,7 +336,7 @@ int16_t Rand_normal(int mean, int stand)
 	if (stand < 1) return (mean);
 
 	/* Roll for probability */
-	tmp = (int16_t)randint0(32768);
+	tmp = (int16_t)rng_randint0(rs, 32768);
 
 	/* Binary Search */
 	while (low < high) {
@@ -313,12 +354,17 @@ int16_t Rand_normal(int mean, int stand)
 	offset = (int16_t)((long)stand * (long)low / RANDNOR_STD);
 
 	/* One half should be negative */
-	if (one_in_(2)) return (mean - offset);
+	if (rng_one_in_(rs, 2)) return (mean - offset);
 
 	/* One half should be positive */
 	return (mean + offset);
 }
 
+int16_t Rand_normal(int mean, int stand)
+{
+	return rng_normal(&rand_default_state, mean, stand);
+}
+
 
 /**
  * Choose an integer from a distribution where we know the mean and approximate
@@ -332,9 +378,10 @@ int16_t Rand_normal(int mean, int stand)
  * The function chooses an integer from a normal distribution, and then scales
  * it to fit the target distribution.
  */
-int Rand_sample(int mean, int upper, int lower, int stand_u, int stand_l)
+int rng_sample(struct rng_state *rs, int mean, int upper, int lower,
+		int stand_u, int stand_l)
 {
-	int pick = Rand_normal(0, 1000);
+	int pick = rng_normal(rs, 0, 1000);
 
 	/* Scale to fit */
 	if (pick > 0) {
@@ -350,10 +397,16 @@ int Rand_sample(int mean, int upper, int lower, int stand_u, int stand_l)
 	return mean + pick;
 }
 
+int Rand_sample(int mean, int upper, int lower, int stand_u, int stand_l)
+{
+	return rng_sample(&rand_default_state, mean, upper, lower, stand_u,
+		stand_l);
+}
+
 /**
  * Generates damage for "2d6" style dice rolls
  */
-int damroll(int num, int sides)
+int rng_damroll(struct rng_state *rs, int num, int sides)
 {
 	int i;
 	int sum = 0;
@@ -361,21 +414,27 @@ int damroll(int num, int sides)
 	if (sides <= 0) return 0;
 
 	for (i = 0; i < num; i++)
-		sum += randint1(sides);
+		sum += rng_randint1(rs, sides);
 	return sum;
 }
 
+int damroll(int num, int sides)
+{
+	return rng_damroll(&rand_default_state, num, sides);
+}
+
 
 
 /**
  * Calculation helper function for damroll
  */
-int damcalc(int num, int sides, aspect dam_aspect)
+static int rng_damcalc(struct rng_state *rs, int num, int sides,
+		aspect dam_aspect)
 {
 	switch (dam_aspect) {
 		case MAXIMISE:
 		case EXTREMIFY: return num * sides;
-		case RANDOMISE: return damroll(num, sides);
+		case RANDOMISE: return rng_damroll(rs, num, sides);
 		case MINIMISE: return num;
 		case AVERAGE: return num * (sides + 1) / 2;
 	}
@@ -384,6 +443,11 @@ int damcalc(int num, int sides, aspect dam_aspect)
 	return 0;
 }
 
+int damcalc(int num, int sides, aspect dam_aspect)
+{
+	return rng_damcalc(&rand_default_state, num, sides, dam_aspect);
+}
+
 
 /**
  * Generates a random signed long integer X where `A` <= X <= `B`.
@@ -391,12 +455,17 @@ int damcalc(int num, int sides, aspect dam_aspect)
  *
  * Note that "rand_range(0, N-1)" == "randint0(N)".
  */
-int rand_range(int A, int B)
+int rng_range(struct rng_state *rs, int A, int B)
 {
 	if (A == B) return A;
 	assert(A < B);
 
-	return A + (int32_t)Rand_div(1 + B - A);
+	return A + (int32_t)rng_div(rs, 1 + B - A);
+}
+
+int rand_range(int A, int B)
+{
+	return rng_range(&rand_default_state, A, B);
 }
 
 
@@ -404,11 +473,11 @@ int rand_range(int A, int B)
  * Perform division, possibly rounding up or down depending on the size of the
  * remainder and chance.
  */
-static int simulate_division(int dividend, int divisor)
+static int simulate_division(struct rng_state *rs, int dividend, int divisor)
 {
 	int quotient  = dividend / divisor;
 	int remainder = dividend % divisor;
-	if (randint0(divisor) < remainder) quotient++;
+	if (rng_randint0(rs, divisor) < remainder) quotient++;
 	return quotient;
 }
 
@@ -452,7 +521,7 @@ static int simulate_division(int dividend, int divisor)
  * 120    0.03  0.11  0.31  0.46  1.31  2.48  4.60  7.78 11.67 25.53 45.72
  * 128    0.02  0.01  0.13  0.33  0.83  1.41  3.24  6.17  9.57 14.22 64.07
  */
-int16_t m_bonus(int max, int level)
+int16_t rng_m_bonus(struct rng_state *rs, int max, int level)
 {
 	int bonus, stand, value;
 
@@ -460,13 +529,13 @@ int16_t m_bonus(int max, int level)
 	if (level >= MAX_RAND_DEPTH) level = MAX_RAND_DEPTH - 1;
 
 	/* The bonus approaches max as level approaches MAX_RAND_DEPTH */
-	bonus = simulate_division(max * level, MAX_RAND_DEPTH);
+	bonus = simulate_division(rs, max * level, MAX_RAND_DEPTH);
 
 	/* The standard deviation is 1/4 of the max */
-	stand = simulate_division(max, 4);
+	stand = simulate_division(rs, max, 4);
 
 	/* Choose a value */
-	value = Rand_normal(bonus, stand);
+	value = rng_normal(rs, bonus, stand);
 
 	/* Return, enforcing the min and max values */
 	if (value < 0)
@@ -477,16 +546,22 @@ int16_t m_bonus(int max, int level)
 		return value;
 }
 
+int16_t m_bonus(int max, int level)
+{
+	return rng_m_bonus(&rand_default_state, max, level);
+}
+
 
 /**
  * Calculation helper function for m_bonus
  */
-int16_t m_bonus_calc(int max, int level, aspect bonus_aspect)
+static int16_t rng_m_bonus_calc(struct rng_state *rs, int max, int level,
+		aspect bonus_aspect)
 {
 	switch (bonus_aspect) {
 		case EXTREMIFY:
 		case MAXIMISE:  return max;
-		case RANDOMISE: return m_bonus(max, level);
+		case RANDOMISE: return rng_m_bonus(rs, max, level);
 		case MINIMISE:  return 0;
 		case AVERAGE:   return max * level / MAX_RAND_DEPTH;
 	}
@@ -495,24 +570,35 @@ int16_t m_bonus_calc(int max, int level, aspect bonus_aspect)
 	return 0;
 }
 
+int16_t m_bonus_calc(int max, int level, aspect bonus_aspect)
+{
+	return rng_m_bonus_calc(&rand_default_state, max, level, bonus_aspect);
+}
+
 
 /**
  * Calculation helper function for random_value structs
  */
-int randcalc(random_value v, int level, aspect rand_aspect)
+int rng_randcalc(struct rng_state *rs, random_value v, int level,
+		aspect rand_aspect)
 {
 	if (rand_aspect == EXTREMIFY) {
-		int min = randcalc(v, level, MINIMISE);
-		int max = randcalc(v, level, MAXIMISE);
+		int min = rng_randcalc(rs, v, level, MINIMISE);
+		int max = rng_randcalc(rs, v, level, MAXIMISE);
 		return abs(min) > abs(max) ? min : max;
 
 	} else {
-		int dmg   = damcalc(v.dice, v.sides, rand_aspect);
-		int bonus = m_bonus_calc(v.m_bonus, level, rand_aspect);
+		int dmg   = rng_damcalc(rs, v.dice, v.sides, rand_aspect);
+		int bonus = rng_m_bonus_calc(rs, v.m_bonus, level, rand_aspect);
 		return v.base + dmg + bonus;
 	}
 }
 
+int randcalc(random_value v, int level, aspect rand_aspect)
+{
+	return rng_randcalc(&rand_default_state, v, level, rand_aspect);
+}
+
 
 /**
  * Test to see if a value is within a random_value's range
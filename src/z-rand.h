@@ -98,24 +98,92 @@ typedef enum {
 #define one_in_(x) (!randint0(x))
 
 /**
- * Whether we are currently using the "quick" method or not.
+ * Storage class for the per-thread default RNG state.  Compilers without
+ * thread-local storage fall back to a single shared state, which is only
+ * safe when random numbers are drawn from one thread.
  */
-extern bool Rand_quick;
+#if defined(_MSC_VER)
+#define RAND_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define RAND_THREAD_LOCAL __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+		&& !defined(__STDC_NO_THREADS__)
+#define RAND_THREAD_LOCAL _Thread_local
+#else
+#define RAND_THREAD_LOCAL
+#endif
 
 /**
- * The state used by the "quick" RNG.
+ * A complete random number stream.
+ *
+ * Each stream owns both the "quick" LCRNG and the "complex" WELL1024a
+ * generator.  Streams never share state, so jobs that each use their own
+ * stream get the same results whatever thread runs them and in what order.
+ */
+struct rng_state {
+	/* Whether to use the "quick" RNG */
+	bool quick;
+
+	/* State of the "quick" RNG */
+	uint32_t value;
+
+	/* Index into, and contents of, the "complex" RNG's state table */
+	uint32_t index;
+	uint32_t table[RAND_DEG];
+};
+
+/**
+ * Return the calling thread's default stream, which is the one used by
+ * Rand_div(), randint0() and the rest of the functions without an explicit
+ * stream argument.  It starts out using the "quick" RNG.
+ */
+struct rng_state *rng_default(void);
+
+/**
+ * Seed a stream so that it uses the "complex" RNG, independent of whatever
+ * state it held before.
+ */
+void rng_state_init(struct rng_state *rs, uint32_t seed);
+
+/**
+ * Seed a stream so that it uses the "quick" RNG.
+ */
+void rng_state_init_quick(struct rng_state *rs, uint32_t seed);
+
+/**
+ * Versions of the functions below which draw from an explicit stream.
  */
-extern uint32_t Rand_value;
+uint32_t rng_div(struct rng_state *rs, uint32_t m);
+int16_t rng_normal(struct rng_state *rs, int mean, int stand);
+int rng_sample(struct rng_state *rs, int mean, int upper, int lower,
+	int stand_u, int stand_l);
+int rng_damroll(struct rng_state *rs, int num, int sides);
+int rng_range(struct rng_state *rs, int A, int B);
+int16_t rng_m_bonus(struct rng_state *rs, int max, int level);
+int rng_randcalc(struct rng_state *rs, random_value v, int level,
+	aspect rand_aspect);
 
 /**
- * The state used by the "complex" RNG.
+ * Generates a random signed long integer X where "0 <= X < M" holds, drawing
+ * from the stream `RS`.
  */
-extern uint32_t state_i;
-extern uint32_t STATE[RAND_DEG];
+#define rng_randint0(RS, M) ((int32_t) rng_div((RS), (M)))
 
+/**
+ * Generates a random signed long integer X where "1 <= X <= M" holds, drawing
+ * from the stream `RS`.
+ */
+#define rng_randint1(RS, M) ((int32_t) rng_div((RS), (M)) + 1)
+
+/**
+ * Return true one time in `x`, drawing from the stream `RS`.
+ */
+#define rng_one_in_(RS, x) (!rng_randint0((RS), (x)))
 
 /**
- * Initialise the RNG state with the given seed.
+ * Seed the "complex" RNG of the default stream.  Unlike rng_state_init(),
+ * this keeps the stream's table index and does not switch away from the
+ * "quick" RNG, as it always has.
  */
 void Rand_state_init(uint32_t seed);
 